@@ -45,6 +45,10 @@ void Negotiator::respond(
     return;
   }
 
+  // Give the negotiation something to work with as soon as we have a feasible
+  // plan instead of waiting for every planning job to settle.
+  service->anytime();
+
   auto negotiate_sub =
     rmf_rxcpp::make_job<services::Negotiate::Result>(service)
     .observe_on(rxcpp::identity_same_worker(_context->worker()))
@@ -54,9 +58,10 @@ void Negotiator::respond(
       if (auto self = w.lock())
       {
         result.respond();
-        self->_negotiate_services.erase(result.service);
+        if (!result.provisional)
+          self->_negotiate_services.erase(result.service);
       }
-      else
+      else if (!result.provisional)
       {
         // We need to make sure we respond in some way so that we don't risk
         // making a negotiation hang forever. If this task is dead, then we
@@ -29,8 +29,11 @@
 
 #include "internal_EasyTrafficLight.hpp"
 
+#include "../jobs/PlanningExecutor.hpp"
 #include "../load_param.hpp"
 
+#include <sstream>
+
 namespace rmf_fleet_adapter {
 namespace agv {
 
@@ -84,6 +87,7 @@ public:
   std::unordered_set<std::string> received_tasks;
   std::map<rmf_traffic::Time, std::string> task_times;
   rclcpp::TimerBase::SharedPtr task_purge_timer;
+  rclcpp::TimerBase::SharedPtr planning_metrics_timer;
 
   // This mutex protects the initialization of traffic lights
   std::mutex _traffic_light_init_mutex;
@@ -101,7 +105,58 @@ public:
     blockade_writer{rmf_traffic_ros2::blockade::Writer::make(*node)},
     mirror_manager{std::move(mirror_manager_)}
   {
-    // Do nothing
+    planning_metrics_timer = node->create_wall_timer(
+      std::chrono::seconds(10),
+      [w = node->weak_from_this()]()
+      {
+        if (const auto n = w.lock())
+          report_planning_metrics(*n);
+      });
+  }
+
+  static void report_planning_metrics(rclcpp::Node& node)
+  {
+    using Priority = jobs::PlanningExecutor::Priority;
+    const auto metrics = jobs::PlanningExecutor::get().take_metrics();
+    const auto ms = [](const rmf_traffic::Duration d)
+      {
+        return std::chrono::duration<double, std::milli>(d).count();
+      };
+
+    bool starved = false;
+    std::stringstream ss;
+    const std::array<std::pair<Priority, const char*>, 3> classes = {
+      std::make_pair(Priority::negotiation, "negotiation"),
+      std::make_pair(Priority::replan, "replan"),
+      std::make_pair(Priority::bid_estimate, "bid estimate")
+    };
+
+    for (const auto& [priority, name] : classes)
+    {
+      const auto i = static_cast<std::size_t>(priority);
+      ss << "\n  [" << name << "] queued: " << metrics.queue_depth[i]
+         << " | started: " << metrics.started[i]
+         << " | mean wait: " << ms(metrics.mean_wait[i])
+         << "ms | max wait: " << ms(metrics.max_wait[i]) << "ms";
+
+      if (metrics.max_wait[i] > std::chrono::seconds(1))
+        starved = true;
+    }
+
+    if (starved)
+    {
+      RCLCPP_WARN(
+        node.get_logger(),
+        "Planning steps are waiting more than a second for one of the [%lu] "
+        "planning threads. Consider increasing the planning_threads "
+        "parameter.%s",
+        jobs::PlanningExecutor::get().thread_count(), ss.str().c_str());
+    }
+    else
+    {
+      RCLCPP_DEBUG(
+        node.get_logger(), "Planning executor:%s", ss.str().c_str());
+    }
   }
 
   static rmf_utils::unique_impl_ptr<Implementation> make(
@@ -129,8 +184,20 @@ public:
         get_parameter_or_default_time(*node, "discovery_timeout", 60.0);
     }
 
+    // The number of threads that may be planning at the same time. If this is
+    // 0, the hardware concurrency will be used.
+    const int planning_threads =
+      get_parameter_or_default(*node, "planning_threads", 0);
+    jobs::PlanningExecutor::get().set_thread_count(
+      static_cast<std::size_t>(std::max(0, planning_threads)));
+
+    // Negotiation responses are computed on worker threads, so they read the
+    // schedule through snapshots that get published after each update instead
+    // of contending with the updates.
     auto mirror_future = rmf_traffic_ros2::schedule::make_mirror(
-      node, rmf_traffic::schedule::query_all());
+      node, rmf_traffic::schedule::query_all(),
+      rmf_traffic_ros2::schedule::MirrorManager::Options()
+      .publish_snapshots(true));
 
     auto writer = rmf_traffic_ros2::schedule::Writer::make(node);
 
@@ -159,7 +226,7 @@ public:
 
         auto negotiation =
           std::make_shared<rmf_traffic_ros2::schedule::Negotiation>(
-          *node, mirror_manager.view(),
+          *node, mirror_manager.snapshots(),
           std::make_shared<WorkerWrapper>(worker));
 
         return rmf_utils::make_unique_impl<Implementation>(
@@ -400,7 +467,7 @@ std::shared_ptr<FleetUpdateHandle> Adapter::add_fleet(
   auto fleet = FleetUpdateHandle::Implementation::make(
     fleet_name, std::move(planner), _pimpl->node, _pimpl->worker,
     _pimpl->schedule_writer, _pimpl->mirror_manager.view(),
-    _pimpl->negotiation, server_uri);
+    _pimpl->mirror_manager.snapshots(), _pimpl->negotiation, server_uri);
 
   _pimpl->fleets.push_back(fleet);
   return fleet;
@@ -472,6 +539,7 @@ void Adapter::add_easy_traffic_light(
     blocker_callback = std::move(blocker_callback),
     blockade_writer = _pimpl->blockade_writer,
     schedule = _pimpl->mirror_manager.view(),
+    snapshots = _pimpl->mirror_manager.snapshots(),
     worker = _pimpl->worker,
     handle_cb = std::move(handle_callback),
     negotiation = _pimpl->negotiation,
@@ -495,6 +563,7 @@ void Adapter::add_easy_traffic_light(
         std::move(resume_callback),
         std::move(blocker_callback),
         schedule,
+        snapshots,
         worker,
         node,
         std::move(traits),
@@ -378,7 +378,7 @@ void EasyTrafficLight::Implementation::Shared::make_plan(
 
   state.find_path_service = std::make_shared<services::FindPath>(
     state.planner, rmf_traffic::agv::Plan::StartSet{std::move(start)},
-    std::move(goal), hooks.schedule->snapshot(), state.itinerary->id(),
+    std::move(goal), hooks.snapshots->snapshot(), state.itinerary->id(),
     hooks.profile, std::nullopt);
 
   state.find_path_subscription =
@@ -990,6 +990,7 @@ void EasyTrafficLight::Implementation::Shared::respond(
     state.itinerary->assign_plan_id(), state.planner,
     {*state.last_known_location}, std::move(goal), {},
     viewer, responder, std::move(approval_cb), evaluator);
+  negotiate->anytime();
 
   auto negotiate_sub =
     rmf_rxcpp::make_job<services::Negotiate::Result>(negotiate)
@@ -1000,9 +1001,10 @@ void EasyTrafficLight::Implementation::Shared::respond(
       if (const auto self = w.lock())
       {
         result.respond();
-        self->negotiate_services.erase(result.service);
+        if (!result.provisional)
+          self->negotiate_services.erase(result.service);
       }
-      else
+      else if (!result.provisional)
       {
         result.service->responder()->forfeit({});
       }
@@ -1125,6 +1127,7 @@ EasyTrafficLightPtr EasyTrafficLight::Implementation::make(
   std::function<void()> resume_,
   std::function<void(std::vector<Blocker>)> blocker_,
   std::shared_ptr<const rmf_traffic::schedule::Mirror> schedule_,
+  std::shared_ptr<const rmf_traffic::schedule::Snappable> snapshots_,
   rxcpp::schedulers::worker worker_,
   std::shared_ptr<Node> node_,
   rmf_traffic::agv::VehicleTraits traits_,
@@ -1141,6 +1144,7 @@ EasyTrafficLightPtr EasyTrafficLight::Implementation::make(
       std::move(resume_),
       std::move(blocker_),
       std::move(schedule_),
+      std::move(snapshots_),
       std::move(worker_),
       node_,
       std::move(traits_),
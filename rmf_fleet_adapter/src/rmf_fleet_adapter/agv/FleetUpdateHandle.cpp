@@ -27,6 +27,7 @@
 #include "internal_RobotUpdateHandle.hpp"
 #include "RobotContext.hpp"
 
+#include "../jobs/PlanCache.hpp"
 #include "../log_to_json.hpp"
 #include "../tasks/Delivery.hpp"
 #include "../tasks/Patrol.hpp"
@@ -1771,6 +1772,7 @@ void FleetUpdateHandle::add_robot(
         std::move(start),
         std::move(participant),
         fleet->_pimpl->mirror,
+        fleet->_pimpl->snapshots,
         fleet->_pimpl->planner,
         fleet->_pimpl->emergency_planner,
         fleet->_pimpl->activation.task,
@@ -2033,6 +2035,8 @@ void FleetUpdateHandle::close_lanes(std::vector<std::size_t> lane_indices)
         new_lane_closures.close(lane);
       }
 
+      // The cached plans of the old planner will never be looked up again
+      jobs::PlanCache::get().forget(*self->_pimpl->planner);
       *self->_pimpl->planner =
       std::make_shared<const rmf_traffic::agv::Planner>(
         new_config, rmf_traffic::agv::Planner::Options(nullptr));
@@ -2090,6 +2094,8 @@ void FleetUpdateHandle::open_lanes(std::vector<std::size_t> lane_indices)
         new_lane_closures.open(lane);
       }
 
+      // The cached plans of the old planner will never be looked up again
+      jobs::PlanCache::get().forget(*self->_pimpl->planner);
       *self->_pimpl->planner =
       std::make_shared<const rmf_traffic::agv::Planner>(
         new_config, rmf_traffic::agv::Planner::Options(nullptr));
@@ -2185,6 +2191,8 @@ auto FleetUpdateHandle::limit_lane_speeds(
         request.speed_limit();
       }
 
+      // The cached plans of the old planner will never be looked up again
+      jobs::PlanCache::get().forget(*self->_pimpl->planner);
       *self->_pimpl->planner =
       std::make_shared<const rmf_traffic::agv::Planner>(
         new_config, rmf_traffic::agv::Planner::Options(nullptr));
@@ -2221,6 +2229,8 @@ void FleetUpdateHandle::remove_speed_limits(std::vector<std::size_t> requests)
         self->_pimpl->speed_limited_lanes.erase(request);
       }
 
+      // The cached plans of the old planner will never be looked up again
+      jobs::PlanCache::get().forget(*self->_pimpl->planner);
       *self->_pimpl->planner =
       std::make_shared<const rmf_traffic::agv::Planner>(
         new_config, rmf_traffic::agv::Planner::Options(nullptr));
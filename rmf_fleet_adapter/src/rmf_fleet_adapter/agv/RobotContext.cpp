@@ -543,6 +543,13 @@ auto RobotContext::schedule() const -> const std::shared_ptr<const Mirror>&
   return _schedule;
 }
 
+//==============================================================================
+auto RobotContext::schedule_snapshots() const
+-> const std::shared_ptr<const Snappable>&
+{
+  return _schedule_snapshots;
+}
+
 //==============================================================================
 const rmf_traffic::schedule::ParticipantDescription&
 RobotContext::description() const
@@ -1103,6 +1110,7 @@ RobotContext::RobotContext(
   std::vector<rmf_traffic::agv::Plan::Start> _initial_location,
   rmf_traffic::schedule::Participant itinerary,
   std::shared_ptr<const Mirror> schedule,
+  std::shared_ptr<const Snappable> schedule_snapshots,
   SharedPlanner planner,
   SharedPlanner emergency_planner,
   rmf_task::ConstActivatorPtr activator,
@@ -1116,6 +1124,7 @@ RobotContext::RobotContext(
   _location(std::move(_initial_location)),
   _itinerary(std::move(itinerary)),
   _schedule(std::move(schedule)),
+  _schedule_snapshots(std::move(schedule_snapshots)),
   _planner(std::move(planner)),
   _emergency_planner(std::move(emergency_planner)),
   _task_activator(std::move(activator)),
@@ -447,10 +447,16 @@ public:
   const rmf_traffic::schedule::Participant& itinerary() const;
 
   using Mirror = rmf_traffic::schedule::Mirror;
-  /// Get a const-reference to an interface that lets you get a snapshot of the
-  /// schedule.
+  /// Get a const-reference to the live schedule mirror. This is only safe to
+  /// use from the worker thread, e.g. for watching dependencies. Planners
+  /// should use schedule_snapshots() instead.
   const std::shared_ptr<const Mirror>& schedule() const;
 
+  using Snappable = rmf_traffic::schedule::Snappable;
+  /// Get a const-reference to an interface that lets you get a snapshot of the
+  /// schedule from any thread.
+  const std::shared_ptr<const Snappable>& schedule_snapshots() const;
+
   /// Get the schedule description of this robot
   const rmf_traffic::schedule::ParticipantDescription& description() const;
 
@@ -779,6 +785,7 @@ private:
     std::vector<rmf_traffic::agv::Plan::Start> _initial_location,
     rmf_traffic::schedule::Participant itinerary,
     std::shared_ptr<const Mirror> schedule,
+    std::shared_ptr<const Snappable> schedule_snapshots,
     SharedPlanner planner,
     SharedPlanner emergency_planner,
     rmf_task::ConstActivatorPtr activator,
@@ -794,6 +801,7 @@ private:
   std::vector<rmf_traffic::agv::Plan::Start> _most_recent_valid_location;
   rmf_traffic::schedule::Participant _itinerary;
   std::shared_ptr<const Mirror> _schedule;
+  std::shared_ptr<const Snappable> _schedule_snapshots;
   SharedPlanner _planner;
   SharedPlanner _emergency_planner;
   std::shared_ptr<NavParams> _nav_params;
@@ -135,6 +135,7 @@ public:
     std::function<void()> resume_callback;
     std::function<void(std::vector<Blocker> blockers)> deadlock_callback;
     std::shared_ptr<const rmf_traffic::schedule::Mirror> schedule;
+    std::shared_ptr<const rmf_traffic::schedule::Snappable> snapshots;
     rxcpp::schedulers::worker worker;
     std::shared_ptr<Node> node;
     rmf_traffic::agv::VehicleTraits traits;
@@ -242,6 +243,7 @@ public:
     std::function<void()> resume_,
     std::function<void(std::vector<Blocker>)> blocker_,
     std::shared_ptr<const rmf_traffic::schedule::Mirror> schedule_,
+    std::shared_ptr<const rmf_traffic::schedule::Snappable> snapshots_,
     rxcpp::schedulers::worker worker_,
     std::shared_ptr<Node> node_,
     rmf_traffic::agv::VehicleTraits traits_,
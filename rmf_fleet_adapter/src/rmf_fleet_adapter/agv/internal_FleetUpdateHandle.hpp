@@ -269,6 +269,7 @@ public:
   rxcpp::schedulers::worker worker;
   std::shared_ptr<ParticipantFactory> writer;
   std::shared_ptr<const rmf_traffic::schedule::Mirror> mirror;
+  std::shared_ptr<const rmf_traffic::schedule::Snappable> snapshots;
   std::shared_ptr<rmf_traffic_ros2::schedule::Negotiation> negotiation;
   std::optional<std::string> server_uri;
 
@@ -290,7 +290,7 @@ std::shared_ptr<FleetUpdateHandle> MockAdapter::add_fleet(
   auto fleet = FleetUpdateHandle::Implementation::make(
     fleet_name, std::move(planner), _pimpl->node, _pimpl->worker,
     std::make_shared<SimpleParticipantFactory>(_pimpl->schedule),
-    _pimpl->schedule->view(), nullptr, server_uri);
+    _pimpl->schedule->view(), _pimpl->schedule->view(), nullptr, server_uri);
 
   _pimpl->fleets.push_back(fleet);
   return fleet;
@@ -244,7 +244,7 @@ void EmergencyPullover::Active::_find_plan()
 
   _find_pullover_service = std::make_shared<services::FindEmergencyPullover>(
     _context->emergency_planner(), _context->location(),
-    _context->schedule()->snapshot(),
+    _context->schedule_snapshots()->snapshot(),
     _context->itinerary().id(), _context->profile());
 
   _pullover_subscription =
@@ -532,9 +532,10 @@ void GoToPlace::Active::_find_plan()
   // TODO(MXG): Make the planning time limit configurable
   _find_path_service = std::make_shared<services::FindPath>(
     _context->planner(), _context->location(), *_chosen_goal,
-    _context->schedule()->snapshot(), _context->itinerary().id(),
+    _context->schedule_snapshots()->snapshot(), _context->itinerary().id(),
     _context->profile(),
-    std::chrono::seconds(5));
+    std::chrono::seconds(5),
+    _previous_greedy_plan);
 
   _plan_subscription = rmf_rxcpp::make_job<services::FindPath::Result>(
     _find_path_service)
@@ -572,6 +573,31 @@ void GoToPlace::Active::_find_plan()
         "Found a plan to move from ["
         + start_name + "] to [" + goal_name + "]");
 
+      if (self->_find_path_service)
+      {
+        const auto search = self->_find_path_service->search();
+        const auto reuse = search->reuse();
+        if (reuse.cached_greedy_cost || reuse.previous_greedy_plan)
+        {
+          std::string reused = reuse.cached_greedy_cost ?
+            "a cached greedy plan cost" :
+            "the remaining " + std::to_string(
+            static_cast<int>(100.0 * reuse.reused_fraction))
+            + "% of the previous greedy plan";
+
+          if (reuse.greedy_skipped)
+            reused += " and skipped the greedy search";
+
+          RCLCPP_INFO(
+            self->_context->node()->get_logger(),
+            "Plan for [%s] reused %s",
+            self->_context->requester_id().c_str(),
+            reused.c_str());
+        }
+
+        self->_previous_greedy_plan = search->greedy_reference();
+      }
+
       auto full_itinerary = project_itinerary(
         *result, self->_description.expected_next_destinations(),
         *self->_context->planner());
@@ -136,6 +136,11 @@ public:
     std::shared_ptr<Negotiator> _negotiator;
     std::optional<ExecutePlan> _execution;
     std::shared_ptr<services::FindPath> _find_path_service;
+
+    // The greedy plan of the search that produced the current plan. It is kept
+    // so that the next replan can reuse it.
+    std::shared_ptr<const jobs::SearchForPath::GreedyReference>
+    _previous_greedy_plan;
     rmf_rxcpp::subscription_guard _plan_subscription;
     rclcpp::TimerBase::SharedPtr _find_path_timeout;
     rclcpp::TimerBase::SharedPtr _retry_timer;
@@ -258,7 +258,7 @@ void LockMutexGroup::Active::_initialize()
                 self->_context->planner(),
                 std::vector<rmf_traffic::agv::Plan::Start>({*start}),
                 self->_data.goal,
-                self->_context->schedule()->snapshot(),
+                self->_context->schedule_snapshots()->snapshot(),
                 self->_context->itinerary().id(),
                 self->_context->profile(),
                 std::chrono::seconds(5));
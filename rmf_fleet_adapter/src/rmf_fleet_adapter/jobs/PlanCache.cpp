@@ -0,0 +1,185 @@
+/*
+ * Copyright (C) 2022 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include "PlanCache.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace rmf_fleet_adapter {
+namespace jobs {
+
+namespace {
+//==============================================================================
+int64_t round_orientation(const double yaw)
+{
+  return static_cast<int64_t>(std::round(yaw * 180.0 / M_PI));
+}
+
+//==============================================================================
+void hash_combine(std::size_t& seed, const std::size_t value)
+{
+  seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+} // anonymous namespace
+
+//==============================================================================
+bool PlanCache::Key::operator==(const Key& other) const
+{
+  return planner == other.planner
+    && start_waypoint == other.start_waypoint
+    && start_orientation == other.start_orientation
+    && start_lane == other.start_lane
+    && start_location == other.start_location
+    && goal_waypoint == other.goal_waypoint
+    && goal_orientation == other.goal_orientation;
+}
+
+//==============================================================================
+std::size_t PlanCache::KeyHash::operator()(const Key& key) const
+{
+  std::size_t seed = std::hash<const Planner*>()(key.planner);
+  hash_combine(seed, key.start_waypoint);
+  hash_combine(seed, std::hash<int64_t>()(key.start_orientation));
+  hash_combine(seed, key.start_lane.value_or(-1));
+  if (key.start_location.has_value())
+  {
+    hash_combine(seed, std::hash<int64_t>()((*key.start_location)[0]));
+    hash_combine(seed, std::hash<int64_t>()((*key.start_location)[1]));
+  }
+  hash_combine(seed, key.goal_waypoint);
+  if (key.goal_orientation.has_value())
+    hash_combine(seed, std::hash<int64_t>()(*key.goal_orientation));
+
+  return seed;
+}
+
+//==============================================================================
+auto PlanCache::make_key(
+  const Planner& planner,
+  const rmf_traffic::agv::Plan::Start& start,
+  const rmf_traffic::agv::Plan::Goal& goal) -> Key
+{
+  Key key;
+  key.planner = &planner;
+  key.start_waypoint = start.waypoint();
+  key.start_orientation = round_orientation(start.orientation());
+  if (start.lane().has_value())
+    key.start_lane = *start.lane();
+
+  if (start.location().has_value())
+  {
+    const auto& p = *start.location();
+    key.start_location = std::array<int64_t, 2>{
+      static_cast<int64_t>(std::round(p[0] * 10.0)),
+      static_cast<int64_t>(std::round(p[1] * 10.0))
+    };
+  }
+
+  key.goal_waypoint = goal.waypoint();
+  if (const auto* orientation = goal.orientation())
+    key.goal_orientation = round_orientation(*orientation);
+
+  return key;
+}
+
+//==============================================================================
+PlanCache& PlanCache::get()
+{
+  static PlanCache cache;
+  return cache;
+}
+
+//==============================================================================
+PlanCache::PlanCache(const std::size_t capacity)
+: _capacity(std::max<std::size_t>(1, capacity))
+{
+  // Do nothing
+}
+
+//==============================================================================
+std::optional<double> PlanCache::find(const Key& key)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  const auto it = _lookup.find(key);
+  if (it == _lookup.end())
+    return std::nullopt;
+
+  if (it->second->planner.expired())
+  {
+    // The planner was destroyed and something else now lives at its address
+    _entries.erase(it->second);
+    _lookup.erase(it);
+    return std::nullopt;
+  }
+
+  _entries.splice(_entries.begin(), _entries, it->second);
+  return it->second->cost;
+}
+
+//==============================================================================
+void PlanCache::insert(
+  const Key& key,
+  const std::shared_ptr<const Planner>& planner,
+  const double cost)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  const auto it = _lookup.find(key);
+  if (it != _lookup.end())
+  {
+    it->second->planner = planner;
+    it->second->cost = cost;
+    _entries.splice(_entries.begin(), _entries, it->second);
+    return;
+  }
+
+  _entries.push_front(Entry{key, planner, cost});
+  _lookup.insert({key, _entries.begin()});
+
+  while (_entries.size() > _capacity)
+  {
+    _lookup.erase(_entries.back().key);
+    _entries.pop_back();
+  }
+}
+
+//==============================================================================
+void PlanCache::forget(const std::shared_ptr<const Planner>& planner)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  for (auto it = _entries.begin(); it != _entries.end(); )
+  {
+    if (it->key.planner == planner.get() || it->planner.expired())
+    {
+      _lookup.erase(it->key);
+      it = _entries.erase(it);
+      continue;
+    }
+
+    ++it;
+  }
+}
+
+//==============================================================================
+std::size_t PlanCache::size() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _entries.size();
+}
+
+} // namespace jobs
+} // namespace rmf_fleet_adapter
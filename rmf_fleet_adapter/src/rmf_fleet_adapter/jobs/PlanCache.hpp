@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2022 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SRC__RMF_FLEET_ADAPTER__JOBS__PLANCACHE_HPP
+#define SRC__RMF_FLEET_ADAPTER__JOBS__PLANCACHE_HPP
+
+#include <rmf_traffic/agv/Planner.hpp>
+
+#include <array>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+
+namespace rmf_fleet_adapter {
+namespace jobs {
+
+//==============================================================================
+/// A least-recently-used cache of the costs of greedy (schedule-free) plans.
+///
+/// Robots of the same fleet share a planner, so they keep solving the same
+/// problems, e.g. going from a charger to a pickup spot. Entries are keyed by
+/// the planner instance, which carries the vehicle traits, lane closures, and
+/// speed limits of the fleet. The fleet replaces its planner whenever any of
+/// those change, so stale entries can never be found, and the fleet drops
+/// them with forget().
+class PlanCache
+{
+public:
+
+  using Planner = rmf_traffic::agv::Planner;
+
+  struct Key
+  {
+    const Planner* planner;
+    std::size_t start_waypoint;
+    int64_t start_orientation;
+    std::optional<std::size_t> start_lane;
+    std::optional<std::array<int64_t, 2>> start_location;
+    std::size_t goal_waypoint;
+    std::optional<int64_t> goal_orientation;
+
+    bool operator==(const Key& other) const;
+  };
+
+  /// Make a key for a plan request. Orientations are rounded to the nearest
+  /// degree and locations to the nearest 10cm, since the cached costs are only
+  /// used as references for other searches.
+  static Key make_key(
+    const Planner& planner,
+    const rmf_traffic::agv::Plan::Start& start,
+    const rmf_traffic::agv::Plan::Goal& goal);
+
+  /// The cache that is shared by all the fleets of this process.
+  static PlanCache& get();
+
+  explicit PlanCache(std::size_t capacity = 1000);
+
+  /// Get the cost of a greedy plan if it is in the cache.
+  std::optional<double> find(const Key& key);
+
+  /// Add the cost of a greedy plan to the cache. The planner must be the one
+  /// that the key was made for.
+  void insert(
+    const Key& key,
+    const std::shared_ptr<const Planner>& planner,
+    double cost);
+
+  /// Drop every entry that was made with this planner, along with any entries
+  /// whose planners no longer exist.
+  void forget(const std::shared_ptr<const Planner>& planner);
+
+  /// Number of entries in the cache
+  std::size_t size() const;
+
+private:
+
+  struct KeyHash
+  {
+    std::size_t operator()(const Key& key) const;
+  };
+
+  struct Entry
+  {
+    Key key;
+    std::weak_ptr<const Planner> planner;
+    double cost;
+  };
+
+  using Entries = std::list<Entry>;
+
+  mutable std::mutex _mutex;
+  std::size_t _capacity;
+
+  // The most recently used entries are at the front
+  Entries _entries;
+  std::unordered_map<Key, Entries::iterator, KeyHash> _lookup;
+};
+
+} // namespace jobs
+} // namespace rmf_fleet_adapter
+
+#endif // SRC__RMF_FLEET_ADAPTER__JOBS__PLANCACHE_HPP
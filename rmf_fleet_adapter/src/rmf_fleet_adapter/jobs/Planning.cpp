@@ -50,6 +50,15 @@ void Planning::discard()
   _current_result = rmf_utils::nullopt;
 }
 
+//==============================================================================
+void Planning::prioritize(
+  const PlanningExecutor::Priority priority,
+  const std::size_t owner)
+{
+  _priority = priority;
+  _owner = owner;
+}
+
 //==============================================================================
 bool Planning::active() const
 {
@@ -18,6 +18,8 @@
 #ifndef SRC__RMF_FLEET_ADAPTER__JOBS__PLANNINGJOB_HPP
 #define SRC__RMF_FLEET_ADAPTER__JOBS__PLANNINGJOB_HPP
 
+#include "PlanningExecutor.hpp"
+
 #include <rmf_rxcpp/RxJobs.hpp>
 #include <rmf_traffic/agv/Planner.hpp>
 #include <rmf_traffic/agv/RouteValidator.hpp>
@@ -51,6 +53,17 @@ public:
 
   void discard();
 
+  /// Choose how this job should be scheduled on the PlanningExecutor. By
+  /// default jobs are replans that all share the same owner.
+  ///
+  /// \param[in] priority
+  ///   The priority class of the job
+  ///
+  /// \param[in] owner
+  ///   The jobs of each owner take turns with the jobs of the other owners.
+  ///   This should usually be the ID of the participant that the plan is for.
+  void prioritize(PlanningExecutor::Priority priority, std::size_t owner);
+
   bool active() const;
 
   rmf_traffic::agv::Planner::Result& progress();
@@ -61,6 +74,8 @@ private:
   mutable std::mutex _resume_mutex;
   std::function<void()> _resume;
   rmf_utils::optional<rmf_traffic::agv::Planner::Result> _current_result;
+  PlanningExecutor::Priority _priority = PlanningExecutor::Priority::replan;
+  std::size_t _owner = 0;
 
   std::unique_lock<std::mutex> _lock_resume() const;
 };
@@ -0,0 +1,197 @@
+/*
+ * Copyright (C) 2022 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include "PlanningExecutor.hpp"
+
+#include <algorithm>
+
+namespace rmf_fleet_adapter {
+namespace jobs {
+
+//==============================================================================
+PlanningExecutor& PlanningExecutor::get()
+{
+  static PlanningExecutor executor;
+  return executor;
+}
+
+//==============================================================================
+PlanningExecutor::PlanningExecutor(std::size_t threads)
+{
+  set_thread_count(threads);
+}
+
+//==============================================================================
+void PlanningExecutor::set_thread_count(std::size_t threads)
+{
+  if (threads == 0)
+    threads = std::max(1u, std::thread::hardware_concurrency());
+
+  std::vector<std::thread> retired;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _target_threads = threads;
+    while (_threads.size() < _target_threads)
+    {
+      const std::size_t index = _threads.size();
+      _threads.emplace_back([this, index]() { _work(index); });
+    }
+
+    while (_threads.size() > _target_threads)
+    {
+      retired.push_back(std::move(_threads.back()));
+      _threads.pop_back();
+    }
+  }
+
+  _cv.notify_all();
+  for (auto& t : retired)
+    t.join();
+}
+
+//==============================================================================
+std::size_t PlanningExecutor::thread_count() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _target_threads;
+}
+
+//==============================================================================
+void PlanningExecutor::post(
+  const Priority priority,
+  const std::size_t owner,
+  std::function<void()> job)
+{
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto& level = _levels[static_cast<std::size_t>(priority)];
+    auto& queue = level.queues[owner];
+    if (queue.empty())
+      level.turns.push_back(owner);
+
+    queue.push_back(Job{std::move(job), Clock::now()});
+    ++level.size;
+  }
+
+  _cv.notify_one();
+}
+
+//==============================================================================
+auto PlanningExecutor::take_metrics() -> Metrics
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  Metrics metrics;
+  for (std::size_t i = 0; i < NumPriorities; ++i)
+  {
+    metrics.queue_depth[i] = _levels[i].size;
+    metrics.started[i] = _started[i];
+    if (_started[i] > 0)
+      metrics.mean_wait[i] = _total_wait[i] / _started[i];
+
+    metrics.max_wait[i] = _max_wait[i];
+
+    _started[i] = 0;
+    _total_wait[i] = Clock::duration(0);
+    _max_wait[i] = Clock::duration(0);
+  }
+
+  return metrics;
+}
+
+//==============================================================================
+PlanningExecutor::~PlanningExecutor()
+{
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _quit = true;
+  }
+
+  _cv.notify_all();
+  for (auto& t : _threads)
+    t.join();
+}
+
+//==============================================================================
+void PlanningExecutor::_work(const std::size_t index)
+{
+  std::unique_lock<std::mutex> lock(_mutex);
+  while (true)
+  {
+    _cv.wait(lock, [&]()
+      {
+        if (_quit || index >= _target_threads)
+          return true;
+
+        for (const auto& level : _levels)
+        {
+          if (level.size > 0)
+            return true;
+        }
+
+        return false;
+      });
+
+    if (_quit || index >= _target_threads)
+      return;
+
+    std::optional<Job> job;
+    std::size_t priority = 0;
+    for (; priority < NumPriorities && !job.has_value(); ++priority)
+      job = _pop(priority);
+
+    if (!job.has_value())
+      continue;
+
+    --priority;
+    const auto wait = Clock::now() - job->posted;
+    ++_started[priority];
+    _total_wait[priority] += wait;
+    _max_wait[priority] = std::max(_max_wait[priority], wait);
+
+    lock.unlock();
+    job->run();
+    job.reset();
+    lock.lock();
+  }
+}
+
+//==============================================================================
+auto PlanningExecutor::_pop(const std::size_t priority) -> std::optional<Job>
+{
+  auto& level = _levels[priority];
+  if (level.turns.empty())
+    return std::nullopt;
+
+  const std::size_t owner = level.turns.front();
+  level.turns.pop_front();
+
+  const auto it = level.queues.find(owner);
+  Job job = std::move(it->second.front());
+  it->second.pop_front();
+  --level.size;
+
+  // Owners that still have jobs waiting go to the back of the line
+  if (it->second.empty())
+    level.queues.erase(it);
+  else
+    level.turns.push_back(owner);
+
+  return job;
+}
+
+} // namespace jobs
+} // namespace rmf_fleet_adapter
@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 2022 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SRC__RMF_FLEET_ADAPTER__JOBS__PLANNINGEXECUTOR_HPP
+#define SRC__RMF_FLEET_ADAPTER__JOBS__PLANNINGEXECUTOR_HPP
+
+#include <rmf_traffic/Time.hpp>
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace rmf_fleet_adapter {
+namespace jobs {
+
+//==============================================================================
+/// A bounded pool of threads that runs the planning steps of the fleet
+/// adapter. Steps are run in order of their priority class, and the steps of
+/// each class take turns between their owners (usually the robots that the
+/// plans are for) so that one robot with many searches in flight cannot starve
+/// the others.
+class PlanningExecutor
+{
+public:
+
+  enum class Priority : std::size_t
+  {
+    /// Responses to traffic negotiations. Other participants are waiting on
+    /// these, so they always go first.
+    negotiation = 0,
+
+    /// Plans that robots need in order to keep moving
+    replan,
+
+    /// Plans that are only used to estimate the cost of a task
+    bid_estimate
+  };
+
+  static constexpr std::size_t NumPriorities = 3;
+
+  struct Metrics
+  {
+    /// How many steps of each priority class are waiting to run
+    std::array<std::size_t, NumPriorities> queue_depth = {};
+
+    /// How many steps of each priority class began running since the
+    /// metrics were last taken
+    std::array<std::size_t, NumPriorities> started = {};
+
+    /// The average time that those steps waited in the queue
+    std::array<rmf_traffic::Duration, NumPriorities> mean_wait = {};
+
+    /// The longest time that any of those steps waited in the queue
+    std::array<rmf_traffic::Duration, NumPriorities> max_wait = {};
+  };
+
+  /// The executor that is shared by all the planning jobs of this process.
+  static PlanningExecutor& get();
+
+  /// Constructor
+  ///
+  /// \param[in] threads
+  ///   The number of threads to plan with. If this is 0, the hardware
+  ///   concurrency will be used.
+  explicit PlanningExecutor(std::size_t threads = 0);
+
+  /// Change the number of threads. Threads that are removed will finish the
+  /// step that they are currently running first.
+  void set_thread_count(std::size_t threads);
+
+  /// Get the number of threads
+  std::size_t thread_count() const;
+
+  /// Queue up a planning step. The step must not throw.
+  void post(Priority priority, std::size_t owner, std::function<void()> job);
+
+  /// Get the current queue depths and the wait times of the steps that began
+  /// running since the last time this was called.
+  Metrics take_metrics();
+
+  ~PlanningExecutor();
+
+private:
+
+  using Clock = std::chrono::steady_clock;
+
+  struct Job
+  {
+    std::function<void()> run;
+    Clock::time_point posted;
+  };
+
+  struct Level
+  {
+    std::unordered_map<std::size_t, std::deque<Job>> queues;
+
+    // The owners that have jobs waiting, in the order that they get their turn
+    std::deque<std::size_t> turns;
+
+    std::size_t size = 0;
+  };
+
+  void _work(std::size_t index);
+
+  std::optional<Job> _pop(std::size_t priority);
+
+  mutable std::mutex _mutex;
+  std::condition_variable _cv;
+  std::array<Level, NumPriorities> _levels;
+  std::vector<std::thread> _threads;
+  std::size_t _target_threads = 0;
+  bool _quit = false;
+
+  std::array<std::size_t, NumPriorities> _started = {};
+  std::array<Clock::duration, NumPriorities> _total_wait = {};
+  std::array<Clock::duration, NumPriorities> _max_wait = {};
+};
+
+} // namespace jobs
+} // namespace rmf_fleet_adapter
+
+#endif // SRC__RMF_FLEET_ADAPTER__JOBS__PLANNINGEXECUTOR_HPP
@@ -53,7 +53,8 @@ SearchForPath::SearchForPath(
   std::shared_ptr<const rmf_traffic::schedule::Snapshot> schedule,
   rmf_traffic::schedule::ParticipantId participant_id,
   const std::shared_ptr<const rmf_traffic::Profile>& profile,
-  std::optional<rmf_traffic::Duration> planning_time_limit)
+  std::optional<rmf_traffic::Duration> planning_time_limit,
+  std::shared_ptr<const GreedyReference> previous)
 : _planner(std::move(planner)),
   _starts(std::move(starts)),
   _goal(std::move(goal)),
@@ -81,16 +82,55 @@ SearchForPath::SearchForPath(
   const double base_cost = *greedy_setup.cost_estimate();
   greedy_setup.options().maximum_cost_estimate(_greedy_leeway*base_cost);
 
+  // If another robot of this fleet already solved the same greedy problem, the
+  // compliant search can start with the ceiling that the greedy plan would
+  // give it.
+  double reference_cost = base_cost;
+  if (!greedy_starts.empty())
+  {
+    _cache_key = PlanCache::make_key(*_planner, greedy_starts.front(), _goal);
+    _cached_greedy_cost = PlanCache::get().find(*_cache_key);
+    _reuse.cached_greedy_cost = _cached_greedy_cost.has_value();
+
+    // When replanning, the robot is usually somewhere along the greedy plan
+    // of the previous search, and the rest of that plan is still optimal.
+    std::optional<std::pair<double, double>> remaining;
+    if (previous)
+    {
+      remaining = previous->remaining_cost(
+        *_planner, greedy_starts.front(), _goal);
+
+      // Hold on to the previous plan in case this search never runs its own
+      // greedy search, so that the next replan can keep reusing it.
+      if (remaining.has_value())
+        _previous_greedy_plan = std::move(previous);
+    }
+
+    if (!_cached_greedy_cost.has_value() && remaining.has_value())
+    {
+      _cached_greedy_cost = remaining->first;
+      _reuse.previous_greedy_plan = true;
+      _reuse.reused_fraction = remaining->second;
+    }
+
+    if (_cached_greedy_cost.has_value())
+      reference_cost = *_cached_greedy_cost;
+  }
+
   auto compliant_options = _planner->get_default_options();
   compliant_options.validator(
     rmf_traffic::agv::ScheduleRouteValidator::make(
       _schedule, _participant_id, *profile));
-  compliant_options.maximum_cost_estimate(_compliant_leeway*base_cost);
-  greedy_options.interrupter(make_interrupter(_interrupt_flag, _deadline));
+  compliant_options.maximum_cost_estimate(_compliant_leeway*reference_cost);
+  compliant_options.interrupter(make_interrupter(_interrupt_flag, _deadline));
   auto compliant_setup = _planner->setup(_starts, _goal, compliant_options);
 
   _greedy_job = std::make_shared<Planning>(std::move(greedy_setup));
   _compliant_job = std::make_shared<Planning>(std::move(compliant_setup));
+
+  _greedy_job->prioritize(PlanningExecutor::Priority::replan, _participant_id);
+  _compliant_job->prioritize(
+    PlanningExecutor::Priority::replan, _participant_id);
 }
 
 //==============================================================================
@@ -129,5 +169,74 @@ void SearchForPath::set_cost_limit(double cost)
   _explicit_cost_limit = cost;
 }
 
+//==============================================================================
+auto SearchForPath::reuse() const -> Reuse
+{
+  Reuse reuse = _reuse;
+  reuse.greedy_skipped = _cached_greedy_cost.has_value()
+    && !_explicit_cost_limit && !_greedy_finished && _compliant_finished
+    && _compliant_job->progress().success();
+
+  return reuse;
+}
+
+//==============================================================================
+auto SearchForPath::greedy_reference() const
+-> std::shared_ptr<const GreedyReference>
+{
+  if (!_greedy_finished || !_greedy_job->progress().success())
+    return _previous_greedy_plan;
+
+  const auto& plan = *_greedy_job->progress();
+  return std::make_shared<GreedyReference>(
+    GreedyReference{_planner, _goal, plan.get_waypoints(), plan.get_cost()});
+}
+
+//==============================================================================
+std::optional<std::pair<double, double>>
+SearchForPath::GreedyReference::remaining_cost(
+  const rmf_traffic::agv::Planner& planner_,
+  const rmf_traffic::agv::Plan::Start& start,
+  const rmf_traffic::agv::Plan::Goal& goal_) const
+{
+  // A different planner may have different lanes or speed limits
+  if (planner.get() != &planner_)
+    return std::nullopt;
+
+  if (goal.waypoint() != goal_.waypoint())
+    return std::nullopt;
+
+  const double* prev_orientation = goal.orientation();
+  const double* orientation = goal_.orientation();
+  if (static_cast<bool>(prev_orientation) != static_cast<bool>(orientation))
+    return std::nullopt;
+
+  if (orientation && *orientation != *prev_orientation)
+    return std::nullopt;
+
+  if (waypoints.size() < 2)
+    return std::nullopt;
+
+  const auto begin = waypoints.front().time();
+  const auto finish = waypoints.back().time();
+  const double total = rmf_traffic::time::to_seconds(finish - begin);
+  if (total <= 0.0)
+    return std::nullopt;
+
+  for (const auto& wp : waypoints)
+  {
+    if (wp.graph_index() != start.waypoint())
+      continue;
+
+    // The greedy cost is dominated by travel time, so the cost of the rest of
+    // the plan is estimated from the time that is left in it.
+    const double fraction =
+      rmf_traffic::time::to_seconds(finish - wp.time()) / total;
+    return std::make_pair(cost * fraction, fraction);
+  }
+
+  return std::nullopt;
+}
+
 } // namespace jobs
 } // namespace rmf_fleet_adapter
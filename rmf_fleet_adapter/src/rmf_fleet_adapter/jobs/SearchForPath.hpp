@@ -18,6 +18,7 @@
 #ifndef SRC__RMF_FLEET_ADAPTER__JOBS__SEARCHFORPATH_HPP
 #define SRC__RMF_FLEET_ADAPTER__JOBS__SEARCHFORPATH_HPP
 
+#include "PlanCache.hpp"
 #include "Planning.hpp"
 
 namespace rmf_fleet_adapter {
@@ -30,10 +31,43 @@ namespace jobs {
 /// plan will generally be preferred, but if it is excessively blocked by other
 /// vehicles on the schedule, then the greedy plan can be used to create an
 /// opening in the traffic schedule.
+///
+/// Both searches are started right away so that they can run on separate
+/// planning threads. The compliant search begins with a cost ceiling derived
+/// from the heuristic, and that ceiling is replaced by one derived from the
+/// greedy plan as soon as the greedy plan is found. If the cost of the greedy
+/// plan is already known from the PlanCache, or can be estimated from the
+/// greedy plan of the previous search when replanning, the compliant search
+/// gets that ceiling from the start.
 class SearchForPath : public std::enable_shared_from_this<SearchForPath>
 {
 public:
 
+  /// The parts of a greedy plan that a later search needs in order to reuse it
+  /// when the robot replans somewhere along that plan
+  struct GreedyReference
+  {
+    /// The planner that produced the plan
+    std::shared_ptr<const rmf_traffic::agv::Planner> planner;
+
+    /// The goal of the plan
+    rmf_traffic::agv::Plan::Goal goal;
+
+    /// The waypoints of the plan
+    std::vector<rmf_traffic::agv::Plan::Waypoint> waypoints;
+
+    /// The cost of the plan
+    double cost;
+
+    /// Estimate the greedy cost of going from start to the goal by following
+    /// the rest of this plan. The second value is the fraction of the plan
+    /// that is still ahead.
+    std::optional<std::pair<double, double>> remaining_cost(
+      const rmf_traffic::agv::Planner& planner,
+      const rmf_traffic::agv::Plan::Start& start,
+      const rmf_traffic::agv::Plan::Goal& goal) const;
+  };
+
   SearchForPath(
     std::shared_ptr<const rmf_traffic::agv::Planner> planner,
     rmf_traffic::agv::Plan::StartSet starts,
@@ -41,7 +75,8 @@ public:
     std::shared_ptr<const rmf_traffic::schedule::Snapshot> schedule,
     rmf_traffic::schedule::ParticipantId participant_id,
     const std::shared_ptr<const rmf_traffic::Profile>& profile,
-    std::optional<rmf_traffic::Duration> planning_time_limit);
+    std::optional<rmf_traffic::Duration> planning_time_limit,
+    std::shared_ptr<const GreedyReference> previous = nullptr);
 
   enum class Type
   {
@@ -49,6 +84,23 @@ public:
     compliant
   };
 
+  /// How much of the earlier work this search was able to reuse
+  struct Reuse
+  {
+    /// The greedy cost came from the PlanCache
+    bool cached_greedy_cost = false;
+
+    /// The greedy cost came from the rest of the previous search's greedy plan
+    bool previous_greedy_plan = false;
+
+    /// The fraction of the previous greedy plan that was still ahead of the
+    /// robot, or 0 if the previous plan was not reused
+    double reused_fraction = 0.0;
+
+    /// The greedy search was never run because the compliant search succeeded
+    bool greedy_skipped = false;
+  };
+
   struct Result
   {
     std::shared_ptr<Planning> greedy_job;
@@ -65,6 +117,15 @@ public:
 
   void set_cost_limit(double cost);
 
+  /// Get what this search reused from earlier work
+  Reuse reuse() const;
+
+  /// Get the greedy plan of this search so that the next replan can reuse it.
+  /// If this search did not find a greedy plan of its own, the previous greedy
+  /// plan that it reused is passed along instead. This will be a nullptr if
+  /// there is no greedy plan to reuse.
+  std::shared_ptr<const GreedyReference> greedy_reference() const;
+
   Planning& greedy();
   const Planning& greedy() const;
 
@@ -72,6 +133,10 @@ public:
   const Planning& compliant() const;
 
 private:
+
+  template<typename Subscriber>
+  void _start_greedy(const Subscriber& s);
+
   std::shared_ptr<const rmf_traffic::agv::Planner> _planner;
   rmf_traffic::agv::Plan::StartSet _starts;
   rmf_traffic::agv::Plan::Goal _goal;
@@ -95,6 +160,25 @@ private:
   rmf_rxcpp::subscription_guard _compliant_sub;
   bool _compliant_finished = false;
 
+  // The compliant job starts with a cost ceiling that is based on the
+  // heuristic estimate so that it can run alongside the greedy job. If it hits
+  // that ceiling before the greedy job is finished, it waits here until the
+  // greedy job can provide a more realistic ceiling.
+  bool _compliant_parked = false;
+
+  // When the cost of the greedy plan is already in the fleet's PlanCache or
+  // can be estimated from the previous search, the greedy search is only run
+  // if the compliant search fails, since its plan would only be needed as a
+  // backup.
+  std::optional<PlanCache::Key> _cache_key;
+  std::optional<double> _cached_greedy_cost;
+  bool _greedy_deferred = false;
+  Reuse _reuse;
+
+  // The greedy plan of the previous search, if it leads from our start to our
+  // goal. It is passed along when our own greedy search does not run.
+  std::shared_ptr<const GreedyReference> _previous_greedy_plan;
+
   rmf_utils::optional<double> _explicit_cost_limit;
 
   rxcpp::schedulers::worker _worker;
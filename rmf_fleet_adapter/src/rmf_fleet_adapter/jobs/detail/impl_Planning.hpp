@@ -49,18 +49,43 @@ void Planning::operator()(const Subscriber& s, const Worker& w)
   if (!_current_result)
     return;
 
-  _current_result->resume();
+  // The search itself runs on the planning executor so that the number of
+  // threads that are planning at once is bounded and the most urgent plans
+  // get to go first.
+  PlanningExecutor::get().post(
+    _priority, _owner,
+    [a = weak_from_this(), s]()
+    {
+      const auto self = a.lock();
+      if (!self || !self->_current_result)
+        return;
 
-  const bool completed =
-    _current_result->success() || !_current_result->cost_estimate();
+      // Nobody is waiting for this plan anymore, so don't bother with it
+      if (!s.is_subscribed())
+        return;
 
-  s.on_next(Result{shared_from_this()});
-  if (completed)
-  {
-    // The plan is either finished or is guaranteed to never finish
-    s.on_completed();
-    return;
-  }
+      try
+      {
+        self->_current_result->resume();
+      }
+      catch (...)
+      {
+        s.on_error(std::current_exception());
+        return;
+      }
+
+      const bool completed =
+      self->_current_result->success()
+      || !self->_current_result->cost_estimate();
+
+      s.on_next(Result{self});
+      if (completed)
+      {
+        // The plan is either finished or is guaranteed to never finish
+        s.on_completed();
+        return;
+      }
+    });
 }
 
 } // namespace jobs
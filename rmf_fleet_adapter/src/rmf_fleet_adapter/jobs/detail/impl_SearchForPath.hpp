@@ -62,6 +62,142 @@ void SearchForPath::operator()(const Subscriber& s, const Worker&)
       _explicit_cost_limit);
   }
 
+  if (_cached_greedy_cost.has_value() && !_explicit_cost_limit)
+    _greedy_deferred = true;
+  else
+    _start_greedy(s);
+
+  _compliant_sub = rmf_rxcpp::make_job<Planning::Result>(_compliant_job)
+    .observe_on(rxcpp::identity_same_worker(_worker))
+    .subscribe(
+    [weak = weak_from_this(), s](const Planning::Result& result)
+    {
+      const auto search = weak.lock();
+      if (!search)
+        return;
+
+      if (search->_deadline.has_value())
+      {
+        const auto now = std::chrono::steady_clock::now();
+        if (search->_deadline <= now)
+          search->interrupt();
+      }
+
+      auto& r = result.job->progress();
+      if (search->_greedy_deferred)
+      {
+        search->_greedy_deferred = false;
+        if (r.success())
+        {
+          search->_compliant_finished = true;
+          s.on_next(Result{nullptr, search->_compliant_job, Type::compliant});
+          s.on_completed();
+          return;
+        }
+
+        if (*search->_interrupt_flag)
+        {
+          // There is no time left to find a backup plan
+          search->_compliant_finished = true;
+          s.on_next(Result{search->_greedy_job, search->_compliant_job,
+              Type::greedy});
+          s.on_completed();
+          return;
+        }
+
+        // The cached greedy cost is only an estimate, so the ceiling that it
+        // gave the compliant search may have been too tight. Park the
+        // compliant search so it can be resumed with a ceiling based on the
+        // real greedy plan, unless the search space itself was exhausted.
+        if (r.saturated() || !r.cost_estimate())
+          search->_compliant_finished = true;
+        else
+          search->_compliant_parked = true;
+
+        // Fall back on a greedy plan after all
+        search->_start_greedy(s);
+        return;
+      }
+
+      auto show_greedy = search->_greedy_finished ?
+      search->_greedy_job : std::shared_ptr<Planning>(nullptr);
+
+      Result next{show_greedy, search->_compliant_job, Type::compliant};
+
+      if (r.success())
+      {
+        // Return the successful schedule-compliant plan
+        if (search->_greedy_finished || search->_explicit_cost_limit)
+        {
+          s.on_next(next);
+        }
+        search->_compliant_finished = true;
+
+        if (search->_greedy_finished)
+          s.on_completed();
+
+        return;
+      }
+
+      if (*search->_interrupt_flag || r.saturated() || !r.cost_estimate())
+      {
+        if (search->_greedy_finished)
+        {
+          s.on_next(next);
+          s.on_completed();
+        }
+        else if (search->_explicit_cost_limit)
+        {
+          s.on_next(next);
+        }
+
+        search->_compliant_finished = true;
+        return;
+      }
+
+      if (search->_explicit_cost_limit)
+      {
+        // An explicit cost limit means this is part of a Job, so we should
+        // report an update whenever we get an update.
+        s.on_next(next);
+        // We do not automatically resume, because that should be the choice of
+        // whoever we are reporting to.
+        return;
+      }
+
+      if (search->_greedy_finished)
+      {
+        // We don't have an explicit cost limit, so we'll just check if the
+        // greedy job search has granted us any more leeway.
+        const double new_maximum =
+        search->_compliant_leeway * search->_greedy_job->progress()->get_cost();
+
+        if (*r.options().maximum_cost_estimate() < new_maximum)
+        {
+          // Push the maximum out a bit more and let the job try again.
+          r.options().maximum_cost_estimate(new_maximum);
+          result.job->resume();
+          return;
+        }
+
+        // We shouldn't keep trying, because we have exceeded the cost limit, even
+        // when accounting for the greedy plan cost.
+        s.on_next(next);
+        s.on_completed();
+        return;
+      }
+
+      // The compliant search has used up the provisional cost ceiling that was
+      // estimated from the heuristic. It will be resumed with a ceiling based
+      // on the cost of the greedy plan once that plan has been found.
+      search->_compliant_parked = true;
+    });
+}
+
+//==============================================================================
+template<typename Subscriber>
+void SearchForPath::_start_greedy(const Subscriber& s)
+{
   _greedy_sub = rmf_rxcpp::make_job<Planning::Result>(_greedy_job)
     .observe_on(rxcpp::identity_same_worker(_worker))
     .subscribe(
@@ -86,6 +222,13 @@ void SearchForPath::operator()(const Subscriber& s, const Worker&)
       const auto& r = result.job->progress();
       if (r.success())
       {
+        if (search->_cache_key.has_value())
+        {
+          PlanCache::get().insert(
+            *search->_cache_key, search->_planner, r->get_cost());
+        }
+
+        search->_greedy_finished = true;
         if (search->_compliant_finished)
         {
           s.on_next(next);
@@ -95,12 +238,32 @@ void SearchForPath::operator()(const Subscriber& s, const Worker&)
         else if (search->_explicit_cost_limit)
         {
           s.on_next(next);
-
-          search->_greedy_finished = true;
           return;
         }
 
-        search->_greedy_finished = true;
+        if (search->_compliant_parked)
+        {
+          // Now that we know what the greedy plan costs, the compliant search
+          // can be given its real cost ceiling instead of the provisional one
+          // that came from the heuristic.
+          search->_compliant_parked = false;
+          auto& compliant = search->_compliant_job->progress();
+          const double ceiling = search->_compliant_leeway * r->get_cost();
+          if (*compliant.options().maximum_cost_estimate() < ceiling)
+          {
+            compliant.options().maximum_cost_estimate(ceiling);
+            search->_compliant_job->resume();
+            return;
+          }
+
+          // The compliant search already failed to find a plan within this
+          // ceiling, so the greedy plan is the best we can do.
+          search->_compliant_finished = true;
+          s.on_next(Result{search->_greedy_job, search->_compliant_job,
+              Type::greedy});
+          s.on_completed();
+        }
+
         return;
       }
 
@@ -170,96 +333,6 @@ void SearchForPath::operator()(const Subscriber& s, const Worker&)
       // We do not automatically resume, because that should be the choice of
       // whoever we are reporting to
     });
-
-  _compliant_sub = rmf_rxcpp::make_job<Planning::Result>(_compliant_job)
-    .observe_on(rxcpp::identity_same_worker(_worker))
-    .subscribe(
-    [weak = weak_from_this(), s](const Planning::Result& result)
-    {
-      const auto search = weak.lock();
-      if (!search)
-        return;
-
-      if (search->_deadline.has_value())
-      {
-        const auto now = std::chrono::steady_clock::now();
-        if (search->_deadline <= now)
-          search->interrupt();
-      }
-
-      auto show_greedy = search->_greedy_finished ?
-      search->_greedy_job : std::shared_ptr<Planning>(nullptr);
-
-      Result next{show_greedy, search->_compliant_job, Type::compliant};
-
-      auto& r = result.job->progress();
-      if (r.success())
-      {
-        // Return the successful schedule-compliant plan
-        if (search->_greedy_finished || search->_explicit_cost_limit)
-        {
-          s.on_next(next);
-        }
-        search->_compliant_finished = true;
-
-        if (search->_greedy_finished)
-          s.on_completed();
-
-        return;
-      }
-
-      if (*search->_interrupt_flag || r.saturated() || !r.cost_estimate())
-      {
-        if (search->_greedy_finished)
-        {
-          s.on_next(next);
-          s.on_completed();
-        }
-        else if (search->_explicit_cost_limit)
-        {
-          s.on_next(next);
-        }
-
-        search->_compliant_finished = true;
-        return;
-      }
-
-      if (search->_explicit_cost_limit)
-      {
-        // An explicit cost limit means this is part of a Job, so we should
-        // report an update whenever we get an update.
-        s.on_next(next);
-        // We do not automatically resume, because that should be the choice of
-        // whoever we are reporting to.
-        return;
-      }
-
-      if (search->_greedy_finished)
-      {
-        // We don't have an explicit cost limit, so we'll just check if the
-        // greedy job search has granted us any more leeway.
-        const double new_maximum =
-        search->_compliant_leeway * search->_greedy_job->progress()->get_cost();
-
-        if (*r.options().maximum_cost_estimate() < new_maximum)
-        {
-          // Push the maximum out a bit more and let the job try again.
-          r.options().maximum_cost_estimate(new_maximum);
-          result.job->resume();
-          return;
-        }
-
-        // We shouldn't keep trying, because we have exceeded the cost limit, even
-        // when accounting for the greedy plan cost.
-        s.on_next(next);
-        s.on_completed();
-        return;
-      }
-
-      // Discard the job because it can no longer produce an acceptable result.
-      // The SearchForPath will continue looking for a greedy plan.
-      search->_compliant_finished = true;
-    });
 }
 
 } // namespace jobs
@@ -28,7 +28,8 @@ FindPath::FindPath(
   std::shared_ptr<const rmf_traffic::schedule::Snapshot> schedule,
   rmf_traffic::schedule::ParticipantId participant_id,
   const std::shared_ptr<const rmf_traffic::Profile>& profile,
-  std::optional<rmf_traffic::Duration> planning_time_limit)
+  std::optional<rmf_traffic::Duration> planning_time_limit,
+  std::shared_ptr<const jobs::SearchForPath::GreedyReference> previous)
 {
   _search_job = std::make_shared<jobs::SearchForPath>(
     std::move(planner),
@@ -37,7 +38,8 @@ FindPath::FindPath(
     std::move(schedule),
     participant_id,
     profile,
-    planning_time_limit);
+    planning_time_limit,
+    std::move(previous));
 }
 
 //==============================================================================
@@ -46,5 +48,11 @@ void FindPath::interrupt()
   _search_job->interrupt();
 }
 
+//==============================================================================
+std::shared_ptr<const jobs::SearchForPath> FindPath::search() const
+{
+  return _search_job;
+}
+
 } // namespace services
 } // namespace rmf_fleet_adapter
@@ -37,7 +37,9 @@ public:
     std::shared_ptr<const rmf_traffic::schedule::Snapshot> schedule,
     rmf_traffic::schedule::ParticipantId participant_id,
     const std::shared_ptr<const rmf_traffic::Profile>& profile,
-    std::optional<rmf_traffic::Duration> planning_time_limit);
+    std::optional<rmf_traffic::Duration> planning_time_limit,
+    std::shared_ptr<const jobs::SearchForPath::GreedyReference> previous =
+    nullptr);
 
   using Result = rmf_traffic::agv::Plan::Result;
 
@@ -46,6 +48,11 @@ public:
 
   void interrupt();
 
+  /// The search that this service used. When the robot needs to replan, pass
+  /// its greedy_reference() into the next FindPath so that it can reuse what
+  /// was learned.
+  std::shared_ptr<const jobs::SearchForPath> search() const;
+
 private:
   std::shared_ptr<jobs::SearchForPath> _search_job;
   rmf_rxcpp::subscription_guard _search_sub;
@@ -16,6 +16,7 @@
 */
 
 #include "Negotiate.hpp"
+#include "../project_itinerary.hpp"
 
 namespace rmf_fleet_adapter {
 namespace services {
@@ -108,6 +109,12 @@ std::shared_ptr<Negotiate> Negotiate::emergency_pullover(
     evaluator);
 }
 
+//==============================================================================
+void Negotiate::anytime(const double improvement_threshold)
+{
+  _anytime_improvement = std::max(0.0, improvement_threshold);
+}
+
 //==============================================================================
 void Negotiate::interrupt()
 {
@@ -155,5 +162,95 @@ void Negotiate::_resume_next()
   top->resume();
 }
 
+//==============================================================================
+std::function<void()> Negotiate::_make_submission(
+  const rmf_traffic::agv::Plan::Result& plan) const
+{
+  // The itinerary, approval callback, and so on are copied instead of moved
+  // because an anytime negotiation may submit more than one proposal.
+  return [r = plan,
+      initial_itinerary = _initial_itinerary,
+      followed_by = _followed_by,
+      planner = _planner,
+      approval = _approval,
+      responder = _responder,
+      viewer = _viewer,
+      plan_id = _plan_id]()
+    {
+      std::vector<rmf_traffic::Route> final_itinerary;
+      final_itinerary.reserve(
+        initial_itinerary.size() + r->get_itinerary().size());
+
+      for (const auto& it : {initial_itinerary, r->get_itinerary()})
+      {
+        for (const auto& route : it)
+        {
+          if (route.trajectory().size() > 1)
+            final_itinerary.push_back(route);
+        }
+      }
+
+      final_itinerary = project_itinerary(*r, followed_by, *planner);
+      for (const auto& parent : viewer->base_proposals())
+      {
+        // Make sure all parent dependencies are accounted for
+        // TODO(MXG): This is kind of a gross hack that we add to
+        // force the lookahead to work for patrols. This approach
+        // should be reworked in a future redesign of the traffic
+        // system.
+        for (auto& r : final_itinerary)
+        {
+          for (std::size_t i = 0; i < parent.itinerary.size(); ++i)
+          {
+            r.add_dependency(
+              r.trajectory().size(),
+              rmf_traffic::Dependency{
+                parent.participant,
+                parent.plan,
+                i,
+                parent.itinerary[i].trajectory().size()
+              });
+          }
+        }
+      }
+
+      responder->submit(
+        plan_id,
+        final_itinerary,
+        [
+          plan_id,
+          plan = *r,
+          approval,
+          final_itinerary
+        ]()
+        -> UpdateVersion
+        {
+          if (approval)
+            return approval(plan_id, plan, final_itinerary);
+
+          return rmf_utils::nullopt;
+        });
+    };
+}
+
+//==============================================================================
+bool Negotiate::worth_submitting(
+  const double cost,
+  const rmf_utils::optional<double> submitted_cost,
+  const rmf_utils::optional<double> improvement_threshold)
+{
+  if (!submitted_cost)
+    return true;
+
+  const double improvement = improvement_threshold.value_or(0.0);
+  return cost < (1.0 - improvement) * *submitted_cost;
+}
+
+//==============================================================================
+bool Negotiate::_worth_submitting(const double cost) const
+{
+  return worth_submitting(cost, _submitted_cost, _anytime_improvement);
+}
+
 } // namespace services
 } // namespace rmf_fleet_adapter
@@ -73,12 +73,37 @@ public:
     ApprovalCallback approval,
     ProgressEvaluator evaluator);
 
+  /// The default fraction by which an anytime proposal must be improved
+  /// before a revised proposal will be submitted.
+  static constexpr double DefaultAnytimeImprovement = 0.1;
+
   struct Result
   {
     std::shared_ptr<Negotiate> service;
     std::function<void()> respond;
+
+    /// True if this result carries an early proposal and the service will keep
+    /// searching for a better one. Subscribers should call respond() but keep
+    /// the service alive until a result arrives with this set to false.
+    bool provisional = false;
   };
 
+  /// Submit the first successful plan that is found as a provisional proposal
+  /// instead of waiting for every planning job to settle. A revised proposal
+  /// will be submitted while the table is still open if a later plan costs at
+  /// least this fraction less than the last one that was submitted.
+  ///
+  /// This must be called before the service is subscribed to.
+  void anytime(double improvement_threshold = DefaultAnytimeImprovement);
+
+  /// Decide whether a plan with the given cost should be submitted. Anything
+  /// is worth submitting if nothing has been submitted yet. Otherwise the cost
+  /// must be at least the improvement threshold below the submitted cost.
+  static bool worth_submitting(
+    double cost,
+    rmf_utils::optional<double> submitted_cost,
+    rmf_utils::optional<double> improvement_threshold);
+
   template<typename Subscriber>
   void operator()(const Subscriber& s);
 
@@ -96,6 +121,11 @@ private:
 
   void _resume_next();
 
+  std::function<void()> _make_submission(
+    const rmf_traffic::agv::Plan::Result& plan) const;
+
+  bool _worth_submitting(double cost) const;
+
   rmf_traffic::PlanId _plan_id;
   std::shared_ptr<const rmf_traffic::agv::Planner> _planner;
   rmf_traffic::agv::Plan::StartSet _starts;
@@ -130,6 +160,8 @@ private:
   rmf_rxcpp::subscription_guard _rollout_sub;
   bool _finished = false;
   bool _attempting_rollout = false;
+  rmf_utils::optional<double> _anytime_improvement;
+  rmf_utils::optional<double> _submitted_cost;
 
   using Alternatives = std::vector<rmf_traffic::schedule::Itinerary>;
   rmf_utils::optional<Alternatives> _alternatives;
@@ -19,7 +19,6 @@
 #define SRC__RMF_FLEET_ADAPTER__SERVICES__DETAIL__IMPL_NEGOTIATE_HPP
 
 #include "../Negotiate.hpp"
-#include "../../project_itinerary.hpp"
 
 namespace rmf_fleet_adapter {
 namespace services {
@@ -55,6 +54,10 @@ void Negotiate::operator()(const Subscriber& s)
         rmf_traffic::agv::Plan::Options(validator)
         .interrupter(interrupter));
 
+      job->prioritize(
+        jobs::PlanningExecutor::Priority::negotiation,
+        _viewer->sequence().back().participant);
+
       _evaluator.initialize(job->progress());
 
       _queued_jobs.emplace_back(std::move(job));
@@ -85,73 +88,14 @@ void Negotiate::operator()(const Subscriber& s)
         {
           self->_finished = true;
           // This means we found a successful plan to submit to the negotiation.
-          s.on_next(
-            Result{
-              self->shared_from_this(),
-              [r = *self->_evaluator.best_result.progress,
-              initial_itinerary = std::move(self->_initial_itinerary),
-              followed_by = self->_followed_by,
-              planner = self->_planner,
-              approval = std::move(self->_approval),
-              responder = self->_responder,
-              viewer = self->_viewer,
-              plan_id = self->_plan_id]()
-              {
-                std::vector<rmf_traffic::Route> final_itinerary;
-                final_itinerary.reserve(
-                  initial_itinerary.size() + r->get_itinerary().size());
-
-                for (const auto& it : {initial_itinerary, r->get_itinerary()})
-                {
-                  for (const auto& route : it)
-                  {
-                    if (route.trajectory().size() > 1)
-                      final_itinerary.push_back(route);
-                  }
-                }
-
-                final_itinerary = project_itinerary(*r, followed_by, *planner);
-                for (const auto& parent : viewer->base_proposals())
-                {
-                  // Make sure all parent dependencies are accounted for
-                  // TODO(MXG): This is kind of a gross hack that we add to
-                  // force the lookahead to work for patrols. This approach
-                  // should be reworked in a future redesign of the traffic
-                  // system.
-                  for (auto& r : final_itinerary)
-                  {
-                    for (std::size_t i = 0; i < parent.itinerary.size(); ++i)
-                    {
-                      r.add_dependency(
-                        r.trajectory().size(),
-                        rmf_traffic::Dependency{
-                          parent.participant,
-                          parent.plan,
-                          i,
-                          parent.itinerary[i].trajectory().size()
-                        });
-                    }
-                  }
-                }
-
-                responder->submit(
-                  plan_id,
-                  final_itinerary,
-                  [
-                    plan_id,
-                    plan = *r,
-                    approval = std::move(approval),
-                    final_itinerary
-                  ]()
-                  -> UpdateVersion
-                  {
-                    if (approval)
-                      return approval(plan_id, plan, final_itinerary);
-
-                    return rmf_utils::nullopt;
-                  });
-              }
-            });
+          // If an anytime proposal was already submitted, then we only revise
+          // it when this plan is a meaningful improvement.
+          const auto& best = self->_evaluator.best_result;
+          std::function<void()> respond = []() {};
+          if (self->_worth_submitting(best.cost))
+            respond = self->_make_submission(*best.progress);
+
+          s.on_next(Result{self->shared_from_this(), std::move(respond)});
 
           s.on_completed();
           self->interrupt();
@@ -201,6 +145,22 @@ void Negotiate::operator()(const Subscriber& s)
         // we will consider the service finished when that rollout is ready
       }
 
+      const auto& best = self->_evaluator.best_result;
+      if (self->_anytime_improvement && best.progress
+        && best.progress->success() && !self->_viewer->defunct()
+        && self->_worth_submitting(best.cost))
+      {
+        // Offer the best plan so far to the negotiation right away while the
+        // remaining jobs keep looking for something better.
+        self->_submitted_cost = best.cost;
+        s.on_next(
+          Result{
+            self->shared_from_this(),
+            self->_make_submission(*best.progress),
+            true
+          });
+      }
+
       return false;
     };
 
@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2022 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <jobs/PlanCache.hpp>
+
+#include <rmf_traffic/geometry/Circle.hpp>
+
+#include <rmf_utils/catch.hpp>
+
+namespace {
+//==============================================================================
+std::shared_ptr<const rmf_traffic::agv::Planner> make_planner()
+{
+  rmf_traffic::agv::Graph graph;
+  for (std::size_t i = 0; i < 4; ++i)
+    graph.add_waypoint("test_map", {5.0 * i, 0.0});
+
+  for (std::size_t i = 0; i < 3; ++i)
+  {
+    graph.add_lane(i, i+1);
+    graph.add_lane(i+1, i);
+  }
+
+  const rmf_traffic::agv::VehicleTraits traits{
+    {0.7, 0.3},
+    {1.0, 0.45},
+    rmf_traffic::Profile{
+      rmf_traffic::geometry::make_final_convex<
+        rmf_traffic::geometry::Circle>(1.0)
+    }
+  };
+
+  return std::make_shared<rmf_traffic::agv::Planner>(
+    rmf_traffic::agv::Planner::Configuration{graph, traits},
+    rmf_traffic::agv::Planner::Options{nullptr});
+}
+} // anonymous namespace
+
+//==============================================================================
+SCENARIO("Plan cache keeps the most recently used greedy costs")
+{
+  using rmf_fleet_adapter::jobs::PlanCache;
+  using rmf_traffic::agv::Plan;
+
+  const auto planner = make_planner();
+  const auto now = std::chrono::steady_clock::now();
+
+  PlanCache cache(2);
+  const auto key_0 =
+    PlanCache::make_key(*planner, Plan::Start(now, 0, 0.0), Plan::Goal(3));
+  const auto key_1 =
+    PlanCache::make_key(*planner, Plan::Start(now, 1, 0.0), Plan::Goal(3));
+  const auto key_2 =
+    PlanCache::make_key(*planner, Plan::Start(now, 2, 0.0), Plan::Goal(3));
+
+  CHECK_FALSE(cache.find(key_0).has_value());
+
+  cache.insert(key_0, planner, 10.0);
+  cache.insert(key_1, planner, 20.0);
+  REQUIRE(cache.find(key_0).has_value());
+  CHECK(*cache.find(key_0) == Approx(10.0));
+
+  // key_1 is now the least recently used, so it gets evicted
+  cache.insert(key_2, planner, 30.0);
+  CHECK(cache.size() == 2);
+  CHECK_FALSE(cache.find(key_1).has_value());
+  CHECK(cache.find(key_0).has_value());
+  CHECK(cache.find(key_2).has_value());
+
+  // Start times do not matter, and small differences in orientation round to
+  // the same key
+  const auto later = now + std::chrono::seconds(30);
+  CHECK(cache.find(
+      PlanCache::make_key(
+        *planner, Plan::Start(later, 0, 0.001), Plan::Goal(3))).has_value());
+
+  // A different goal orientation is a different problem
+  CHECK_FALSE(cache.find(
+      PlanCache::make_key(
+        *planner, Plan::Start(now, 0, 0.0), Plan::Goal(3, M_PI))).has_value());
+
+  // A different planner, e.g. after a lane was closed, never shares entries
+  const auto other_planner = make_planner();
+  CHECK_FALSE(cache.find(
+      PlanCache::make_key(
+        *other_planner, Plan::Start(now, 0, 0.0), Plan::Goal(3))).has_value());
+
+  cache.forget(planner);
+  CHECK(cache.size() == 0);
+  CHECK_FALSE(cache.find(key_0).has_value());
+}
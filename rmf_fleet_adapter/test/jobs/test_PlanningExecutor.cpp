@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2022 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <jobs/PlanningExecutor.hpp>
+
+#include <rmf_utils/catch.hpp>
+
+#include <future>
+#include <string>
+
+//==============================================================================
+SCENARIO("Planning executor runs urgent jobs first and takes turns by owner")
+{
+  using namespace std::chrono_literals;
+  using Priority = rmf_fleet_adapter::jobs::PlanningExecutor::Priority;
+
+  rmf_fleet_adapter::jobs::PlanningExecutor executor(1);
+  CHECK(executor.thread_count() == 1);
+
+  // Keep the only thread busy until every job has been queued
+  std::promise<void> gate_started;
+  std::promise<void> gate;
+  std::shared_future<void> gate_future = gate.get_future().share();
+  executor.post(
+    Priority::replan, 0, [&gate_started, gate_future]()
+    {
+      gate_started.set_value();
+      gate_future.wait();
+    });
+
+  // Make sure the gate job has been taken off of the queue before anything
+  // else gets queued
+  REQUIRE(
+    gate_started.get_future().wait_for(5s) == std::future_status::ready);
+
+  std::mutex order_mutex;
+  std::vector<std::string> order;
+  const auto record = [&](std::string name)
+    {
+      return [&order_mutex, &order, name = std::move(name)]()
+        {
+          std::lock_guard<std::mutex> lock(order_mutex);
+          order.push_back(name);
+        };
+    };
+
+  std::promise<void> finished;
+  executor.post(Priority::bid_estimate, 1, record("bid_1"));
+  executor.post(Priority::replan, 1, record("replan_1a"));
+  executor.post(Priority::replan, 1, record("replan_1b"));
+  executor.post(Priority::replan, 2, record("replan_2"));
+  executor.post(Priority::negotiation, 3, record("negotiation_3"));
+  executor.post(
+    Priority::bid_estimate, 1, [&finished]() { finished.set_value(); });
+
+  const auto queued = executor.take_metrics();
+  CHECK(queued.queue_depth[0] == 1);
+  CHECK(queued.queue_depth[1] == 3);
+  CHECK(queued.queue_depth[2] == 2);
+
+  gate.set_value();
+  REQUIRE(finished.get_future().wait_for(5s) == std::future_status::ready);
+
+  const std::vector<std::string> expected = {
+    "negotiation_3",
+    "replan_1a",
+    "replan_2",
+    "replan_1b",
+    "bid_1"
+  };
+  CHECK(order == expected);
+
+  const auto metrics = executor.take_metrics();
+  CHECK(metrics.started[0] == 1);
+  CHECK(metrics.started[1] == 3);
+  CHECK(metrics.started[2] == 2);
+  CHECK(metrics.queue_depth[1] == 0);
+  CHECK(metrics.max_wait[1] >= metrics.mean_wait[1]);
+
+  // Adding threads lets jobs run at the same time
+  executor.set_thread_count(2);
+  CHECK(executor.thread_count() == 2);
+
+  std::promise<void> first_started;
+  std::promise<void> second_started;
+  std::shared_future<void> both = second_started.get_future().share();
+  executor.post(
+    Priority::replan, 1, [&first_started, both]()
+    {
+      first_started.set_value();
+      both.wait();
+    });
+  executor.post(
+    Priority::replan, 2, [&second_started]() { second_started.set_value(); });
+
+  CHECK(first_started.get_future().wait_for(5s) == std::future_status::ready);
+  CHECK(both.wait_for(5s) == std::future_status::ready);
+}
@@ -227,6 +227,101 @@ SCENARIO("Find a path")
     }
   }
 
+  WHEN("A robot replans partway along its previous path")
+  {
+    const auto start_0 = rmf_traffic::agv::Plan::Start(now, 0, M_PI/2.0);
+    const auto goal_0 = rmf_traffic::agv::Plan::Goal(10);
+
+    auto path_service = std::make_shared<rmf_fleet_adapter::services::FindPath>(
+      planner, rmf_traffic::agv::Plan::StartSet({start_0}),
+      goal_0, database->snapshot(), p0.id(),
+      std::make_shared<rmf_traffic::Profile>(p0.description().profile()),
+      std::nullopt);
+
+    std::promise<rmf_traffic::agv::Plan::Result> result_0_promise;
+    auto result_0_future = result_0_promise.get_future();
+    auto path_sub =
+      rmf_rxcpp::make_job<rmf_fleet_adapter::services::FindPath::Result>(
+      path_service)
+      .observe_on(rxcpp::observe_on_event_loop())
+      .subscribe(
+      [&result_0_promise](const auto& result)
+      {
+        result_0_promise.set_value(result);
+      });
+
+    REQUIRE(std::future_status::ready == result_0_future.wait_for(1s));
+    REQUIRE(result_0_future.get().success());
+
+    CHECK_FALSE(path_service->search()->reuse().previous_greedy_plan);
+    const auto previous = path_service->search()->greedy_reference();
+    REQUIRE(previous);
+
+    // The robot has made it to waypoint 5 when it needs to replan
+    const auto start_5 =
+      rmf_traffic::agv::Plan::Start(now + 10s, 5, M_PI/2.0);
+    path_service = std::make_shared<rmf_fleet_adapter::services::FindPath>(
+      planner, rmf_traffic::agv::Plan::StartSet({start_5}),
+      goal_0, database->snapshot(), p0.id(),
+      std::make_shared<rmf_traffic::Profile>(p0.description().profile()),
+      std::nullopt, previous);
+
+    std::promise<rmf_traffic::agv::Plan::Result> result_5_promise;
+    auto result_5_future = result_5_promise.get_future();
+    path_sub =
+      rmf_rxcpp::make_job<rmf_fleet_adapter::services::FindPath::Result>(
+      path_service)
+      .observe_on(rxcpp::observe_on_event_loop())
+      .subscribe(
+      [&result_5_promise](const auto& result)
+      {
+        result_5_promise.set_value(result);
+      });
+
+    REQUIRE(std::future_status::ready == result_5_future.wait_for(1s));
+    CHECK(result_5_future.get().success());
+
+    const auto reuse = path_service->search()->reuse();
+    CHECK(reuse.previous_greedy_plan);
+    CHECK(0.0 < reuse.reused_fraction);
+    CHECK(reuse.reused_fraction < 1.0);
+    CHECK(reuse.greedy_skipped);
+
+    // The greedy search was skipped, so the original greedy plan should be
+    // carried forward for the next replan.
+    const auto carried = path_service->search()->greedy_reference();
+    CHECK(carried == previous);
+
+    // The robot has made it to waypoint 8 when it needs to replan again
+    const auto start_8 =
+      rmf_traffic::agv::Plan::Start(now + 20s, 8, M_PI/2.0);
+    path_service = std::make_shared<rmf_fleet_adapter::services::FindPath>(
+      planner, rmf_traffic::agv::Plan::StartSet({start_8}),
+      goal_0, database->snapshot(), p0.id(),
+      std::make_shared<rmf_traffic::Profile>(p0.description().profile()),
+      std::nullopt, carried);
+
+    std::promise<rmf_traffic::agv::Plan::Result> result_8_promise;
+    auto result_8_future = result_8_promise.get_future();
+    path_sub =
+      rmf_rxcpp::make_job<rmf_fleet_adapter::services::FindPath::Result>(
+      path_service)
+      .observe_on(rxcpp::observe_on_event_loop())
+      .subscribe(
+      [&result_8_promise](const auto& result)
+      {
+        result_8_promise.set_value(result);
+      });
+
+    REQUIRE(std::future_status::ready == result_8_future.wait_for(1s));
+    CHECK(result_8_future.get().success());
+
+    const auto chained_reuse = path_service->search()->reuse();
+    CHECK(chained_reuse.previous_greedy_plan);
+    CHECK(chained_reuse.reused_fraction < reuse.reused_fraction);
+    CHECK(chained_reuse.greedy_skipped);
+  }
+
   WHEN("A robot is perpetually blocking the path of another")
   {
     const auto l0 = graph.get_waypoint(5).get_location();
@@ -373,6 +373,9 @@ public:
       .subscribe([w = weak_from_this()](const auto& result)
         {
           result.respond();
+          if (result.provisional)
+            return;
+
           if (const auto self = w.lock())
             self->_services.erase(result.service);
         });
@@ -508,6 +511,9 @@ public:
       .subscribe([w = weak_from_this()](const auto& result)
         {
           result.respond();
+          if (result.provisional)
+            return;
+
           if (const auto self = w.lock())
             self->_services.erase(result.service);
         });
@@ -2607,3 +2613,306 @@ SCENARIO("fan-in-fan-out bottleneck", "[.high_cpu]")
   }
 }
 
+
+namespace {
+//==============================================================================
+/// A responder that records when the negotiation service first answered a
+/// table and how many proposals it submitted to it.
+class TimedResponder : public rmf_traffic::schedule::Negotiator::Responder
+{
+public:
+
+  using Clock = std::chrono::steady_clock;
+
+  TimedResponder(rmf_traffic::schedule::Negotiation::TablePtr table)
+  : _table(std::move(table))
+  {
+    // Do nothing
+  }
+
+  void submit(
+    rmf_traffic::PlanId plan,
+    std::vector<rmf_traffic::Route> itinerary,
+    ApprovalCallback approval_callback = nullptr) const final
+  {
+    rmf_traffic::schedule::SimpleResponder(_table)
+    .submit(plan, std::move(itinerary), std::move(approval_callback));
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    ++_submissions;
+    _record();
+  }
+
+  void reject(const Alternatives& alternatives) const final
+  {
+    rmf_traffic::schedule::SimpleResponder(_table).reject(alternatives);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    _record();
+  }
+
+  void forfeit(
+    const std::vector<rmf_traffic::schedule::ParticipantId>& blockers)
+  const final
+  {
+    rmf_traffic::schedule::SimpleResponder(_table).forfeit(blockers);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    _record();
+  }
+
+  rmf_utils::optional<Clock::time_point> first_response() const
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _first_response;
+  }
+
+  std::size_t submissions() const
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _submissions;
+  }
+
+private:
+
+  void _record() const
+  {
+    if (!_first_response)
+      _first_response = Clock::now();
+  }
+
+  rmf_traffic::schedule::Negotiation::TablePtr _table;
+  mutable std::mutex _mutex;
+  mutable rmf_utils::optional<Clock::time_point> _first_response;
+  mutable std::size_t _submissions = 0;
+};
+} // anonymous namespace
+
+//==============================================================================
+SCENARIO("Time to first proposal for an anytime negotiation", "[.high_cpu]")
+{
+  rmf_fleet_adapter_test::thread_cooldown = true;
+
+  using namespace std::chrono_literals;
+  using Clock = TimedResponder::Clock;
+
+  auto database = std::make_shared<rmf_traffic::schedule::Database>();
+
+  rmf_traffic::Profile profile{
+    rmf_traffic::geometry::make_final_convex<
+      rmf_traffic::geometry::Circle>(1.0)
+  };
+
+  const auto make_participant = [&](
+    const std::string& name,
+    const rmf_traffic::schedule::ParticipantDescription::Rx rx)
+    {
+      return rmf_traffic::schedule::make_participant(
+        rmf_traffic::schedule::ParticipantDescription{
+          name, "test_Negotiator", rx, profile
+        },
+        database);
+    };
+
+  using Rx = rmf_traffic::schedule::ParticipantDescription::Rx;
+  auto p0 = make_participant("negotiator", Rx::Responsive);
+  auto p1 = make_participant("other negotiator", Rx::Responsive);
+  auto crossing_x = make_participant("crossing x", Rx::Unresponsive);
+  auto crossing_y = make_participant("crossing y", Rx::Unresponsive);
+
+  const std::string test_map_name = "test_map";
+  rmf_traffic::agv::Graph graph;
+  graph.add_waypoint(test_map_name, {0.0, -10.0}); // 0
+  graph.add_waypoint(test_map_name, {0.0, -5.0});  // 1
+  graph.add_waypoint(test_map_name, {5.0, -5.0});  // 2
+  graph.add_waypoint(test_map_name, {-10.0, 0.0}); // 3
+  graph.add_waypoint(test_map_name, {-5.0, 0.0}); // 4
+  graph.add_waypoint(test_map_name, {0.0, 0.0}); // 5
+  graph.add_waypoint(test_map_name, {5.0, 0.0}); // 6
+  graph.add_waypoint(test_map_name, {10.0, 0.0}); // 7
+  graph.add_waypoint(test_map_name, {0.0, 5.0}); // 8
+  graph.add_waypoint(test_map_name, {5.0, 5.0}); // 9
+  graph.add_waypoint(test_map_name, {0.0, 10.0}); // 10
+
+  /*
+   *                  10
+   *                   |
+   *                   |
+   *                   8------9
+   *                   |      |
+   *                   |      |
+   *     3------4------5------6------7
+   *                   |      |
+   *                   |      |
+   *                   1------2
+   *                   |
+   *                   |
+   *                   0
+   **/
+
+  for (const std::size_t wp : {0, 2, 3, 7, 9, 10})
+    graph.get_waypoint(wp).set_parking_spot(true);
+
+  auto add_bidir_lane = [&](const std::size_t w0, const std::size_t w1)
+    {
+      graph.add_lane(w0, w1);
+      graph.add_lane(w1, w0);
+    };
+
+  add_bidir_lane(0, 1);
+  add_bidir_lane(1, 2);
+  add_bidir_lane(1, 5);
+  add_bidir_lane(2, 6);
+  add_bidir_lane(3, 4);
+  add_bidir_lane(4, 5);
+  add_bidir_lane(5, 6);
+  add_bidir_lane(6, 7);
+  add_bidir_lane(5, 8);
+  add_bidir_lane(6, 9);
+  add_bidir_lane(8, 9);
+  add_bidir_lane(8, 10);
+
+  const rmf_traffic::agv::VehicleTraits traits{
+    {0.7, 0.3},
+    {1.0, 0.45},
+    profile
+  };
+
+  rmf_traffic::agv::Planner::Configuration configuration{graph, traits};
+  const auto planner = std::make_shared<rmf_traffic::agv::Planner>(
+    configuration,
+    rmf_traffic::agv::Planner::Options{nullptr, 1s});
+
+  // Congest the junctions with traffic that will not negotiate
+  const auto now = std::chrono::steady_clock::now();
+  const auto plan_x = planner->plan(
+    rmf_traffic::agv::Plan::Start(now, 7, M_PI),
+    rmf_traffic::agv::Plan::Goal(3));
+  REQUIRE(plan_x);
+  crossing_x.set(crossing_x.assign_plan_id(), plan_x->get_itinerary());
+
+  const auto plan_y = planner->plan(
+    rmf_traffic::agv::Plan::Start(now, 0, M_PI/2.0),
+    rmf_traffic::agv::Plan::Goal(10));
+  REQUIRE(plan_y);
+  crossing_y.set(crossing_y.assign_plan_id(), plan_y->get_itinerary());
+
+  const auto worker = rxcpp::schedulers::make_event_loop().create_worker();
+
+  struct Timing
+  {
+    Clock::duration first_proposal;
+    Clock::duration finished;
+    std::size_t submissions;
+  };
+
+  const auto run = [&](const bool anytime) -> Timing
+    {
+      const auto negotiation = rmf_traffic::schedule::Negotiation::make_shared(
+        database->snapshot(), {p0.id(), p1.id()});
+      REQUIRE(negotiation);
+
+      const auto table = negotiation->table(p0.id(), {});
+      REQUIRE(table);
+
+      const auto responder = std::make_shared<TimedResponder>(table);
+      const auto negotiate =
+        rmf_fleet_adapter::services::Negotiate::emergency_pullover(
+        0, planner, {rmf_traffic::agv::Plan::Start(now, 4, 0.0)},
+        table->viewer(), responder, nullptr,
+        rmf_fleet_adapter::services::ProgressEvaluator());
+
+      if (anytime)
+        negotiate->anytime();
+
+      std::promise<Clock::time_point> finished_promise;
+      auto finished_future = finished_promise.get_future();
+
+      const auto begin = Clock::now();
+      auto sub = rmf_rxcpp::make_job<
+        rmf_fleet_adapter::services::Negotiate::Result>(negotiate)
+        .observe_on(rxcpp::identity_same_worker(worker))
+        .subscribe([&finished_promise](const auto& result)
+          {
+            result.respond();
+            if (!result.provisional)
+              finished_promise.set_value(Clock::now());
+          });
+
+      REQUIRE(finished_future.wait_for(2min) == std::future_status::ready);
+      const auto finished = finished_future.get();
+
+      const auto first = responder->first_response();
+      REQUIRE(first);
+      CHECK(table->submission());
+
+      return Timing{
+        *first - begin,
+        finished - begin,
+        responder->submissions()
+      };
+    };
+
+  const auto to_ms = [](const Clock::duration d)
+    {
+      return std::chrono::duration<double, std::milli>(d).count();
+    };
+
+  const auto standard = run(false);
+  CHECK(standard.submissions == 1);
+
+  const auto anytime = run(true);
+  CHECK(anytime.submissions >= 1);
+
+  // The anytime service should never answer later than it finishes searching
+  CHECK(anytime.first_proposal <= anytime.finished);
+
+  std::cout << "Time to first proposal [ms]"
+            << "\n  Standard: " << to_ms(standard.first_proposal)
+            << "\n  Anytime:  " << to_ms(anytime.first_proposal)
+            << " (search finished after " << to_ms(anytime.finished)
+            << ", " << anytime.submissions << " submission(s))" << std::endl;
+}
+
+//==============================================================================
+SCENARIO("Anytime negotiations only revise for a large enough improvement")
+{
+  using Negotiate = rmf_fleet_adapter::services::Negotiate;
+
+  WHEN("Nothing has been submitted yet")
+  {
+    CHECK(Negotiate::worth_submitting(100.0, rmf_utils::nullopt, 0.1));
+    CHECK(
+      Negotiate::worth_submitting(
+        100.0, rmf_utils::nullopt, rmf_utils::nullopt));
+  }
+
+  WHEN("A proposal has been submitted")
+  {
+    const double submitted = 100.0;
+    CHECK_FALSE(Negotiate::worth_submitting(100.0, submitted, 0.1));
+    CHECK_FALSE(Negotiate::worth_submitting(95.0, submitted, 0.1));
+    CHECK(Negotiate::worth_submitting(89.0, submitted, 0.1));
+
+    // A larger threshold needs a larger improvement
+    CHECK_FALSE(Negotiate::worth_submitting(60.0, submitted, 0.5));
+    CHECK(Negotiate::worth_submitting(49.0, submitted, 0.5));
+
+    // Without a threshold, any improvement is worth submitting
+    CHECK(Negotiate::worth_submitting(99.0, submitted, rmf_utils::nullopt));
+    CHECK_FALSE(
+      Negotiate::worth_submitting(100.0, submitted, rmf_utils::nullopt));
+  }
+
+  WHEN("The default threshold is used")
+  {
+    const double submitted = 100.0;
+    const double threshold = Negotiate::DefaultAnytimeImprovement;
+    CHECK_FALSE(
+      Negotiate::worth_submitting(
+        (1.0 - threshold) * submitted, submitted, threshold));
+    CHECK(
+      Negotiate::worth_submitting(
+        (1.0 - threshold) * submitted - 1.0, submitted, threshold));
+  }
+}
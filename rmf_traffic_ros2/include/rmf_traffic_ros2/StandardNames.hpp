@@ -60,6 +60,8 @@ const std::string NegotiationConclusionTopicName = Prefix +
   "negotiation_conclusion";
 const std::string NegotiationStatesTopicName = Prefix +
   "negotiation_states";
+const std::string NegotiationStateUpdatesTopicName = Prefix +
+  "negotiation_state_updates";
 const std::string NegotiationStatusesTopicName = Prefix +
   "negotiation_statuses";
 
@@ -75,6 +77,8 @@ const std::string BlockadeReleaseTopicName = Prefix +
   "blockade_release";
 const std::string BlockadeSetTopicName = Prefix +
   "blockade_set";
+const std::string BlockadeStatusUpdatesTopicName = Prefix +
+  "blockade_status_updates";
 
 const std::string EmergencyTopicName = "fire_alarm_trigger";
 
@@ -20,6 +20,7 @@
 
 #include <rmf_traffic/schedule/Database.hpp>
 #include <rmf_traffic/schedule/Mirror.hpp>
+#include <rmf_traffic/schedule/Snapshot.hpp>
 
 #include <rclcpp/node.hpp>
 
@@ -45,9 +46,19 @@ public:
     /// \brief update_on_wakeup
     ///   Specify if the mirror should perform an update whenever it gets woken
     ///   up by the schedule.
+    ///
+    /// \brief decode_thread
+    ///   Specify if incoming patches should be converted and applied on a
+    ///   dedicated thread instead of the thread that is spinning the node.
+    ///
+    /// \brief publish_snapshots
+    ///   Specify if a new snapshot should be published each time the mirror
+    ///   changes, so that snapshots() can be read without any locking.
     Options(
       std::mutex* update_mutex = nullptr,
-      bool update_on_wakeup = true);
+      bool update_on_wakeup = true,
+      bool decode_thread = false,
+      bool publish_snapshots = false);
 
     /// Get a reference to the mutex that will be used when performing an
     /// update.
@@ -64,6 +75,22 @@ public:
     /// Toggle the choice to wakeup on an update.
     Options& update_on_wakeup(bool choice);
 
+    /// True if incoming patches are converted and applied on a dedicated
+    /// thread. The update_mutex will still be locked while the patch is
+    /// applied to the mirror. Once the thread has been started, it will keep
+    /// being used so that patches are always applied in order.
+    bool decode_thread() const;
+
+    /// Toggle the choice to use a dedicated thread for incoming patches.
+    Options& decode_thread(bool choice);
+
+    /// True if a new snapshot of the mirror is published each time the mirror
+    /// changes.
+    bool publish_snapshots() const;
+
+    /// Toggle the choice to publish snapshots of the mirror.
+    Options& publish_snapshots(bool choice);
+
     class Implementation;
   private:
     rmf_utils::impl_ptr<Implementation> _pimpl;
@@ -72,6 +99,17 @@ public:
   /// Get an immutable view of the mirror
   std::shared_ptr<const rmf_traffic::schedule::Mirror> view() const;
 
+  /// Get a snappable view of the mirror.
+  ///
+  /// If Options::publish_snapshots() is turned on, the snapshot() function of
+  /// this view returns the latest snapshot that was published after the
+  /// mirror was updated. This can be called from any thread without locking
+  /// the update_mutex, and it will never be blocked by incoming updates.
+  ///
+  /// Otherwise it takes a new snapshot from the mirror, which has the same
+  /// thread safety requirements as view().
+  std::shared_ptr<const rmf_traffic::schedule::Snappable> snapshots() const;
+
   /// Attempt to update this mirror immediately.
   ///
   // TODO(MXG): Consider allowing this function to accept a callback that will
@@ -26,6 +26,8 @@
 
 #include <rmf_utils/impl_ptr.hpp>
 
+#include <unordered_map>
+
 namespace rmf_traffic_ros2 {
 namespace schedule {
 
@@ -68,6 +70,36 @@ public:
   /// Get the current timeout duration setting.
   rmf_traffic::Duration timeout_duration() const;
 
+  /// Set the number of threads that will be used to respond to negotiation
+  /// tables. When this is more than 1 and no Worker was given to the
+  /// constructor, the tables that are waiting on the negotiators of this
+  /// Negotiation manager will be answered concurrently by a pool of threads,
+  /// whether they are sibling tables within one negotiation or tables of
+  /// different negotiations.
+  ///
+  /// The proposals, rejections, and forfeits will still be published from the
+  /// thread that is spinning the node, in the order that the tables were
+  /// queued, so the messages that go out do not depend on how the work was
+  /// scheduled.
+  ///
+  /// \warning The negotiators must be able to handle concurrent calls to
+  /// respond() for different tables, and they must give their response before
+  /// respond() returns. Any table whose negotiator has not responded by the
+  /// time respond() returns will be forfeited, so negotiators that plan in the
+  /// background and respond later should not be used with a responder pool.
+  ///
+  /// \note The responder pool is only used when no Worker was given to the
+  /// constructor. With a Worker, the negotiators are already free to respond
+  /// asynchronously, so this setting has no effect and a warning is logged.
+  /// This is the case for the fleet adapters, whose negotiators plan in the
+  /// background.
+  ///
+  /// The default is 1, which means every table is answered one after another.
+  Negotiation& responder_threads(std::size_t count);
+
+  /// Get the current number of responder threads.
+  std::size_t responder_threads() const;
+
   using TableViewPtr = rmf_traffic::schedule::Negotiation::Table::ViewerPtr;
   using ResponderPtr = rmf_traffic::schedule::Negotiator::ResponderPtr;
   using StatusUpdateCallback =
@@ -93,7 +125,8 @@ public:
   /// Get a Negotiation::TableView that provides a view into what participants are
   /// proposing.
   ///
-  /// This function does not care about table versioning.
+  /// This function does not care about table versioning. Tables of concluded
+  /// negotiations are only available when debug_history() is turned on.
   /// \param[in] conflict_version
   ///   The conflict version of the negotiation
   /// \param[in] sequence
@@ -105,12 +138,60 @@ public:
     uint64_t conflict_version,
     const std::vector<rmf_traffic::schedule::ParticipantId>& sequence) const;
 
-  /// Set the number of negotiations to retain.
+  /// A compact record of a negotiation that has concluded.
+  struct Summary
+  {
+    /// The conflict version of the negotiation
+    uint64_t conflict_version;
+
+    /// True if the negotiation was resolved, false if it failed
+    bool resolved;
+
+    /// The participants that were in the negotiation
+    std::vector<rmf_traffic::schedule::ParticipantId> participants;
+
+    /// The sequence of the table that won the negotiation, including the
+    /// version of each proposal. This is empty if the negotiation failed.
+    rmf_traffic::schedule::Negotiation::VersionedKeySequence resolution;
+
+    /// The itinerary versions that the negotiators of this Negotiation manager
+    /// committed to when they approved the resolution.
+    std::unordered_map<
+      rmf_traffic::schedule::ParticipantId,
+      rmf_traffic::schedule::ItineraryVersion> itinerary_versions;
+
+    /// When this Negotiation manager was first told about the negotiation
+    rmf_traffic::Time started;
+
+    /// When this Negotiation manager was told about the conclusion
+    rmf_traffic::Time concluded;
+  };
+
+  /// Set the number of concluded negotiations to retain. Each concluded
+  /// negotiation is kept as a Summary. When debug_history() is turned on, the
+  /// full table tree of each concluded negotiation is also retained so that it
+  /// can be inspected with table_view().
   ///
   /// \param[in] count
   ///   The number of negotiations to retain
   void set_retained_history_count(uint count);
 
+  /// Toggle whether the full table trees of concluded negotiations should be
+  /// retained. This is off by default because the trees can take up a lot of
+  /// memory on a busy site.
+  Negotiation& debug_history(bool choice);
+
+  /// Check whether the full table trees of concluded negotiations are being
+  /// retained.
+  bool debug_history() const;
+
+  /// Get the summaries of the most recently concluded negotiations, ordered
+  /// from oldest to newest.
+  ///
+  /// The history is not guarded by a mutex, so this must be called from the
+  /// thread that spins the node of this Negotiation manager.
+  std::vector<Summary> history() const;
+
   /// Register a negotiator with this Negotiation manager.
   ///
   /// \param[in] for_participant
@@ -25,6 +25,7 @@
 #include <string>
 #include <yaml-cpp/yaml.h>
 #include <unordered_map>
+#include <optional>
 
 namespace rmf_traffic_ros2 {
 namespace schedule {
@@ -91,6 +92,52 @@ private:
   rmf_utils::unique_impl_ptr<Implementation> _pimpl;
 };
 
+//=============================================================================
+/// Binary logger class. Appends each operation to a length-prefixed,
+/// checksummed binary journal on disk.
+///
+/// Unlike YamlLogger, writing an operation only appends one record to the end
+/// of the file instead of rewriting the whole file. Records that have been
+/// superseded by later updates are removed by periodically compacting the
+/// journal.
+class BinaryLogger : public AbstractParticipantLogger
+{
+public:
+  /// Constructor
+  /// Loads and logs to the specified file.
+  ///
+  /// \param[in] file_path
+  ///   The file to load from and log to. It will be created if it does not
+  ///   exist yet.
+  ///
+  /// \param[in] compaction_threshold
+  ///   The journal will be compacted whenever it contains more than this many
+  ///   superseded records.
+  ///
+  /// \throws std::runtime_error if the file is not a participant journal, or
+  /// if one of its records fails its checksum. A record that was only
+  /// partially written at the end of the file, e.g. because of a crash, will
+  /// be discarded instead.
+  ///
+  /// \throws std::filesystem_error if there is no permission to create the
+  /// directory.
+  BinaryLogger(std::string file_path, std::size_t compaction_threshold = 1000);
+
+  /// See AbstractParticipantLogger
+  void write_operation(AtomicOperation operation) override;
+
+  /// See AbstractParticipantLogger
+  std::optional<AtomicOperation> read_next_record() override;
+
+  /// Rewrite the journal so that it only contains the latest description of
+  /// each participant, in the order that the participants were added.
+  void compact();
+
+  class Implementation;
+private:
+  rmf_utils::unique_impl_ptr<Implementation> _pimpl;
+};
+
 //=============================================================================
 /// Adds a persistance layer to the participant ids. This allows the scheduler
 /// to restart without the need to restart fleet adapters.
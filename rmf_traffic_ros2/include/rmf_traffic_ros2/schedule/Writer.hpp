@@ -23,6 +23,10 @@
 
 #include <rclcpp/node.hpp>
 
+#include <functional>
+#include <future>
+#include <optional>
+
 namespace rmf_traffic_ros2 {
 namespace schedule {
 
@@ -62,7 +66,9 @@ public:
   /// Begin creation of a schedule participant.
   ///
   /// The node of this Writer needs to be spun in order for the Participant to
-  /// finish being created.
+  /// finish being created. If the registration fails, or the rclcpp context
+  /// shuts down before the participant has been registered, the future will
+  /// hold an exception.
   ///
   /// \param[in] description.
   ///   The description of the participant.
@@ -72,7 +78,8 @@ public:
   /// Asynchronously create a schedule participant.
   ///
   /// When the Participant is ready to be used, the ready_callback will be
-  /// triggered with the newly created Participant instance.
+  /// triggered with the newly created Participant instance. The callback is
+  /// triggered through the completion executor of this writer.
   ///
   /// \param[in] description
   ///   The description of the participant.
@@ -83,6 +90,37 @@ public:
     rmf_traffic::schedule::ParticipantDescription description,
     std::function<void(rmf_traffic::schedule::Participant)> ready_callback);
 
+  /// A function that runs a piece of work, e.g. by posting it to a worker
+  /// thread or an event loop.
+  using CompletionExecutor = std::function<void(std::function<void()> work)>;
+
+  /// Choose where participants finish being created once their registration
+  /// arrives from the schedule node. This is where the ready_callback of
+  /// async_make_participant(~) gets triggered and where the futures of
+  /// make_participant(~) get their values.
+  ///
+  /// Registration requests from this writer are all sent through one service
+  /// client, with a limited number of them waiting for a response at a time,
+  /// so no threads are blocked while participants are being registered.
+  ///
+  /// \param[in] executor
+  ///   The executor to use. Pass in a nullptr (the default) to finish creating
+  ///   participants on the thread that spins the node of this writer, right
+  ///   after their registration arrives.
+  void set_completion_executor(CompletionExecutor executor);
+
+  /// Opt in to publishing the itinerary changes of every participant created
+  /// by this writer in batches. Changes will be collected for the given period
+  /// and then published together, in the same order they were made, so that
+  /// a schedule node with itinerary batching enabled can apply them under a
+  /// single lock of its database.
+  ///
+  /// \param[in] period
+  ///   How long to collect changes for before publishing them. Pass in a
+  ///   std::nullopt (the default) to publish each change immediately. Any
+  ///   changes that are waiting will be published right away.
+  void set_itinerary_batching(std::optional<rmf_traffic::Duration> period);
+
   class Implementation;
 private:
   Writer();
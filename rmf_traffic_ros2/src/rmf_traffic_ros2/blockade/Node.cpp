@@ -28,6 +28,14 @@
 #include <rmf_traffic_msgs/msg/blockade_set.hpp>
 #include <rmf_traffic_msgs/msg/blockade_status.hpp>
 
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+
 namespace rmf_traffic_ros2 {
 namespace blockade {
 
@@ -38,13 +46,69 @@ public:
 
   using Checkpoint = rmf_traffic::blockade::Writer::Checkpoint;
   using Reservation = rmf_traffic::blockade::Writer::Reservation;
+  using Moderator = rmf_traffic::blockade::Moderator;
+  using StatusMsg = rmf_traffic_msgs::msg::BlockadeStatus;
+
+  // Each shard moderates the participants of a group of maps that nobody can
+  // travel between, so it never has to know about the other shards. When
+  // there is more than one shard, each of them works through its updates on
+  // its own thread, including the gridlock detection of its moderator.
+  struct Shard
+  {
+    std::shared_ptr<Moderator> moderator = std::make_shared<Moderator>();
+
+    // Guards the moderator and the status tracking
+    std::mutex mutex;
+    std::size_t last_assignment_version = 0;
+    std::unordered_map<std::size_t, StatusMsg> last_published = {};
+    std::atomic_bool has_gridlock = false;
+
+    std::mutex jobs_mutex;
+    std::condition_variable jobs_cv;
+    std::deque<std::function<void()>> jobs = {};
+    bool quit = false;
+    std::thread thread = {};
+  };
 
   BlockadeNode(
     const std::string& node_name,
     const rclcpp::NodeOptions& options)
-  : rclcpp::Node(node_name, options),
-    moderator(std::make_shared<rmf_traffic::blockade::Moderator>())
+  : rclcpp::Node(node_name, options)
   {
+    // Each entry is a comma-separated list of maps that should be moderated
+    // together. Maps that robots can travel between (e.g. with a lift) must
+    // be listed in the same entry. Any map that is not listed is moderated by
+    // a default shard.
+    const auto shard_maps = declare_parameter<std::vector<std::string>>(
+      "shard_maps", std::vector<std::string>());
+
+    shards.push_back(std::make_unique<Shard>());
+    for (const auto& entry : shard_maps)
+    {
+      std::stringstream maps(entry);
+      std::string map;
+      while (std::getline(maps, map, ','))
+      {
+        map.erase(0, map.find_first_not_of(" "));
+        map.erase(map.find_last_not_of(" ") + 1);
+        if (!map.empty())
+          map_shard[map] = shards.size();
+      }
+
+      shards.push_back(std::make_unique<Shard>());
+    }
+
+    if (shards.size() > 1)
+    {
+      for (auto& shard : shards)
+        shard->thread = std::thread([this, s = shard.get()]() { work(*s); });
+
+      RCLCPP_INFO(
+        get_logger(),
+        "Moderating blockades with %lu shards",
+        shards.size());
+    }
+
     blockade_set_sub =
       create_subscription<SetMsg>(
       BlockadeSetTopicName,
@@ -94,6 +158,10 @@ public:
       BlockadeHeartbeatTopicName,
       rclcpp::SystemDefaultsQoS().keep_last(10).reliable());
 
+    status_updates_pub = create_publisher<HeartbeatMsg>(
+      BlockadeStatusUpdatesTopicName,
+      rclcpp::SystemDefaultsQoS().keep_last(100).reliable());
+
     heartbeat_timer = create_wall_timer(
       std::chrono::seconds(1),
       [this]()
@@ -102,6 +170,24 @@ public:
       });
   }
 
+  ~BlockadeNode()
+  {
+    for (auto& shard : shards)
+    {
+      {
+        std::lock_guard<std::mutex> lock(shard->jobs_mutex);
+        shard->quit = true;
+      }
+      shard->jobs_cv.notify_all();
+    }
+
+    for (auto& shard : shards)
+    {
+      if (shard->thread.joinable())
+        shard->thread.join();
+    }
+  }
+
   using SetMsg = rmf_traffic_msgs::msg::BlockadeSet;
   rclcpp::Subscription<SetMsg>::SharedPtr blockade_set_sub;
   void blockade_set(const SetMsg& set)
@@ -117,113 +203,220 @@ public:
         });
     }
 
-    try
+    const std::size_t shard = shard_for(set);
+    const auto p_it = participant_shard.find(set.participant);
+    if (p_it != participant_shard.end() && p_it->second != shard)
     {
-      moderator->set(
-        set.participant, set.reservation,
-        Reservation{std::move(path), set.radius});
-    }
-    catch (const std::exception& e)
-    {
-      RCLCPP_ERROR(
-        get_logger(), "Exception due to [set] update: %s", e.what());
+      // The participant is moving to maps that belong to a different shard, so
+      // the old shard should forget about it.
+      post(
+        p_it->second, "set",
+        [participant = set.participant](Moderator& moderator)
+        {
+          moderator.cancel(participant);
+        });
     }
 
-    check_for_updates();
+    participant_shard[set.participant] = shard;
+    post(
+      shard, "set",
+      [set, path = std::move(path)](Moderator& moderator)
+      {
+        moderator.set(
+          set.participant, set.reservation,
+          Reservation{std::move(path), set.radius});
+      });
   }
 
   using ReadyMsg = rmf_traffic_msgs::msg::BlockadeReady;
   rclcpp::Subscription<ReadyMsg>::SharedPtr blockade_ready_sub;
   void blockade_ready(const ReadyMsg& ready)
   {
-    try
-    {
-      moderator->ready(ready.participant, ready.reservation, ready.checkpoint);
-    }
-    catch (const std::exception& e)
-    {
-      RCLCPP_ERROR(
-        get_logger(), "Exception due to [ready] update: %s", e.what());
-    }
-
-    check_for_updates();
+    post(
+      shard_of(ready.participant), "ready",
+      [ready](Moderator& moderator)
+      {
+        moderator.ready(ready.participant, ready.reservation, ready.checkpoint);
+      });
   }
 
   using ReleaseMsg = rmf_traffic_msgs::msg::BlockadeRelease;
   rclcpp::Subscription<ReleaseMsg>::SharedPtr blockade_release_sub;
   void blockade_release(const ReleaseMsg& release)
   {
-    try
-    {
-      moderator->release(
-        release.participant, release.reservation, release.checkpoint);
-    }
-    catch (const std::exception& e)
-    {
-      RCLCPP_ERROR(
-        get_logger(), "Exception due to [release] update: %s", e.what());
-    }
-
-    check_for_updates();
+    post(
+      shard_of(release.participant), "release",
+      [release](Moderator& moderator)
+      {
+        moderator.release(
+          release.participant, release.reservation, release.checkpoint);
+      });
   }
 
   using ReachedMsg = rmf_traffic_msgs::msg::BlockadeReached;
   rclcpp::Subscription<ReachedMsg>::SharedPtr blockade_reached_sub;
   void blockade_reached(const ReachedMsg& reached)
   {
-    try
+    post(
+      shard_of(reached.participant), "reached",
+      [reached](Moderator& moderator)
+      {
+        moderator.reached(
+          reached.participant, reached.reservation, reached.checkpoint);
+      });
+  }
+
+  using CancelMsg = rmf_traffic_msgs::msg::BlockadeCancel;
+  rclcpp::Subscription<CancelMsg>::SharedPtr blockade_cancel_sub;
+  void blockade_cancel(const CancelMsg& cancel)
+  {
+    const std::size_t shard = shard_of(cancel.participant);
+    if (cancel.all_reservations)
+      participant_shard.erase(cancel.participant);
+
+    post(
+      shard, "cancel",
+      [cancel](Moderator& moderator)
+      {
+        if (cancel.all_reservations)
+          moderator.cancel(cancel.participant);
+        else
+          moderator.cancel(cancel.participant, cancel.reservation);
+      });
+  }
+
+  // Decide which shard should moderate a reservation based on its maps
+  std::size_t shard_for(const SetMsg& set)
+  {
+    if (shards.size() == 1 || set.path.empty())
+      return 0;
+
+    const auto shard_of_map = [&](const std::string& map) -> std::size_t
+      {
+        const auto it = map_shard.find(map);
+        return it == map_shard.end() ? 0 : it->second;
+      };
+
+    const std::size_t shard = shard_of_map(set.path.front().map_name);
+    for (const auto& c : set.path)
     {
-      moderator->reached(
-        reached.participant, reached.reservation, reached.checkpoint);
+      if (shard_of_map(c.map_name) != shard)
+      {
+        RCLCPP_ERROR(
+          get_logger(),
+          "Reservation [%lu] of participant [%lu] travels between map [%s] "
+          "and map [%s], but those maps belong to different shards. The maps "
+          "should be listed together in the shard_maps parameter. Conflicts "
+          "on map [%s] may be missed.",
+          set.reservation, set.participant,
+          set.path.front().map_name.c_str(), c.map_name.c_str(),
+          c.map_name.c_str());
+        break;
+      }
     }
-    catch (const std::exception& e)
+
+    return shard;
+  }
+
+  std::size_t shard_of(const std::size_t participant) const
+  {
+    const auto it = participant_shard.find(participant);
+    return it == participant_shard.end() ? 0 : it->second;
+  }
+
+  // Apply an update to the moderator of a shard. With a single shard this
+  // happens right away, otherwise it is handed to the thread of the shard.
+  void post(
+    const std::size_t index,
+    const char* update_name,
+    std::function<void(Moderator&)> update)
+  {
+    Shard& shard = *shards.at(index);
+    if (shards.size() == 1)
     {
-      RCLCPP_ERROR(
-        get_logger(), "Exception due to [reached] update: %s", e.what());
+      apply(shard, update_name, update);
+      return;
     }
 
-    check_for_updates();
+    {
+      std::lock_guard<std::mutex> lock(shard.jobs_mutex);
+      shard.jobs.emplace_back(
+        [this, &shard, update_name, update = std::move(update)]()
+        {
+          apply(shard, update_name, update);
+        });
+    }
+    shard.jobs_cv.notify_one();
   }
 
-  using CancelMsg = rmf_traffic_msgs::msg::BlockadeCancel;
-  rclcpp::Subscription<CancelMsg>::SharedPtr blockade_cancel_sub;
-  void blockade_cancel(const CancelMsg& cancel)
+  void work(Shard& shard)
   {
-    try
+    while (true)
     {
-      if (cancel.all_reservations)
-        moderator->cancel(cancel.participant);
-      else
-        moderator->cancel(cancel.participant, cancel.reservation);
+      std::function<void()> job;
+      {
+        std::unique_lock<std::mutex> lock(shard.jobs_mutex);
+        shard.jobs_cv.wait(
+          lock, [&]() { return shard.quit || !shard.jobs.empty(); });
+
+        if (shard.quit)
+          return;
+
+        job = std::move(shard.jobs.front());
+        shard.jobs.pop_front();
+      }
+
+      job();
     }
-    catch (const std::exception& e)
+  }
+
+  void apply(
+    Shard& shard,
+    const char* update_name,
+    const std::function<void(Moderator&)>& update)
+  {
+    bool needs_heartbeat = false;
     {
-      RCLCPP_ERROR(
-        get_logger(), "Exception due to [cancel] update: %s", e.what());
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      try
+      {
+        update(*shard.moderator);
+      }
+      catch (const std::exception& e)
+      {
+        RCLCPP_ERROR(
+          get_logger(), "Exception due to [%s] update: %s",
+          update_name, e.what());
+      }
+
+      needs_heartbeat = !check_for_updates(shard);
     }
 
-    check_for_updates();
+    if (needs_heartbeat)
+      publish_status();
   }
 
-  void check_for_updates()
+  // The mutex of the shard must be locked. Returns false if a full heartbeat
+  // needs to be published.
+  bool check_for_updates(Shard& shard)
   {
-    const std::size_t current_version = moderator->assignments().version();
-    if (current_version == last_assignment_version)
-      return;
+    const std::size_t current_version =
+      shard.moderator->assignments().version();
+    if (current_version == shard.last_assignment_version)
+      return true;
 
-    last_assignment_version = current_version;
-    publish_status();
+    shard.last_assignment_version = current_version;
+    return publish_status_updates(shard);
   }
 
   using HeartbeatMsg = rmf_traffic_msgs::msg::BlockadeHeartbeat;
   rclcpp::Publisher<HeartbeatMsg>::SharedPtr heartbeat_pub;
-  using StatusMsg = rmf_traffic_msgs::msg::BlockadeStatus;
-  void publish_status()
+  static std::vector<StatusMsg> current_statuses(const Moderator& moderator)
   {
-    const auto& ranges = moderator->assignments().ranges();
+    const auto& ranges = moderator.assignments().ranges();
 
     std::vector<StatusMsg> statuses;
-    for (const auto& s : moderator->statuses())
+    for (const auto& s : moderator.statuses())
     {
       const std::size_t participant = s.first;
       const auto& range = ranges.at(participant);
@@ -240,15 +433,97 @@ public:
         .assignment_end(range.end));
     }
 
+    return statuses;
+  }
+
+  bool any_gridlock() const
+  {
+    for (const auto& shard : shards)
+    {
+      if (shard->has_gridlock)
+        return true;
+    }
+
+    return false;
+  }
+
+  // Publish the status of every participant. This is what participants that
+  // just joined rely on, and it is the only way to tell the writers that a
+  // participant no longer has any reservation.
+  void publish_status()
+  {
+    std::vector<StatusMsg> statuses;
+    for (auto& shard : shards)
+    {
+      std::lock_guard<std::mutex> lock(shard->mutex);
+      auto shard_statuses = current_statuses(*shard->moderator);
+
+      shard->last_published.clear();
+      for (const auto& status : shard_statuses)
+        shard->last_published.insert({status.participant, status});
+
+      shard->has_gridlock = shard->moderator->has_gridlock();
+      statuses.insert(
+        statuses.end(), shard_statuses.begin(), shard_statuses.end());
+    }
+
     auto msg = rmf_traffic_msgs::build<HeartbeatMsg>()
       .statuses(std::move(statuses))
-      .has_gridlock(moderator->has_gridlock());
+      .has_gridlock(any_gridlock());
 
     heartbeat_pub->publish(msg);
   }
 
-  std::shared_ptr<rmf_traffic::blockade::Moderator> moderator;
-  std::size_t last_assignment_version = 0;
+  // Publish only the statuses of a shard that changed since the last
+  // publication. The mutex of the shard must be locked. If a participant
+  // disappeared from the moderator, this returns false without publishing
+  // anything, because the updates cannot express a removal.
+  rclcpp::Publisher<HeartbeatMsg>::SharedPtr status_updates_pub;
+  bool publish_status_updates(Shard& shard)
+  {
+    const auto statuses = current_statuses(*shard.moderator);
+
+    std::vector<StatusMsg> changed;
+    std::size_t still_present = 0;
+    for (const auto& status : statuses)
+    {
+      const auto it = shard.last_published.find(status.participant);
+      if (it == shard.last_published.end())
+      {
+        changed.push_back(status);
+        continue;
+      }
+
+      ++still_present;
+      if (it->second != status)
+        changed.push_back(status);
+    }
+
+    if (still_present < shard.last_published.size())
+      return false;
+
+    const bool has_gridlock = shard.moderator->has_gridlock();
+    if (changed.empty() && has_gridlock == shard.has_gridlock)
+      return true;
+
+    for (const auto& status : changed)
+      shard.last_published[status.participant] = status;
+
+    shard.has_gridlock = has_gridlock;
+    auto msg = rmf_traffic_msgs::build<HeartbeatMsg>()
+      .statuses(std::move(changed))
+      .has_gridlock(any_gridlock());
+
+    status_updates_pub->publish(msg);
+    return true;
+  }
+
+  std::vector<std::unique_ptr<Shard>> shards;
+
+  // These are only used by the thread that spins the node
+  std::unordered_map<std::string, std::size_t> map_shard;
+  std::unordered_map<std::size_t, std::size_t> participant_shard;
+
   rclcpp::TimerBase::SharedPtr heartbeat_timer;
 };
 
@@ -265,25 +540,30 @@ std::shared_ptr<rclcpp::Node> make_node(
 {
   auto node = std::make_shared<BlockadeNode>(node_name, options);
 
-  node->moderator->info_logger(
-    [w = node->weak_from_this()](std::string msg)
-    {
-      if (const auto n = w.lock())
+  for (const auto& shard : node->shards)
+  {
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    const auto& moderator = shard->moderator;
+    moderator->info_logger(
+      [w = node->weak_from_this()](std::string msg)
       {
-        RCLCPP_INFO(n->get_logger(), "%s", msg.c_str());
-      }
-    });
+        if (const auto n = w.lock())
+        {
+          RCLCPP_INFO(n->get_logger(), "%s", msg.c_str());
+        }
+      });
 
-  node->moderator->debug_logger(
-    [w = node->weak_from_this()](std::string msg)
-    {
-      if (const auto n = w.lock())
+    moderator->debug_logger(
+      [w = node->weak_from_this()](std::string msg)
       {
-        RCLCPP_DEBUG(n->get_logger(), "%s", msg.c_str());
-      }
-    });
+        if (const auto n = w.lock())
+        {
+          RCLCPP_DEBUG(n->get_logger(), "%s", msg.c_str());
+        }
+      });
 
-  node->moderator->minimum_conflict_angle(15.0*M_PI/180.0);
+    moderator->minimum_conflict_angle(15.0*M_PI/180.0);
+  }
 
   return node;
 }
@@ -65,11 +65,15 @@ public:
 
   };
 
+  using StatusMsg = rmf_traffic_msgs::msg::BlockadeStatus;
   struct RectifierStub
   {
     rmf_traffic::blockade::Rectifier rectifier;
     std::optional<ReservationId> last_reservation_id;
     NewRangeCallback range_cb;
+
+    // The last status update that was applied since the previous heartbeat
+    std::optional<StatusMsg> last_update = std::nullopt;
   };
 
   using StubMap = std::unordered_map<
@@ -85,6 +89,7 @@ public:
 
   using HeartbeatMsg = rmf_traffic_msgs::msg::BlockadeHeartbeat;
   rclcpp::Subscription<HeartbeatMsg>::SharedPtr heartbeat_sub;
+  rclcpp::Subscription<HeartbeatMsg>::SharedPtr status_updates_sub;
 
   // NOTE(MXG): Because of some awkwardness in the design of the rectification
   // factory, we can only allow one participant to be constructed at a time.
@@ -106,6 +111,14 @@ public:
       {
         check_status(*msg);
       });
+
+    status_updates_sub = node.create_subscription<HeartbeatMsg>(
+      BlockadeStatusUpdatesTopicName,
+      rclcpp::SystemDefaultsQoS().keep_last(100).reliable(),
+      [&](const HeartbeatMsg::UniquePtr msg)
+      {
+        check_status_updates(*msg);
+      });
   }
 
   std::unique_ptr<rmf_traffic::blockade::RectificationRequester> make(
@@ -144,7 +157,6 @@ public:
     }
   }
 
-  using StatusMsg = rmf_traffic_msgs::msg::BlockadeStatus;
   rmf_traffic::blockade::Status convert(const StatusMsg& msg)
   {
     rmf_traffic::blockade::Status output;
@@ -165,6 +177,62 @@ public:
     return range;
   }
 
+  // Heartbeats and status updates arrive on different topics, so a heartbeat
+  // may carry a status that is older than an update which was already
+  // applied. Reservations and the progress through them only move forward, so
+  // that can be detected by comparing those. The assigned range is not
+  // compared because it can shrink within the same reservation and progress,
+  // e.g. after a release.
+  static bool is_behind(const StatusMsg& status, const StatusMsg& last)
+  {
+    if (status.reservation != last.reservation)
+      return status.reservation < last.reservation;
+
+    return status.last_reached < last.last_reached;
+  }
+
+  void apply_status(RectifierStub& stub, const StatusMsg& status)
+  {
+    stub.rectifier.check(convert(status));
+
+    const auto range = get_range(status);
+    stub.last_reservation_id = status.reservation;
+    stub.range_cb(status.reservation, range);
+  }
+
+  // Status updates only mention the participants whose status changed, so
+  // every other participant is left alone.
+  void check_status_updates(const HeartbeatMsg& updates)
+  {
+    const auto writer = weak_writer.lock();
+    if (!writer)
+      return;
+
+    std::unique_lock<std::mutex> lock(factory_mutex);
+
+    bring_out_your_dead();
+    for (const auto& status : updates.statuses)
+    {
+      const auto it = stub_map.find(status.participant);
+      if (it == stub_map.end())
+      {
+        // The next heartbeat will decide whether this participant should stay
+        // in the dead set.
+        if (dead_set.count(status.participant) != 0)
+          writer->cancel(status.participant);
+
+        continue;
+      }
+
+      const auto stub = it->second.lock();
+      if (!stub)
+        continue;
+
+      apply_status(*stub, status);
+      stub->last_update = status;
+    }
+  }
+
   void check_status(const HeartbeatMsg& heartbeat)
   {
     const auto writer = weak_writer.lock();
@@ -180,7 +248,7 @@ public:
     for (const auto& status : heartbeat.statuses)
     {
       const auto it = stub_map_copy.find(status.participant);
-      if (it == stub_map.end())
+      if (it == stub_map_copy.end())
       {
         const auto d_it = dead_set.find(status.participant);
         if (d_it != dead_set.end())
@@ -202,15 +270,20 @@ public:
         continue;
       }
 
-      stub->rectifier.check(convert(status));
-
-      const auto range = get_range(status);
-      stub->last_reservation_id = status.reservation;
-      stub->range_cb(status.reservation, range);
+      // Only drop a status that is strictly older than an update which was
+      // applied after the previous heartbeat.
+      if (!stub->last_update || !is_behind(status, *stub->last_update))
+        apply_status(*stub, status);
 
       stub_map_copy.erase(it);
     }
 
+    for (const auto& s : stub_map)
+    {
+      if (const auto stub = s.second.lock())
+        stub->last_update = std::nullopt;
+    }
+
     for (const auto& s : stub_map_copy)
     {
       // Check on the remaining stubs to make sure they shouldn't have any
@@ -0,0 +1,376 @@
+/*
+ * Copyright (C) 2022 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <rmf_traffic_ros2/schedule/ParticipantRegistry.hpp>
+#include <rmf_traffic_ros2/schedule/ParticipantDescription.hpp>
+
+#include <rclcpp/serialization.hpp>
+#include <rclcpp/serialized_message.hpp>
+
+#include <zlib.h>
+
+#include <array>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <utility>
+
+namespace rmf_traffic_ros2 {
+namespace schedule {
+
+namespace {
+//==============================================================================
+// Every journal begins with this tag, which also identifies the format version
+// in its last character.
+constexpr std::array<char, 8> JournalTag = {
+  'R', 'M', 'F', 'P', 'L', 'O', 'G', '1'
+};
+
+// Each record begins with the length of its payload and a CRC-32 of its
+// operation type and payload, both as little-endian 32-bit integers. This is
+// followed by the operation type and then the payload, which is the CDR
+// serialization of a rmf_traffic_msgs/ParticipantDescription.
+constexpr std::size_t RecordHeaderSize = 9;
+
+using DescriptionMsg = rmf_traffic_msgs::msg::ParticipantDescription;
+
+//==============================================================================
+void write_u32(char* data, const uint32_t value)
+{
+  for (std::size_t i = 0; i < 4; ++i)
+    data[i] = static_cast<char>((value >> (8*i)) & 0xFF);
+}
+
+//==============================================================================
+uint32_t read_u32(const char* data)
+{
+  uint32_t value = 0;
+  for (std::size_t i = 0; i < 4; ++i)
+    value |= static_cast<uint32_t>(static_cast<uint8_t>(data[i])) << (8*i);
+
+  return value;
+}
+
+//==============================================================================
+uint32_t checksum(const uint8_t op, const uint8_t* payload, std::size_t size)
+{
+  uLong crc = crc32(0L, Z_NULL, 0);
+  crc = crc32(crc, &op, 1);
+  crc = crc32(crc, payload, static_cast<uInt>(size));
+  return static_cast<uint32_t>(crc);
+}
+
+//==============================================================================
+std::string make_record(const AtomicOperation& operation)
+{
+  static const rclcpp::Serialization<DescriptionMsg> serializer;
+  const auto msg = rmf_traffic_ros2::convert(operation.description);
+  rclcpp::SerializedMessage serialized;
+  serializer.serialize_message(&msg, &serialized);
+
+  const auto& payload = serialized.get_rcl_serialized_message();
+  const auto op = static_cast<uint8_t>(operation.operation);
+
+  std::string record(RecordHeaderSize + payload.buffer_length, '\0');
+  write_u32(&record[0], static_cast<uint32_t>(payload.buffer_length));
+  write_u32(&record[4], checksum(op, payload.buffer, payload.buffer_length));
+  record[8] = static_cast<char>(op);
+  std::memcpy(&record[RecordHeaderSize], payload.buffer, payload.buffer_length);
+
+  return record;
+}
+
+//==============================================================================
+ParticipantDescription parse_description(const std::string& payload)
+{
+  static const rclcpp::Serialization<DescriptionMsg> serializer;
+  rclcpp::SerializedMessage serialized(payload.size());
+  auto& raw = serialized.get_rcl_serialized_message();
+  std::memcpy(raw.buffer, payload.data(), payload.size());
+  raw.buffer_length = payload.size();
+
+  DescriptionMsg msg;
+  serializer.deserialize_message(&serialized, &msg);
+  return rmf_traffic_ros2::convert(msg);
+}
+
+//==============================================================================
+// Participants are identified by their name and owner together, the same way
+// as the ParticipantRegistry identifies them. The two are kept apart so that
+// ("ab", "c") and ("a", "bc") cannot be mistaken for the same participant.
+using UniqueId = std::pair<std::string, std::string>;
+
+//==============================================================================
+UniqueId unique_id(const ParticipantDescription& description)
+{
+  return {description.name(), description.owner()};
+}
+
+} // anonymous namespace
+
+//==============================================================================
+class BinaryLogger::Implementation
+{
+public:
+  //===========================================================================
+  Implementation(std::string file_path, std::size_t compaction_threshold)
+  : _file_path(std::move(file_path)),
+    _compaction_threshold(compaction_threshold)
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (!std::filesystem::exists(_file_path))
+    {
+      std::filesystem::create_directories(
+        std::filesystem::absolute(_file_path).parent_path());
+      _rewrite();
+      return;
+    }
+
+    _load();
+
+    if (_superseded > _compaction_threshold)
+      _rewrite();
+    else
+      _open_for_append();
+  }
+
+  //===========================================================================
+  void write_operation(const AtomicOperation& operation)
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _record(operation);
+
+    const auto record = make_record(operation);
+    _file.write(record.data(), static_cast<std::streamsize>(record.size()));
+    _file.flush();
+
+    if (!_file)
+    {
+      // *INDENT-OFF*
+      throw std::runtime_error(
+        "[BinaryLogger] Failed to write to participant journal ["
+        + _file_path + "]");
+      // *INDENT-ON*
+    }
+
+    if (_superseded > _compaction_threshold)
+      _rewrite();
+  }
+
+  //===========================================================================
+  std::optional<AtomicOperation> read_next_record()
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_counter >= _initial_count)
+    {
+      // We have reached the end of the journal, restoration is complete.
+      return std::nullopt;
+    }
+
+    return AtomicOperation{
+      AtomicOperation::OpType::Add,
+      _descriptions[_counter++]
+    };
+  }
+
+  //===========================================================================
+  void compact()
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _rewrite();
+  }
+
+private:
+  //===========================================================================
+  void _record(const AtomicOperation& operation)
+  {
+    auto id = unique_id(operation.description);
+    const auto it = _id_to_index.find(id);
+    if (it == _id_to_index.end())
+    {
+      _id_to_index.emplace(std::move(id), _descriptions.size());
+      _descriptions.push_back(operation.description);
+      return;
+    }
+
+    _descriptions[it->second] = operation.description;
+    ++_superseded;
+  }
+
+  //===========================================================================
+  void _load()
+  {
+    std::ifstream file(_file_path, std::ios::binary);
+    std::array<char, JournalTag.size()> tag;
+    if (!file.read(tag.data(), tag.size()) || tag != JournalTag)
+    {
+      // *INDENT-OFF*
+      throw std::runtime_error(
+        "[BinaryLogger] The file [" + _file_path + "] is not a participant "
+        "journal");
+      // *INDENT-ON*
+    }
+
+    const auto file_size =
+      static_cast<std::streamoff>(std::filesystem::file_size(_file_path));
+    std::streamoff valid_end = file.tellg();
+    std::array<char, RecordHeaderSize> header;
+    std::string payload;
+    while (file.read(header.data(), header.size()))
+    {
+      const auto size = read_u32(&header[0]);
+      const auto expected_crc = read_u32(&header[4]);
+      const auto op = static_cast<uint8_t>(header[8]);
+
+      // A record that claims to be longer than the rest of the file was cut
+      // off while it was being written.
+      const auto record_end =
+        valid_end + static_cast<std::streamoff>(RecordHeaderSize + size);
+      if (record_end > file_size)
+        break;
+
+      payload.resize(size);
+      if (!file.read(payload.data(), size))
+        break;
+
+      const auto* bytes = reinterpret_cast<const uint8_t*>(payload.data());
+      if (checksum(op, bytes, size) != expected_crc)
+      {
+        // *INDENT-OFF*
+        throw std::runtime_error(
+          "[BinaryLogger] Checksum mismatch in participant journal ["
+          + _file_path + "] at byte " + std::to_string(valid_end));
+        // *INDENT-ON*
+      }
+
+      const auto op_type = static_cast<AtomicOperation::OpType>(op);
+      if (op_type != AtomicOperation::OpType::Add
+        && op_type != AtomicOperation::OpType::Update)
+      {
+        // *INDENT-OFF*
+        throw std::runtime_error(
+          "[BinaryLogger] Unknown operation type [" + std::to_string(op)
+          + "] in participant journal [" + _file_path + "]");
+        // *INDENT-ON*
+      }
+
+      _record({op_type, parse_description(payload)});
+      valid_end = file.tellg();
+    }
+
+    file.close();
+    _initial_count = _descriptions.size();
+
+    // Anything after the last complete record was left behind by a write that
+    // never finished, so we drop it before appending anything new.
+    if (valid_end < file_size)
+    {
+      std::filesystem::resize_file(
+        _file_path, static_cast<std::uintmax_t>(valid_end));
+    }
+  }
+
+  //===========================================================================
+  void _open_for_append()
+  {
+    _file = std::ofstream(
+      _file_path, std::ios::binary | std::ios::out | std::ios::app);
+  }
+
+  //===========================================================================
+  /// Write a fresh journal with only the latest description of each
+  /// participant, then atomically swap it in for the current one.
+  void _rewrite()
+  {
+    if (_file.is_open())
+      _file.close();
+
+    const std::string temp_path = _file_path + ".tmp";
+    {
+      std::ofstream temp(temp_path, std::ios::binary | std::ios::trunc);
+      temp.write(JournalTag.data(), JournalTag.size());
+      for (const auto& description : _descriptions)
+      {
+        const auto record =
+          make_record({AtomicOperation::OpType::Add, description});
+        temp.write(record.data(), static_cast<std::streamsize>(record.size()));
+      }
+
+      temp.flush();
+      if (!temp)
+      {
+        // *INDENT-OFF*
+        throw std::runtime_error(
+          "[BinaryLogger] Failed to compact participant journal into ["
+          + temp_path + "]");
+        // *INDENT-ON*
+      }
+    }
+
+    std::filesystem::rename(temp_path, _file_path);
+    _superseded = 0;
+    _open_for_append();
+  }
+
+  std::string _file_path;
+  std::size_t _compaction_threshold;
+  std::ofstream _file;
+
+  /// The latest description of each participant in the order they were added
+  std::vector<ParticipantDescription> _descriptions;
+  std::map<UniqueId, std::size_t> _id_to_index;
+
+  /// How many records in the journal have been superseded by later ones
+  std::size_t _superseded = 0;
+
+  std::size_t _initial_count = 0;
+  std::size_t _counter = 0;
+  std::mutex _mutex;
+};
+
+//=============================================================================
+BinaryLogger::BinaryLogger(
+  std::string file_path,
+  std::size_t compaction_threshold)
+: _pimpl(rmf_utils::make_unique_impl<Implementation>(
+      std::move(file_path), compaction_threshold))
+{
+  // Do nothing
+}
+
+//=============================================================================
+void BinaryLogger::write_operation(AtomicOperation operation)
+{
+  _pimpl->write_operation(operation);
+}
+
+//=============================================================================
+std::optional<AtomicOperation> BinaryLogger::read_next_record()
+{
+  return _pimpl->read_next_record();
+}
+
+//=============================================================================
+void BinaryLogger::compact()
+{
+  _pimpl->compact();
+}
+
+} // namespace schedule
+} // namespace rmf_traffic_ros2
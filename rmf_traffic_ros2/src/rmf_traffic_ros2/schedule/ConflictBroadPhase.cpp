@@ -0,0 +1,362 @@
+/*
+ * Copyright (C) 2022 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include "internal_ConflictBroadPhase.hpp"
+#include "internal_ChangedParticipants.hpp"
+
+#include <rmf_traffic/Time.hpp>
+#include <rmf_traffic/Trajectory.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace rmf_traffic_ros2 {
+namespace schedule {
+
+namespace {
+//==============================================================================
+int64_t floor_div(const int64_t value, const int64_t divisor)
+{
+  int64_t result = value / divisor;
+  if ((value % divisor != 0) && ((value < 0) != (divisor < 0)))
+    --result;
+
+  return result;
+}
+
+//==============================================================================
+struct Box
+{
+  Eigen::Vector2d min;
+  Eigen::Vector2d max;
+
+  Box(const Eigen::Vector2d& p)
+  : min(p),
+    max(p)
+  {
+    // Do nothing
+  }
+
+  void expand(const Eigen::Vector2d& p)
+  {
+    min = min.cwiseMin(p);
+    max = max.cwiseMax(p);
+  }
+
+  void inflate(const double r)
+  {
+    min -= Eigen::Vector2d(r, r);
+    max += Eigen::Vector2d(r, r);
+  }
+};
+} // anonymous namespace
+
+//==============================================================================
+std::size_t ConflictBroadPhase::CellKeyHash::operator()(
+  const CellKey& key) const
+{
+  std::size_t h = std::hash<int64_t>()(key.x);
+  h = h * 1000003u ^ std::hash<int64_t>()(key.y);
+  h = h * 1000003u ^ std::hash<int64_t>()(key.t);
+  return h;
+}
+
+//==============================================================================
+ConflictBroadPhase::ConflictBroadPhase(
+  const double cell_size,
+  const rmf_traffic::Duration time_window,
+  const std::size_t max_cells_per_segment)
+: _cell_size(cell_size),
+  _time_window(std::max<int64_t>(1, time_window.count())),
+  _max_cells_per_segment(max_cells_per_segment)
+{
+  // Do nothing
+}
+
+//==============================================================================
+void ConflictBroadPhase::update(
+  const View& view_changes,
+  const ItineraryViewer& viewer)
+{
+  const auto participants = find_changed_participants(
+    view_changes, viewer, _participants,
+    [](const auto& record) { return record.routes.size(); });
+
+  for (const auto participant : participants.stale)
+    erase(participant);
+
+  for (const auto participant : participants.changed)
+    update(participant, viewer);
+}
+
+//==============================================================================
+void ConflictBroadPhase::update(
+  const ParticipantId participant,
+  const ItineraryViewer& viewer)
+{
+  erase(participant);
+
+  const auto itinerary = viewer.get_itinerary(participant);
+  const auto description = viewer.get_participant(participant);
+  if (!itinerary.has_value() || !description)
+    return;
+
+  const double r = radius(description->profile());
+  auto& record = _participants[participant];
+  record.routes.reserve(itinerary->size());
+  for (std::size_t i = 0; i < itinerary->size(); ++i)
+  {
+    const auto& route = (*itinerary)[i];
+    const Entry entry{participant, i};
+
+    CellSet cells;
+    RouteRecord route_record{route->map(), {}, false};
+    auto& map_index = _maps[route->map()];
+    if (_collect_cells(*route, r, cells))
+    {
+      route_record.cells.reserve(cells.size());
+      for (const auto& cell : cells)
+      {
+        map_index.cells[cell].push_back(entry);
+        route_record.cells.push_back(cell);
+      }
+    }
+    else
+    {
+      route_record.oversized = true;
+      map_index.oversized.push_back(entry);
+    }
+
+    record.routes.emplace_back(std::move(route_record));
+  }
+}
+
+//==============================================================================
+void ConflictBroadPhase::erase(const ParticipantId participant)
+{
+  const auto it = _participants.find(participant);
+  if (it == _participants.end())
+    return;
+
+  const auto belongs = [participant](const Entry& e)
+    {
+      return e.participant == participant;
+    };
+
+  for (const auto& route : it->second.routes)
+  {
+    const auto map_it = _maps.find(route.map);
+    if (map_it == _maps.end())
+      continue;
+
+    auto& map_index = map_it->second;
+    if (route.oversized)
+    {
+      auto& oversized = map_index.oversized;
+      oversized.erase(
+        std::remove_if(oversized.begin(), oversized.end(), belongs),
+        oversized.end());
+    }
+
+    for (const auto& cell : route.cells)
+    {
+      const auto cell_it = map_index.cells.find(cell);
+      if (cell_it == map_index.cells.end())
+        continue;
+
+      auto& entries = cell_it->second;
+      entries.erase(
+        std::remove_if(entries.begin(), entries.end(), belongs),
+        entries.end());
+
+      if (entries.empty())
+        map_index.cells.erase(cell_it);
+    }
+
+    if (map_index.cells.empty() && map_index.oversized.empty())
+      _maps.erase(map_it);
+  }
+
+  _participants.erase(it);
+}
+
+//==============================================================================
+auto ConflictBroadPhase::candidates(
+  const rmf_traffic::Route& route,
+  const rmf_traffic::Profile& profile) const -> Candidates
+{
+  Candidates output;
+  const auto map_it = _maps.find(route.map());
+  if (map_it == _maps.end())
+    return output;
+
+  const auto& map_index = map_it->second;
+  for (const auto& entry : map_index.oversized)
+    output[entry.participant].push_back(entry.route);
+
+  CellSet cells;
+  if (_collect_cells(route, radius(profile), cells))
+  {
+    for (const auto& cell : cells)
+    {
+      const auto cell_it = map_index.cells.find(cell);
+      if (cell_it == map_index.cells.end())
+        continue;
+
+      for (const auto& entry : cell_it->second)
+        output[entry.participant].push_back(entry.route);
+    }
+  }
+  else
+  {
+    // The query route is too large to look up cell by cell, so every route on
+    // this map is a candidate.
+    for (const auto& [_, entries] : map_index.cells)
+    {
+      for (const auto& entry : entries)
+        output[entry.participant].push_back(entry.route);
+    }
+  }
+
+  for (auto& [_, routes] : output)
+  {
+    std::sort(routes.begin(), routes.end());
+    routes.erase(std::unique(routes.begin(), routes.end()), routes.end());
+  }
+
+  return output;
+}
+
+//==============================================================================
+std::size_t ConflictBroadPhase::participant_count() const
+{
+  return _participants.size();
+}
+
+//==============================================================================
+std::size_t ConflictBroadPhase::cell_count() const
+{
+  std::size_t count = 0;
+  for (const auto& [_, map_index] : _maps)
+    count += map_index.cells.size();
+
+  return count;
+}
+
+//==============================================================================
+double ConflictBroadPhase::radius(const rmf_traffic::Profile& profile)
+{
+  double r = 0.0;
+  if (const auto& footprint = profile.footprint())
+    r = std::max(r, footprint->get_characteristic_length());
+
+  if (const auto& vicinity = profile.vicinity())
+    r = std::max(r, vicinity->get_characteristic_length());
+
+  return r;
+}
+
+//==============================================================================
+bool ConflictBroadPhase::_collect_cells(
+  const rmf_traffic::Route& route,
+  const double radius,
+  CellSet& cells) const
+{
+  const auto insert_box = [&](
+    Box box,
+    const rmf_traffic::Time start,
+    const rmf_traffic::Time finish) -> bool
+    {
+      box.inflate(radius);
+      const auto cell = [this](const double value) -> int64_t
+        {
+          return static_cast<int64_t>(std::floor(value/_cell_size));
+        };
+
+      const auto window = [this](const rmf_traffic::Time time) -> int64_t
+        {
+          return floor_div(time.time_since_epoch().count(), _time_window);
+        };
+
+      const int64_t x0 = cell(box.min.x());
+      const int64_t x1 = cell(box.max.x());
+      const int64_t y0 = cell(box.min.y());
+      const int64_t y1 = cell(box.max.y());
+      const int64_t t0 = window(start);
+      const int64_t t1 = window(finish);
+
+      const double count = static_cast<double>(x1 - x0 + 1)
+        * static_cast<double>(y1 - y0 + 1)
+        * static_cast<double>(t1 - t0 + 1);
+      if (count > static_cast<double>(_max_cells_per_segment))
+        return false;
+
+      for (int64_t x = x0; x <= x1; ++x)
+      {
+        for (int64_t y = y0; y <= y1; ++y)
+        {
+          for (int64_t t = t0; t <= t1; ++t)
+            cells.insert(CellKey{x, y, t});
+        }
+      }
+
+      return true;
+    };
+
+  const auto& trajectory = route.trajectory();
+  const rmf_traffic::Trajectory::Waypoint* previous = nullptr;
+  for (const auto& wp : trajectory)
+  {
+    if (!previous)
+    {
+      previous = &wp;
+      continue;
+    }
+
+    // The segment between two waypoints is a cubic Hermite spline, so it is
+    // fully contained by the convex hull of its Bezier control points.
+    const double dt =
+      rmf_traffic::time::to_seconds(wp.time() - previous->time());
+    const Eigen::Vector2d p0 = previous->position().head<2>();
+    const Eigen::Vector2d v0 = previous->velocity().head<2>();
+    const Eigen::Vector2d p1 = wp.position().head<2>();
+    const Eigen::Vector2d v1 = wp.velocity().head<2>();
+
+    Box box(p0);
+    box.expand(p0 + v0*dt/3.0);
+    box.expand(p1 - v1*dt/3.0);
+    box.expand(p1);
+
+    if (!insert_box(box, previous->time(), wp.time()))
+      return false;
+
+    previous = &wp;
+  }
+
+  if (trajectory.size() == 1)
+  {
+    const auto& wp = trajectory.front();
+    if (!insert_box(
+        Box(wp.position().head<2>()), wp.time(), wp.time()))
+      return false;
+  }
+
+  return true;
+}
+
+} // namespace schedule
+} // namespace rmf_traffic_ros2
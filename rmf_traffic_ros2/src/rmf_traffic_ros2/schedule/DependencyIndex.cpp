@@ -0,0 +1,146 @@
+/*
+ * Copyright (C) 2022 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include "internal_DependencyIndex.hpp"
+#include "internal_ChangedParticipants.hpp"
+
+#include <algorithm>
+
+namespace rmf_traffic_ros2 {
+namespace schedule {
+
+//==============================================================================
+void DependencyIndex::update(
+  const View& view_changes,
+  const ItineraryViewer& viewer)
+{
+  const auto participants = find_changed_participants(
+    view_changes, viewer, _itinerary_sizes,
+    [](const std::size_t size) { return size; });
+
+  for (const auto participant : participants.stale)
+  {
+    erase(participant);
+    _dependents.erase(participant);
+  }
+
+  for (const auto participant : participants.changed)
+    update(participant, viewer);
+}
+
+//==============================================================================
+void DependencyIndex::update(
+  const ParticipantId participant,
+  const ItineraryViewer& viewer)
+{
+  erase(participant);
+
+  const auto itinerary = viewer.get_itinerary(participant);
+  if (!itinerary.has_value())
+    return;
+
+  _itinerary_sizes[participant] = itinerary->size();
+
+  std::vector<ParticipantId> dependencies;
+  for (const auto& route : *itinerary)
+  {
+    for (const auto& [on_participant, dependency] : route->dependencies())
+    {
+      if (on_participant == participant || !dependency.plan().has_value())
+        continue;
+
+      dependencies.push_back(on_participant);
+    }
+  }
+
+  std::sort(dependencies.begin(), dependencies.end());
+  dependencies.erase(
+    std::unique(dependencies.begin(), dependencies.end()),
+    dependencies.end());
+
+  if (dependencies.empty())
+    return;
+
+  for (const auto on_participant : dependencies)
+    _dependents[on_participant].insert(participant);
+
+  _dependencies[participant] = std::move(dependencies);
+}
+
+//==============================================================================
+void DependencyIndex::erase(const ParticipantId participant)
+{
+  _itinerary_sizes.erase(participant);
+
+  const auto it = _dependencies.find(participant);
+  if (it == _dependencies.end())
+    return;
+
+  for (const auto on_participant : it->second)
+  {
+    const auto d_it = _dependents.find(on_participant);
+    if (d_it == _dependents.end())
+      continue;
+
+    d_it->second.erase(participant);
+    if (d_it->second.empty())
+      _dependents.erase(d_it);
+  }
+
+  _dependencies.erase(it);
+}
+
+//==============================================================================
+auto DependencyIndex::dependents(const ParticipantId participant) const
+-> const ParticipantSet*
+{
+  const auto it = _dependents.find(participant);
+  if (it == _dependents.end())
+    return nullptr;
+
+  return &it->second;
+}
+
+//==============================================================================
+void DependencyIndex::expand(ParticipantSet& participants) const
+{
+  std::vector<ParticipantId> queue(participants.begin(), participants.end());
+  while (!queue.empty())
+  {
+    const auto check = queue.back();
+    queue.pop_back();
+
+    const auto* deps = dependents(check);
+    if (!deps)
+      continue;
+
+    for (const auto p : *deps)
+    {
+      if (participants.insert(p).second)
+        queue.push_back(p);
+    }
+  }
+}
+
+//==============================================================================
+std::size_t DependencyIndex::participant_count() const
+{
+  return _dependencies.size();
+}
+
+} // namespace schedule
+} // namespace rmf_traffic_ros2
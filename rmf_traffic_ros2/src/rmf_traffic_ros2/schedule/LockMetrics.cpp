@@ -0,0 +1,172 @@
+/*
+ * Copyright (C) 2022 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include "internal_LockMetrics.hpp"
+
+#include <cstdio>
+
+namespace rmf_traffic_ros2 {
+namespace schedule {
+
+//==============================================================================
+void LatencyHistogram::record(const std::chrono::nanoseconds duration)
+{
+  const uint64_t ns = duration.count() > 0 ?
+    static_cast<uint64_t>(duration.count()) : 0;
+
+  std::size_t bucket = 0;
+  uint64_t us = ns / 1000;
+  while (us > 0 && bucket + 1 < NumBuckets)
+  {
+    us >>= 1;
+    ++bucket;
+  }
+
+  _buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+  _count.fetch_add(1, std::memory_order_relaxed);
+  _total_ns.fetch_add(ns, std::memory_order_relaxed);
+
+  uint64_t current_max = _max_ns.load(std::memory_order_relaxed);
+  while (current_max < ns
+    && !_max_ns.compare_exchange_weak(current_max, ns))
+  {
+    // Keep trying until the max is at least ns
+  }
+}
+
+//==============================================================================
+uint64_t LatencyHistogram::count() const
+{
+  return _count.load();
+}
+
+//==============================================================================
+double LatencyHistogram::mean_us() const
+{
+  const auto n = _count.load();
+  if (n == 0)
+    return 0.0;
+
+  return static_cast<double>(_total_ns.load()) / 1000.0 / n;
+}
+
+//==============================================================================
+double LatencyHistogram::max_us() const
+{
+  return static_cast<double>(_max_ns.load()) / 1000.0;
+}
+
+//==============================================================================
+double LatencyHistogram::percentile_us(const double percentile) const
+{
+  const auto n = _count.load();
+  if (n == 0)
+    return 0.0;
+
+  const double threshold = percentile / 100.0 * static_cast<double>(n);
+  uint64_t cumulative = 0;
+  for (std::size_t i = 0; i < NumBuckets; ++i)
+  {
+    cumulative += _buckets[i].load();
+    if (static_cast<double>(cumulative) >= threshold)
+      return static_cast<double>(uint64_t(1) << i);
+  }
+
+  return max_us();
+}
+
+//==============================================================================
+std::string LatencyHistogram::summary() const
+{
+  char buffer[256];
+  std::snprintf(
+    buffer, sizeof(buffer),
+    "n=%lu mean=%.1fus p50<%.0fus p99<%.0fus max=%.1fus",
+    static_cast<unsigned long>(count()),
+    mean_us(),
+    percentile_us(50.0),
+    percentile_us(99.0),
+    max_us());
+
+  return buffer;
+}
+
+//==============================================================================
+void LatencyHistogram::reset()
+{
+  for (auto& bucket : _buckets)
+    bucket = 0;
+
+  _count = 0;
+  _total_ns = 0;
+  _max_ns = 0;
+}
+
+//==============================================================================
+std::string LockMetrics::summary() const
+{
+  return "wait [" + wait.summary() + "] hold [" + hold.summary() + "]";
+}
+
+//==============================================================================
+void LockMetrics::reset()
+{
+  wait.reset();
+  hold.reset();
+}
+
+//==============================================================================
+MeasuredLock::MeasuredLock(std::mutex& mutex, LockMetrics& metrics)
+: _lock(mutex, std::defer_lock),
+  _metrics(metrics)
+{
+  const auto start = Clock::now();
+  _lock.lock();
+  _acquired = Clock::now();
+  _metrics.wait.record(_acquired - start);
+}
+
+//==============================================================================
+std::unique_lock<std::mutex>& MeasuredLock::get()
+{
+  return _lock;
+}
+
+//==============================================================================
+void MeasuredLock::restart_hold_timer()
+{
+  _acquired = Clock::now();
+}
+
+//==============================================================================
+void MeasuredLock::unlock()
+{
+  if (!_lock.owns_lock())
+    return;
+
+  _metrics.hold.record(Clock::now() - _acquired);
+  _lock.unlock();
+}
+
+//==============================================================================
+MeasuredLock::~MeasuredLock()
+{
+  unlock();
+}
+
+} // namespace schedule
+} // namespace rmf_traffic_ros2
@@ -16,6 +16,11 @@
 */
 
 #include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
 
 #include <rclcpp/logger.hpp>
 #include <rclcpp/rclcpp.hpp>
@@ -64,6 +69,42 @@ using ScheduleQueries = rmf_traffic_msgs::msg::ScheduleQueries;
 using ScheduleIdentity = rmf_traffic_msgs::msg::ScheduleIdentity;
 using ScheduleIdentitySub = rclcpp::Subscription<ScheduleIdentity>::SharedPtr;
 
+//==============================================================================
+/// Holds the latest snapshot of a mirror so that readers can grab it without
+/// locking anything. The mirror manager replaces the snapshot each time the
+/// mirror changes. Snapshots share their route data with the mirror, so making
+/// a new one does not copy the schedule.
+class PublishedSnapshot : public rmf_traffic::schedule::Snappable
+{
+public:
+
+  using Snapshot = rmf_traffic::schedule::Snapshot;
+
+  PublishedSnapshot(std::shared_ptr<const rmf_traffic::schedule::Mirror> mirror)
+  : _mirror(std::move(mirror))
+  {
+    // Do nothing
+  }
+
+  std::shared_ptr<const Snapshot> snapshot() const final
+  {
+    if (auto latest = std::atomic_load(&_latest))
+      return latest;
+
+    // Snapshots are not being published, so take one from the mirror directly
+    return _mirror->snapshot();
+  }
+
+  void publish(std::shared_ptr<const Snapshot> next)
+  {
+    std::atomic_store(&_latest, std::move(next));
+  }
+
+private:
+  std::shared_ptr<const rmf_traffic::schedule::Mirror> _mirror;
+  std::shared_ptr<const Snapshot> _latest;
+};
+
 //==============================================================================
 class MirrorManager::Implementation
 {
@@ -75,7 +116,7 @@ public:
 
   std::weak_ptr<rclcpp::Node> weak_node;
   rmf_traffic::schedule::Query query;
-  uint64_t query_id;
+  std::atomic<uint64_t> query_id;
   rmf_traffic_msgs::msg::ScheduleIdentity schedule_node_id;
   bool require_query_validation = false;
   std::list<MirrorUpdate::SharedPtr> stashed_query_updates;
@@ -91,6 +132,34 @@ public:
   RegisterQueryClient register_query_client;
 
   std::shared_ptr<rmf_traffic::schedule::Mirror> mirror;
+  std::shared_ptr<PublishedSnapshot> published_snapshot;
+
+  // Guards the mirror and the options, since patches may be applied to the
+  // mirror by the decode thread. The user's update_mutex is always locked
+  // after this one.
+  mutable std::mutex mirror_mutex;
+
+  // Guards the service clients that can be used by the decode thread, as well
+  // as the change requests that are waiting for a response.
+  std::mutex services_mutex;
+
+  // Change requests that have been sent but not yet answered, identified by
+  // the version they start from. A burst of bad patches would otherwise make
+  // the schedule node send the same remedial update several times. Each entry
+  // expires so that a lost response cannot block the same request forever.
+  std::map<std::optional<uint64_t>, std::chrono::steady_clock::time_point>
+  pending_change_requests;
+  static constexpr std::chrono::seconds change_request_expiry =
+    std::chrono::seconds(5);
+
+  // When Options::decode_thread() is turned on, incoming mirror updates are
+  // passed to this thread to be converted and applied, in the order that they
+  // arrived, so the executor thread does not get held up by them.
+  std::thread decode_thread;
+  std::mutex decode_mutex;
+  std::condition_variable decode_cv;
+  std::deque<MirrorUpdate::SharedPtr> decode_queue;
+  bool decode_quit = false;
 
   bool initial_update = true;
 
@@ -107,13 +176,19 @@ public:
     query_id(_query_id),
     schedule_node_id(_schedule_node_id),
     options(std::move(_options)),
-    mirror(std::make_shared<rmf_traffic::schedule::Mirror>())
+    mirror(std::make_shared<rmf_traffic::schedule::Mirror>()),
+    published_snapshot(std::make_shared<PublishedSnapshot>(mirror))
   {
+    publish_snapshot();
+
     setup_update_topics();
     setup_queries_sub();
 
-    request_changes_client = node->create_client<RequestChanges>(
-      RequestChangesServiceName);
+    {
+      std::lock_guard<std::mutex> lock(services_mutex);
+      request_changes_client = node->create_client<RequestChanges>(
+        RequestChangesServiceName);
+    }
 
     schedule_startup_sub = node->create_subscription<ScheduleIdentity>(
       rmf_traffic_ros2::ScheduleStartupTopicName,
@@ -280,16 +355,21 @@ public:
 
     try
     {
+      const auto participants = convert(*msg);
+
+      std::lock_guard<std::mutex> lock(mirror_mutex);
       std::mutex* update_mutex = options.update_mutex();
       if (update_mutex)
       {
-        std::lock_guard<std::mutex> lock(*update_mutex);
-        mirror->update_participants_info(convert(*msg));
+        std::lock_guard<std::mutex> update_lock(*update_mutex);
+        mirror->update_participants_info(participants);
       }
       else
       {
-        mirror->update_participants_info(convert(*msg));
+        mirror->update_participants_info(participants);
       }
+
+      publish_snapshot();
     }
     catch (const std::exception& e)
     {
@@ -327,30 +407,138 @@ public:
     stashed_query_updates.clear();
   }
 
-  void apply_patch(
-    const std::shared_ptr<rclcpp::Node>& node,
-    const rmf_traffic_msgs::msg::SchedulePatch& msg,
-    const bool is_remedial)
+  // Convert the patch of an update and apply it to the mirror. The patch is
+  // only converted once, and the mirror is only locked for the update itself.
+  // This may be called from either the executor or the decode thread.
+  void apply_update(const MirrorUpdate& msg)
   {
-    const rmf_traffic::schedule::Patch patch = convert(msg);
-    if (!mirror->update(patch) && !is_remedial)
+    const auto node = weak_node.lock();
+    if (!node)
+      return;
+
+    std::optional<rmf_traffic::schedule::Patch> patch;
+    try
     {
-      std::string patch_base = patch.base_version() ?
-        std::to_string(*patch.base_version()) : std::string("any");
-      std::string mirror_version = mirror->latest_version() ?
-        std::to_string(*mirror->latest_version()) : std::string("none");
+      patch = convert(msg.patch);
+    }
+    catch (const std::exception& e)
+    {
+      RCLCPP_ERROR(
+        node->get_logger(),
+        "[rmf_traffic_ros2::MirrorManager] Failed to deserialize Patch "
+        "message: %s",
+        e.what());
+      // Nothing was applied to the mirror, so it is still consistent with the
+      // version it last reached. Only ask for the changes since then instead
+      // of a full update, unless the mirror has nothing yet.
+      request_update(latest_version());
+      return;
+    }
+
+    bool updated = false;
+    std::optional<rmf_traffic::schedule::Version> mirror_version;
+    try
+    {
+      std::lock_guard<std::mutex> lock(mirror_mutex);
+      std::mutex* update_mutex = options.update_mutex();
+      if (update_mutex)
+      {
+        std::lock_guard<std::mutex> update_lock(*update_mutex);
+        updated = mirror->update(*patch);
+      }
+      else
+      {
+        updated = mirror->update(*patch);
+      }
+
+      mirror_version = mirror->latest_version();
+      if (updated)
+        publish_snapshot();
+    }
+    catch (const std::exception& e)
+    {
+      RCLCPP_ERROR(
+        node->get_logger(),
+        "[rmf_traffic_ros2::MirrorManager] Failed to apply Patch: %s",
+        e.what());
+      request_update();
+      return;
+    }
+
+    if (!updated && !msg.is_remedial_update)
+    {
+      std::string patch_base = patch->base_version() ?
+        std::to_string(*patch->base_version()) : std::string("any");
+      std::string mirror_version_str = mirror_version ?
+        std::to_string(*mirror_version) : std::string("none");
       RCLCPP_WARN(
         node->get_logger(),
         "Failed to update using patch for DB version %lu "
         "(mirror version: %s, patch base: %s); requesting new update",
-        patch.latest_version(),
-        mirror_version.c_str(),
+        patch->latest_version(),
+        mirror_version_str.c_str(),
         patch_base.c_str());
 
-      request_update(mirror->latest_version());
+      request_update(mirror_version);
     }
   }
 
+  // Publish a new snapshot of the mirror if the options ask for it. This must
+  // be called while mirror_mutex is locked.
+  void publish_snapshot()
+  {
+    if (options.publish_snapshots())
+      published_snapshot->publish(mirror->snapshot());
+    else
+      published_snapshot->publish(nullptr);
+  }
+
+  void queue_update(MirrorUpdate::SharedPtr msg)
+  {
+    {
+      std::lock_guard<std::mutex> lock(decode_mutex);
+      if (!decode_thread.joinable())
+      {
+        decode_thread = std::thread([this]() { run_decode_thread(); });
+      }
+
+      decode_queue.emplace_back(std::move(msg));
+    }
+    decode_cv.notify_one();
+  }
+
+  void run_decode_thread()
+  {
+    std::unique_lock<std::mutex> lock(decode_mutex);
+    while (true)
+    {
+      decode_cv.wait(
+        lock, [&]() { return decode_quit || !decode_queue.empty(); });
+      if (decode_quit)
+        return;
+
+      const auto msg = std::move(decode_queue.front());
+      decode_queue.pop_front();
+      lock.unlock();
+
+      apply_update(*msg);
+
+      lock.lock();
+    }
+  }
+
+  ~Implementation()
+  {
+    {
+      std::lock_guard<std::mutex> lock(decode_mutex);
+      decode_quit = true;
+    }
+    decode_cv.notify_all();
+
+    if (decode_thread.joinable())
+      decode_thread.join();
+  }
+
   void handle_update(const MirrorUpdate::SharedPtr msg)
   {
     update_timer->reset();
@@ -393,31 +581,22 @@ public:
       return;
     }
 
-    try
+    // Once the decode thread has started, every update needs to go through it
+    // so that they do not get applied out of order.
+    bool use_decode_thread = false;
     {
-      const rmf_traffic::schedule::Patch patch = convert(msg->patch);
-
-      std::mutex* update_mutex = options.update_mutex();
-      if (update_mutex)
-      {
-        std::lock_guard<std::mutex> lock(*update_mutex);
-        apply_patch(node, msg->patch, msg->is_remedial_update);
-      }
-      else
-      {
-        apply_patch(node, msg->patch, msg->is_remedial_update);
-      }
+      std::lock_guard<std::mutex> lock(mirror_mutex);
+      use_decode_thread = options.decode_thread();
     }
-    catch (const std::exception& e)
     {
-      RCLCPP_ERROR(
-        node->get_logger(),
-        "[rmf_traffic_ros2::MirrorManager] Failed to deserialize Patch "
-        "message: %s",
-        e.what());
-      // Get a full update in case we're just missing some information
-      request_update();
+      std::lock_guard<std::mutex> lock(decode_mutex);
+      use_decode_thread |= decode_thread.joinable();
     }
+
+    if (use_decode_thread)
+      queue_update(msg);
+    else
+      apply_update(*msg);
   }
 
   void handle_update_timeout()
@@ -429,7 +608,18 @@ public:
     RCLCPP_INFO(
       node->get_logger(),
       "Requesting new schedule update because update timed out");
-    request_update(mirror->latest_version());
+    {
+      // Anything that was still waiting has evidently been lost
+      std::lock_guard<std::mutex> lock(services_mutex);
+      pending_change_requests.clear();
+    }
+    request_update(latest_version());
+  }
+
+  std::optional<rmf_traffic::schedule::Version> latest_version() const
+  {
+    std::lock_guard<std::mutex> lock(mirror_mutex);
+    return mirror->latest_version();
   }
 
   void request_update(std::optional<uint64_t> minimum_version = std::nullopt)
@@ -462,15 +652,43 @@ public:
       request.full_update = true;
     }
 
-    if (request_changes_client && request_changes_client->service_is_ready())
+    // The client is only kept if it is ready, and the request is only marked
+    // as pending when it is certain to be sent.
+    RequestChangesClient client;
+    {
+      std::lock_guard<std::mutex> lock(services_mutex);
+      if (request_changes_client && request_changes_client->service_is_ready())
+      {
+        const auto now = std::chrono::steady_clock::now();
+        const auto pending = pending_change_requests.find(minimum_version);
+        if (pending != pending_change_requests.end() && now < pending->second)
+        {
+          RCLCPP_DEBUG(
+            node->get_logger(),
+            "[rmf_traffic_ros2::MirrorManager::request_update] An identical "
+            "change request is already waiting for a response");
+          return;
+        }
+
+        pending_change_requests[minimum_version] = now + change_request_expiry;
+        client = request_changes_client;
+      }
+    }
+
+    if (client)
     {
-      request_changes_client->async_send_request(
+      client->async_send_request(
         std::make_shared<RequestChanges::Request>(request),
         [this, minimum_version](const RequestChangesFuture response)
         {
           // Check how the schedule node handled the request. The actual queries
           // update will come separately over the query update topic; this is
           // just whether the request was handled successfully or not.
+          {
+            std::lock_guard<std::mutex> lock(services_mutex);
+            pending_change_requests.erase(minimum_version);
+          }
+
           auto value = *response.get();
           if (!validate_service_response(value.node_id))
             return;
@@ -490,7 +708,7 @@ public:
                   node->get_logger(),
                   "[MirrorManager::request_update] Failed to request an update "
                   "for query ID [%ld] up from version [%lu]. Error message: %s",
-                  query_id,
+                  query_id.load(),
                   minimum_version.value(),
                   value.error.c_str());
               }
@@ -501,7 +719,7 @@ public:
                   "[MirrorManager::request_update] Failed to request an "
                   "update for query ID [%ld] from the beginning of recorded "
                   "history. Error message: %s",
-                  query_id,
+                  query_id.load(),
                   value.error.c_str());
               }
             }
@@ -570,7 +788,7 @@ public:
           RCLCPP_INFO(
             node->get_logger(),
             "[MirrorManager] Redoing query registration: Got new ID %lu",
-            query_id);
+            query_id.load());
           setup_update_topics();
           setup_queries_sub();
           this->register_query_client.reset();
@@ -594,8 +812,16 @@ public:
   void reconnect_services()
   {
     register_query_client = nullptr;
-    request_changes_client = nullptr;
-    mirror->reset();
+    {
+      std::lock_guard<std::mutex> lock(services_mutex);
+      request_changes_client = nullptr;
+      pending_change_requests.clear();
+    }
+    {
+      std::lock_guard<std::mutex> lock(mirror_mutex);
+      mirror->reset();
+      publish_snapshot();
+    }
 
     const auto node = weak_node.lock();
     if (!node)
@@ -617,8 +843,11 @@ public:
         register_query_client =
         node->create_client<RegisterQuery>(RegisterQueryServiceName);
 
-        request_changes_client = node->create_client<RequestChanges>(
-          RequestChangesServiceName);
+        {
+          std::lock_guard<std::mutex> lock(services_mutex);
+          request_changes_client = node->create_client<RequestChanges>(
+            RequestChangesServiceName);
+        }
 
         reconnect_services_timer = nullptr;
       });
@@ -669,16 +898,24 @@ public:
 
   bool update_on_wakeup;
 
+  bool decode_thread;
+
+  bool publish_snapshots;
+
 };
 
 //==============================================================================
 MirrorManager::Options::Options(
   std::mutex* update_mutex,
-  bool update_on_wakeup)
+  bool update_on_wakeup,
+  bool decode_thread,
+  bool publish_snapshots)
 : _pimpl(rmf_utils::make_impl<Implementation>(
       Implementation{
         update_mutex,
-        update_on_wakeup
+        update_on_wakeup,
+        decode_thread,
+        publish_snapshots
       }))
 {
   // Do nothing
@@ -710,6 +947,39 @@ auto MirrorManager::Options::update_on_wakeup(bool choice) -> Options&
   return *this;
 }
 
+//==============================================================================
+bool MirrorManager::Options::decode_thread() const
+{
+  return _pimpl->decode_thread;
+}
+
+//==============================================================================
+auto MirrorManager::Options::decode_thread(bool choice) -> Options&
+{
+  _pimpl->decode_thread = choice;
+  return *this;
+}
+
+//==============================================================================
+bool MirrorManager::Options::publish_snapshots() const
+{
+  return _pimpl->publish_snapshots;
+}
+
+//==============================================================================
+auto MirrorManager::Options::publish_snapshots(bool choice) -> Options&
+{
+  _pimpl->publish_snapshots = choice;
+  return *this;
+}
+
+//==============================================================================
+std::shared_ptr<const rmf_traffic::schedule::Snappable>
+MirrorManager::snapshots() const
+{
+  return _pimpl->published_snapshot;
+}
+
 //==============================================================================
 std::shared_ptr<const rmf_traffic::schedule::Mirror>
 MirrorManager::view() const
@@ -720,7 +990,7 @@ MirrorManager::view() const
 //==============================================================================
 void MirrorManager::update()
 {
-  _pimpl->request_update(_pimpl->mirror->latest_version());
+  _pimpl->request_update(_pimpl->latest_version());
 }
 
 //==============================================================================
@@ -732,13 +1002,16 @@ auto MirrorManager::get_options() const -> const Options&
 //==============================================================================
 MirrorManager& MirrorManager::set_options(Options options)
 {
+  std::lock_guard<std::mutex> lock(_pimpl->mirror_mutex);
   _pimpl->options = std::move(options);
+  _pimpl->publish_snapshot();
   return *this;
 }
 
 //==============================================================================
 rmf_traffic::schedule::Database MirrorManager::fork() const
 {
+  std::lock_guard<std::mutex> lock(_pimpl->mirror_mutex);
   return _pimpl->mirror->fork();
 }
 
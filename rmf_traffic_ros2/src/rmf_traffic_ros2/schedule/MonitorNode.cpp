@@ -47,6 +47,12 @@ MonitorNode::MonitorNode(
   setup();
 }
 
+//==============================================================================
+MonitorNode::~MonitorNode()
+{
+  stop_standby_thread();
+}
+
 //==============================================================================
 void MonitorNode::setup()
 {
@@ -56,6 +62,11 @@ void MonitorNode::setup()
   heartbeat_period = std::chrono::milliseconds(
     get_parameter("heartbeat_period").as_int());
 
+  // Keep a standby schedule node that replicates the primary node, instead of
+  // building a new schedule node after the primary node dies
+  declare_parameter<bool>("hot_standby", false);
+  hot_standby = get_parameter("hot_standby").as_bool();
+
   start_heartbeat_listener();
   start_data_synchronisers();
 }
@@ -89,13 +100,21 @@ void MonitorNode::start_heartbeat_listener()
         get_logger(),
         "  not_alive_count_change: %d",
         event.not_alive_count_change);
-      if ( // The ideal pattern is 0, -1, 1, 1
+      const bool primary_died = // The ideal pattern is 0, -1, 1, 1
         event.alive_count == 0 && event.alive_count_change < 0 &&
-        event.not_alive_count > 0 && event.not_alive_count_change > 0)
+        event.not_alive_count > 0 && event.not_alive_count_change > 0;
+
+      // A hot standby also takes over if the primary node went away without
+      // its liveliness lapsing, e.g. because its process was shut down.
+      const bool primary_left = standby_node &&
+        event.alive_count == 0 && event.alive_count_change < 0;
+
+      if (!failed_over && (primary_died || primary_left))
       {
         RCLCPP_ERROR(
           get_logger(),
           "Detected death of primary schedule node");
+        failed_over = true;
         on_fail_over_callback(create_new_schedule_node());
       }
     };
@@ -144,6 +163,9 @@ void MonitorNode::start_data_synchronisers()
 //==============================================================================
 std::shared_ptr<rclcpp::Node> MonitorNode::create_new_schedule_node()
 {
+  if (standby_node)
+    return promote_standby();
+
   auto database = std::make_shared<Database>(mirror.value().fork());
   auto node = std::make_shared<rmf_traffic_ros2::schedule::ScheduleNode>(
     database,
@@ -152,6 +174,73 @@ std::shared_ptr<rclcpp::Node> MonitorNode::create_new_schedule_node()
   return node;
 }
 
+//==============================================================================
+bool MonitorNode::start_hot_standby(const std::chrono::nanoseconds timeout)
+{
+  const auto context = get_node_options().context();
+  standby_node = std::make_shared<ScheduleNode>(
+    std::make_shared<Database>(),
+    get_node_options(),
+    ScheduleNode::no_automatic_setup);
+
+  rclcpp::ExecutorOptions executor_options;
+  executor_options.context = context;
+  standby_executor =
+    std::make_shared<rclcpp::executors::SingleThreadedExecutor>(
+    executor_options);
+  standby_executor->add_node(standby_node);
+  standby_thread = std::thread(
+    [executor = standby_executor]()
+    {
+      executor->spin();
+    });
+
+  // The negotiations that the standby node replicates are started from
+  // snapshots of this mirror, so we have them published as it changes.
+  auto mirror_future = rmf_traffic_ros2::schedule::make_mirror(
+    standby_node, rmf_traffic::schedule::query_all(),
+    MirrorManager::Options().publish_snapshots(true));
+
+  const auto stop_time = std::chrono::steady_clock::now() + timeout;
+  while (rclcpp::ok(context) && std::chrono::steady_clock::now() < stop_time)
+  {
+    if (mirror_future.wait_for(100ms) == std::future_status::ready)
+    {
+      standby_node->setup_standby(mirror_future.get());
+      return true;
+    }
+  }
+
+  stop_standby_thread();
+  standby_node.reset();
+  return false;
+}
+
+//==============================================================================
+std::shared_ptr<rclcpp::Node> MonitorNode::promote_standby()
+{
+  stop_standby_thread();
+  auto node = std::move(standby_node);
+  standby_node.reset();
+
+  node->take_over(registered_queries);
+  return node;
+}
+
+//==============================================================================
+void MonitorNode::stop_standby_thread()
+{
+  if (!standby_executor)
+    return;
+
+  standby_executor->cancel();
+  if (standby_thread.joinable())
+    standby_thread.join();
+
+  standby_executor->remove_node(standby_node);
+  standby_executor.reset();
+}
+
 //==============================================================================
 std::shared_ptr<rclcpp::Node> make_monitor_node(
   std::function<void(std::shared_ptr<rclcpp::Node>)> callback,
@@ -160,6 +249,22 @@ std::shared_ptr<rclcpp::Node> make_monitor_node(
 {
   auto node = std::make_shared<MonitorNode>(callback, options);
 
+  if (node->hot_standby)
+  {
+    if (node->start_hot_standby(startup_timeout))
+    {
+      RCLCPP_INFO(
+        node->get_logger(),
+        "Got standby schedule node for monitor node");
+      return node;
+    }
+
+    RCLCPP_WARN(
+      node->get_logger(),
+      "Timeout while trying to replicate the traffic schedule");
+    return nullptr;
+  }
+
   auto mirror_future = rmf_traffic_ros2::schedule::make_mirror(
     node, rmf_traffic::schedule::query_all());
 
@@ -16,8 +16,10 @@
 */
 
 #include "NegotiationRoom.hpp"
+#include "internal_WorkerPool.hpp"
 
 #include <rmf_traffic_ros2/Route.hpp>
+#include <rmf_traffic_ros2/Time.hpp>
 #include <rmf_traffic_ros2/schedule/Itinerary.hpp>
 #include <rmf_traffic_ros2/schedule/Negotiation.hpp>
 
@@ -34,6 +36,9 @@
 
 #include <rclcpp/logging.hpp>
 
+#include <algorithm>
+#include <unordered_set>
+
 namespace rmf_traffic_ros2 {
 namespace schedule {
 
@@ -108,12 +113,24 @@ public:
       if (table->defunct())
         return;
 
+      // A negotiator may revise its proposal while the table is still open, so
+      // each accepted submission moves the version that we build on forward.
+      // Revisions are capped because every one of them raises the version of
+      // the table, which also stretches the response timeouts of negotiators.
+      if (submitted
+        && impl->revisions(conflict_version, table) >= max_revisions)
+        return;
+
       if (table->submit(plan_id, itinerary, table_version+1))
       {
-        impl->approvals[conflict_version][table] = {
-          table->sequence(),
-          std::move(approval_callback)
-        };
+        ++table_version;
+        auto& approval = impl->approvals[conflict_version][table];
+        if (submitted)
+          ++approval.revisions;
+
+        submitted = true;
+        approval.sequence = table->sequence();
+        approval.callback = std::move(approval_callback);
 
         impl->publish_proposal(conflict_version, *table);
 
@@ -199,7 +216,7 @@ public:
     const rmf_traffic::schedule::Version conflict_version;
 
     const rmf_traffic::schedule::Negotiation::TablePtr table;
-    rmf_traffic::schedule::Version table_version;
+    mutable rmf_traffic::schedule::Version table_version;
 
     using OptVersion = rmf_utils::optional<rmf_traffic::schedule::Version>;
     const rmf_traffic::schedule::Negotiation::TablePtr parent;
@@ -207,7 +224,86 @@ public:
 
     rclcpp::TimerBase::SharedPtr timer;
     mutable bool responded = false;
+    mutable bool submitted = false;
+
+    static constexpr std::size_t max_revisions = 2;
+  };
+
+  /// A responder that is handed to negotiators while they work on the
+  /// responder pool. It only records the decision of the negotiator so that
+  /// the decision can be applied to the negotiation (and published) by the
+  /// thread that is spinning the node, in a deterministic order.
+  class PooledResponder : public rmf_traffic::schedule::Negotiator::Responder
+  {
+  public:
+
+    PooledResponder(std::shared_ptr<Responder> target_)
+    : target(std::move(target_))
+    {
+      // Do nothing
+    }
+
+    void submit(
+      rmf_traffic::PlanId plan_id,
+      std::vector<rmf_traffic::Route> itinerary,
+      std::function<UpdateVersion()> approval_callback) const final
+    {
+      decide(
+        [plan_id, itinerary = std::move(itinerary),
+        approval_callback = std::move(approval_callback)](
+          const Responder& responder)
+        {
+          responder.submit(plan_id, itinerary, approval_callback);
+        });
+    }
+
+    void reject(const Alternatives& alternatives) const final
+    {
+      decide(
+        [alternatives](const Responder& responder)
+        {
+          responder.reject(alternatives);
+        });
+    }
+
+    void forfeit(const std::vector<ParticipantId>& blockers) const final
+    {
+      decide(
+        [blockers](const Responder& responder)
+        {
+          responder.forfeit(blockers);
+        });
+    }
+
+    /// Apply the decision of the negotiator. If the negotiator did not make a
+    /// decision, the table will be forfeited. Any decision that arrives after
+    /// this is called will be ignored.
+    void apply()
+    {
+      std::shared_ptr<Responder> responder;
+      std::function<void(const Responder&)> choice;
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        responder = std::move(target);
+        choice = std::move(decision);
+      }
+
+      if (responder && choice)
+        choice(*responder);
+    }
+
+  private:
+
+    void decide(std::function<void(const Responder&)> choice) const
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (target && !decision)
+        decision = std::move(choice);
+    }
 
+    mutable std::mutex mutex;
+    mutable std::shared_ptr<Responder> target;
+    mutable std::function<void(const Responder&)> decision;
   };
 
   rclcpp::Node& node;
@@ -215,6 +311,20 @@ public:
   std::shared_ptr<Worker> worker;
   rmf_traffic::Duration timeout = std::chrono::seconds(15);
 
+  // Used to respond to independent tables concurrently when there is no worker
+  std::size_t responder_thread_count = 1;
+  std::unique_ptr<WorkerPool> responder_pool;
+  rclcpp::TimerBase::SharedPtr responder_timer;
+
+  using TablePtr = rmf_traffic::schedule::Negotiation::TablePtr;
+  using Version = rmf_traffic::schedule::Version;
+  struct PendingResponse
+  {
+    Version conflict_version;
+    TablePtr table;
+  };
+  std::vector<PendingResponse> pending_responses;
+
   using Repeat = rmf_traffic_msgs::msg::NegotiationRepeat;
   using RepeatSub = rclcpp::Subscription<Repeat>;
   using RepeatPub = rclcpp::Publisher<Repeat>;
@@ -267,12 +377,12 @@ public:
   using WeakFailureMapPtr = std::weak_ptr<FailureMap>;
   FailureMapPtr failure_callbacks;
 
-  using Version = rmf_traffic::schedule::Version;
   using Negotiation = rmf_traffic::schedule::Negotiation;
   struct Entry
   {
     bool participating;
     NegotiationRoom room;
+    rmf_traffic::Time started;
   };
 
   using NegotiationMap = std::unordered_map<Version, Entry>;
@@ -280,19 +390,47 @@ public:
   // The negotiations that this Negotiation class is involved in
   NegotiationMap negotiations;
 
-  using TablePtr = rmf_traffic::schedule::Negotiation::TablePtr;
   using ItineraryVersion = rmf_traffic::schedule::ItineraryVersion;
   using UpdateVersion = rmf_utils::optional<ItineraryVersion>;
   struct CallbackEntry
   {
     Negotiation::VersionedKeySequence sequence;
     std::function<UpdateVersion()> callback;
+
+    // How many times the proposal for this table has been revised
+    std::size_t revisions = 0;
   };
 
   using ApprovalCallbackMap = std::unordered_map<TablePtr, CallbackEntry>;
   using Approvals = std::unordered_map<Version, ApprovalCallbackMap>;
   Approvals approvals;
 
+  std::size_t revisions(
+    const Version conflict_version,
+    const TablePtr& table) const
+  {
+    const auto a_it = approvals.find(conflict_version);
+    if (a_it == approvals.end())
+      return 0;
+
+    const auto t_it = a_it->second.find(table);
+    if (t_it == a_it->second.end())
+      return 0;
+
+    return t_it->second.revisions;
+  }
+
+  // Every submission and rejection raises the version of a table, and that
+  // version is what limits how many times we retry a rejected table. Revised
+  // proposals also raise it, so they are left out of that count.
+  bool retries_exhausted(
+    const Version conflict_version,
+    const TablePtr& table) const
+  {
+    // TODO(MXG): Make this limit configurable
+    return table->version() - revisions(conflict_version, table) > 3;
+  }
+
   // Status update callbacks
   using TableViewPtr = rmf_traffic::schedule::Negotiation::Table::ViewerPtr;
   using StatusUpdateCallback =
@@ -303,8 +441,13 @@ public:
     std::function<void (uint64_t conflict_version, bool success)>;
   StatusConclusionCallback conclusion_callback;
 
+  // Concluded negotiations are kept as summaries in a ring buffer. The full
+  // negotiation trees are only kept while debug_history is turned on.
   uint retained_history_count = 0;
-  std::map<Version, rmf_traffic::schedule::Negotiation> history;
+  std::vector<Summary> history;
+  std::size_t next_history_slot = 0;
+  bool debug_history = false;
+  std::map<Version, rmf_traffic::schedule::Negotiation> debug_trees;
 
   Implementation(
     rclcpp::Node& node_,
@@ -429,6 +572,20 @@ public:
     std::vector<TablePtr> queue,
     Version conflict_version)
   {
+    if (responder_pool)
+    {
+      // The tables will be answered by the responder pool after the current
+      // callback is finished, together with any other tables that get queued
+      // in the meantime.
+      for (auto it = queue.rbegin(); it != queue.rend(); ++it)
+        pending_responses.push_back({conflict_version, *it});
+
+      if (!pending_responses.empty() && responder_timer->is_canceled())
+        responder_timer->reset();
+
+      return;
+    }
+
     while (!queue.empty())
     {
       const auto top = queue.back();
@@ -443,8 +600,7 @@ public:
         if (n_it == negotiators->end())
           continue;
 
-        // TODO(MXG): Make this limit configurable
-        if (top->version() > 3)
+        if (retries_exhausted(conflict_version, top))
         {
           // Give up on this table at this point to avoid an infinite loop
           top->forfeit(top->version());
@@ -470,6 +626,162 @@ public:
     }
   }
 
+  void queue_follow_ups(
+    const PendingResponse& entry,
+    std::vector<PendingResponse>& next)
+  {
+    const auto& table = entry.table;
+    if (table->submission())
+    {
+      for (const auto& c : table->children())
+        next.push_back({entry.conflict_version, c});
+    }
+    else if (const auto& parent = table->parent())
+    {
+      if (parent->rejected())
+        next.push_back({entry.conflict_version, parent});
+    }
+  }
+
+  void respond_to_pending()
+  {
+    responder_timer->cancel();
+    if (!responder_pool)
+    {
+      drain_pending_responses();
+      return;
+    }
+
+    // Each pass gathers every table that is waiting for one of our negotiators
+    // and lets the pool plan for them at the same time. No two tables in a
+    // pass are the same, and nothing in the negotiations gets modified until
+    // the whole pass is finished, so the negotiators are only ever looking at
+    // independent tables. The decisions are then applied and published in the
+    // order that the tables were queued, which keeps the outgoing messages
+    // deterministic no matter how the pool scheduled the work.
+    auto pass = std::move(pending_responses);
+    pending_responses.clear();
+    while (!pass.empty())
+    {
+      struct Job
+      {
+        PendingResponse entry;
+        rmf_traffic::schedule::Negotiator* negotiator;
+        TableViewPtr viewer;
+        std::shared_ptr<PooledResponder> responder;
+      };
+
+      std::vector<Job> jobs;
+      std::vector<PendingResponse> next;
+      std::unordered_set<TablePtr> visited;
+      for (const auto& entry : pass)
+      {
+        const auto& top = entry.table;
+        if (negotiations.count(entry.conflict_version) == 0)
+          continue;
+
+        if (top->defunct() || !visited.insert(top).second)
+          continue;
+
+        if (top->submission())
+        {
+          queue_follow_ups(entry, next);
+          continue;
+        }
+
+        const auto n_it = negotiators->find(top->participant());
+        if (n_it == negotiators->end())
+          continue;
+
+        if (retries_exhausted(entry.conflict_version, top))
+        {
+          // Give up on this table at this point to avoid an infinite loop
+          top->forfeit(top->version());
+          publish_forfeit(entry.conflict_version, *top);
+          continue;
+        }
+
+        jobs.push_back(
+          Job{
+            entry,
+            n_it->second.get(),
+            top->viewer(),
+            std::make_shared<PooledResponder>(
+              std::make_shared<Responder>(this, entry.conflict_version, top))
+          });
+      }
+
+      responder_pool->parallel_for(
+        jobs.size(),
+        [&jobs](const std::size_t i)
+        {
+          const auto& job = jobs[i];
+          job.negotiator->respond(job.viewer, job.responder);
+        });
+
+      for (const auto& job : jobs)
+      {
+        job.responder->apply();
+        queue_follow_ups(job.entry, next);
+      }
+
+      pass = std::move(next);
+    }
+  }
+
+  /// Answer any tables that were left for the responder pool one after
+  /// another instead.
+  void drain_pending_responses()
+  {
+    if (responder_timer)
+      responder_timer->cancel();
+
+    auto pending = std::move(pending_responses);
+    pending_responses.clear();
+    for (const auto& entry : pending)
+    {
+      if (negotiations.count(entry.conflict_version) == 0)
+        continue;
+
+      respond_to_queue({entry.table}, entry.conflict_version);
+    }
+  }
+
+  void set_responder_threads(const std::size_t count)
+  {
+    responder_thread_count = std::max<std::size_t>(count, 1);
+    if (responder_thread_count < 2)
+    {
+      responder_pool.reset();
+      drain_pending_responses();
+      return;
+    }
+
+    if (worker)
+    {
+      // The Worker already lets the negotiators respond asynchronously, and
+      // the pool would not be able to wait for those responses.
+      RCLCPP_WARN(
+        node.get_logger(),
+        "Negotiation responder threads were set to [%lu], but this "
+        "Negotiation has a Worker, so its tables will not be answered by a "
+        "responder pool.", responder_thread_count);
+      return;
+    }
+
+    responder_pool = std::make_unique<WorkerPool>(responder_thread_count);
+    if (!responder_timer)
+    {
+      responder_timer = node.create_wall_timer(
+        std::chrono::nanoseconds(0),
+        [this]()
+        {
+          this->respond_to_pending();
+        });
+      responder_timer->cancel();
+    }
+  }
+
   void receive_notice(const Notice& msg)
   {
     bool relevant = false;
@@ -507,7 +819,14 @@ public:
     }
 
     const auto insertion = negotiations.insert(
-      {msg.conflict_version, Entry{relevant, *std::move(new_negotiation)}});
+      {
+        msg.conflict_version,
+        Entry{
+          relevant,
+          *std::move(new_negotiation),
+          rmf_traffic_ros2::convert(node.now())
+        }
+      });
 
     const bool is_new = insertion.second;
     bool& participating = insertion.first->second.participating;
@@ -773,10 +1092,9 @@ public:
     Negotiation& negotiation = room.negotiation;
     const auto full_sequence = convert(msg.table);
 
+    std::vector<ParticipantAck> acknowledgments;
     if (participating)
     {
-      std::vector<ParticipantAck> acknowledgments;
-
       const auto approval_callback_it = approvals.find(msg.conflict_version);
       if (msg.resolved)
       {
@@ -896,7 +1214,7 @@ public:
       // Acknowledge that we know about this conclusion
       Ack ack;
       ack.conflict_version = msg.conflict_version;
-      ack.acknowledgments = std::move(acknowledgments);
+      ack.acknowledgments = acknowledgments;
 
       if (ack.acknowledgments.empty())
       {
@@ -916,14 +1234,28 @@ public:
     if (conclusion_callback)
       conclusion_callback(msg.conflict_version, msg.resolved);
 
-    // add to retained history
     if (retained_history_count > 0)
     {
-      while (history.size() >= retained_history_count)
-        history.erase(history.begin());
+      Summary summary;
+      summary.conflict_version = msg.conflict_version;
+      summary.resolved = msg.resolved;
+      summary.participants.assign(
+        negotiation.participants().begin(), negotiation.participants().end());
+      if (msg.resolved)
+        summary.resolution = full_sequence;
+
+      for (const auto& p_ack : acknowledgments)
+      {
+        if (p_ack.updating)
+        {
+          summary.itinerary_versions.insert(
+            {p_ack.participant, p_ack.itinerary_version});
+        }
+      }
 
-      history.emplace(
-        msg.conflict_version, std::move(negotiate_it->second.room.negotiation));
+      summary.started = negotiate_it->second.started;
+      summary.concluded = rmf_traffic_ros2::convert(node.now());
+      retain(std::move(summary), std::move(negotiation));
     }
 
     // Erase these entries because the negotiation has concluded
@@ -1031,9 +1363,65 @@ public:
       for_participant, negotiators, failure_callbacks);
   }
 
+  void retain(Summary summary, Negotiation negotiation)
+  {
+    if (history.size() < retained_history_count)
+    {
+      history.emplace_back(std::move(summary));
+    }
+    else
+    {
+      // The ring buffer is full, so the oldest summary gets overwritten
+      const auto& oldest = history[next_history_slot];
+      debug_trees.erase(oldest.conflict_version);
+      history[next_history_slot] = std::move(summary);
+    }
+
+    if (debug_history)
+    {
+      debug_trees.insert_or_assign(
+        history[next_history_slot].conflict_version, std::move(negotiation));
+    }
+
+    next_history_slot = (next_history_slot + 1) % retained_history_count;
+  }
+
   void set_retained_history_count(uint count)
   {
+    // Put the summaries in order from oldest to newest before resizing
+    auto summaries = get_history();
+    if (summaries.size() > count)
+    {
+      const auto excess = summaries.size() - count;
+      for (std::size_t i = 0; i < excess; ++i)
+        debug_trees.erase(summaries[i].conflict_version);
+
+      summaries.erase(summaries.begin(), summaries.begin() + excess);
+    }
+
     retained_history_count = count;
+    history = std::move(summaries);
+    next_history_slot = count > 0 ? history.size() % count : 0;
+  }
+
+  void set_debug_history(bool choice)
+  {
+    debug_history = choice;
+    if (!debug_history)
+      debug_trees.clear();
+  }
+
+  std::vector<Summary> get_history() const
+  {
+    if (history.size() < retained_history_count)
+      return history;
+
+    std::vector<Summary> ordered;
+    ordered.reserve(history.size());
+    for (std::size_t i = 0; i < history.size(); ++i)
+      ordered.push_back(history[(next_history_slot + i) % history.size()]);
+
+    return ordered;
   }
 
   TableViewPtr table_view(
@@ -1045,13 +1433,14 @@ public:
 
     if (negotiate_it == negotiations.end())
     {
-      const auto history_it = history.find(conflict_version);
-      if (history_it == history.end())
+      const auto history_it = debug_trees.find(conflict_version);
+      if (history_it == debug_trees.end())
       {
         RCLCPP_WARN(
           node.get_logger(),
           "Conflict version %lu does not exist."
-          "It may have been successful and wiped",
+          "It may have been successful and wiped. Turn on debug_history to "
+          "retain the tables of concluded negotiations.",
           conflict_version);
         return nullptr;
       }
@@ -1121,6 +1510,19 @@ rmf_traffic::Duration Negotiation::timeout_duration() const
   return _pimpl->timeout;
 }
 
+//==============================================================================
+Negotiation& Negotiation::responder_threads(std::size_t count)
+{
+  _pimpl->set_responder_threads(count);
+  return *this;
+}
+
+//==============================================================================
+std::size_t Negotiation::responder_threads() const
+{
+  return _pimpl->responder_thread_count;
+}
+
 //==============================================================================
 Negotiation::TableViewPtr Negotiation::table_view(
   uint64_t conflict_version,
@@ -1135,6 +1537,25 @@ void Negotiation::set_retained_history_count(uint count)
   return _pimpl->set_retained_history_count(count);
 }
 
+//==============================================================================
+Negotiation& Negotiation::debug_history(bool choice)
+{
+  _pimpl->set_debug_history(choice);
+  return *this;
+}
+
+//==============================================================================
+bool Negotiation::debug_history() const
+{
+  return _pimpl->debug_history;
+}
+
+//==============================================================================
+std::vector<Negotiation::Summary> Negotiation::history() const
+{
+  return _pimpl->get_history();
+}
+
 //==============================================================================
 std::shared_ptr<void> Negotiation::register_negotiator(
   rmf_traffic::schedule::ParticipantId for_participant,
@@ -134,7 +134,9 @@ void NegotiationRoom::update_state_msg(
 
 //==============================================================================
 std::vector<rmf_traffic::schedule::Negotiation::TablePtr> NegotiationRoom::
-check_cache(const NegotiatorMap& negotiators)
+check_cache(
+  const NegotiatorMap& negotiators,
+  rmf_traffic_msgs::msg::NegotiationState* applied)
 {
   std::vector<rmf_traffic::schedule::Negotiation::TablePtr> new_tables;
 
@@ -164,7 +166,11 @@ check_cache(const NegotiatorMap& negotiators)
           proposal.proposal_version);
 
         if (updated)
+        {
           new_tables.push_back(table);
+          if (applied)
+            applied->orphan_proposals.push_back(proposal);
+        }
 
         recheck = true;
         cached_proposals.erase(it++);
@@ -187,10 +193,14 @@ check_cache(const NegotiatorMap& negotiators)
       const auto table = search.table;
       if (table)
       {
-        table->reject(
+        const bool updated = table->reject(
           rejection.table.back().version,
           rejection.rejected_by,
           rmf_traffic_ros2::convert(rejection.alternatives));
+
+        if (updated && applied)
+          applied->orphan_rejections.push_back(rejection);
+
         recheck = true;
         cached_rejections.erase(it++);
       }
@@ -213,6 +223,9 @@ check_cache(const NegotiatorMap& negotiators)
       if (table)
       {
         table->forfeit(forfeit.table.back().version);
+        if (applied)
+          applied->orphan_forfeits.push_back(forfeit);
+
         recheck = true;
         cached_forfeits.erase(it++);
       }
@@ -62,8 +62,14 @@ struct NegotiationRoom
     rmf_traffic::Time start_time,
     rmf_traffic::Time last_active_time);
 
+  /// Apply any cached messages that now fit onto the negotiation.
+  ///
+  /// \param[in] applied
+  ///   If provided, every cached message that gets applied will be appended to
+  ///   the matching orphan list of this state message.
   std::vector<rmf_traffic::schedule::Negotiation::TablePtr> check_cache(
-    const NegotiatorMap& negotiators);
+    const NegotiatorMap& negotiators,
+    rmf_traffic_msgs::msg::NegotiationState* applied = nullptr);
 };
 
 //==============================================================================
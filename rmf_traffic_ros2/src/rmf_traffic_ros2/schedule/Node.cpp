@@ -17,6 +17,7 @@
 
 #include "internal_Node.hpp"
 
+#include <algorithm>
 #include <cstring>
 
 #include <rmf_traffic_ros2/Route.hpp>
@@ -36,13 +37,68 @@
 
 #include <rmf_utils/optional.hpp>
 
+#include <rclcpp/serialization.hpp>
+#include <rclcpp/serialized_message.hpp>
+
+#include <map>
+#include <tuple>
 #include <unordered_map>
+#include <unordered_set>
 #include <uuid/uuid.h>
 
 namespace rmf_traffic_ros2 {
 namespace schedule {
 
 namespace {
+//==============================================================================
+rmf_traffic_msgs::msg::NegotiationStatus make_negotiation_status(
+  const uint64_t conflict_version,
+  const ScheduleNode::ConflictRecord::OpenNegotiation& open)
+{
+  rmf_traffic_msgs::msg::NegotiationStatus status;
+  status.conflict_version = conflict_version;
+  const auto& participants = open.room.negotiation.participants();
+  status.participants.assign(participants.begin(), participants.end());
+  status.start_time = convert(open.start_time);
+  status.last_response_time = convert(open.last_active_time);
+  return status;
+}
+
+//==============================================================================
+std::size_t count_routes(const rmf_traffic::schedule::Database& database)
+{
+  std::size_t count = 0;
+  for (const auto p : database.participant_ids())
+  {
+    if (const auto itinerary = database.get_itinerary(p))
+      count += itinerary->size();
+  }
+
+  return count;
+}
+
+//==============================================================================
+std::optional<rmf_traffic::Time> earliest_finish_time(
+  const rmf_traffic::schedule::Database& database)
+{
+  std::optional<rmf_traffic::Time> earliest;
+  for (const auto p : database.participant_ids())
+  {
+    const auto itinerary = database.get_itinerary(p);
+    if (!itinerary)
+      continue;
+
+    for (const auto& route : *itinerary)
+    {
+      const auto* finish = route->trajectory().finish_time();
+      if (finish && (!earliest.has_value() || *finish < *earliest))
+        earliest = *finish;
+    }
+  }
+
+  return earliest;
+}
+
 //==============================================================================
 ScheduleNode::ScheduleId generate_node_id()
 {
@@ -72,12 +128,114 @@ std::string generate_schedule_node_name(const ScheduleNode::ScheduleId& id)
 
   return "rmf_traffic_schedule_node_" + uuid_underscore;
 }
+
+//==============================================================================
+void hash_combine(std::size_t& seed, const std::size_t value)
+{
+  seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+
+//==============================================================================
+void hash_time_bounds(
+  std::size_t& seed,
+  const rmf_traffic::Time* lower,
+  const rmf_traffic::Time* upper)
+{
+  hash_combine(seed, lower ? std::hash<int64_t>()(
+      lower->time_since_epoch().count()) : 0);
+  hash_combine(seed, upper ? std::hash<int64_t>()(
+      upper->time_since_epoch().count()) : 1);
+}
+
+//==============================================================================
+/// Put a query into a canonical form, so that queries which would produce the
+/// same results will compare as equal.
+rmf_traffic::schedule::Query canonicalize_query(
+  const rmf_traffic::schedule::Query& query)
+{
+  using Participants = rmf_traffic::schedule::Query::Participants;
+  auto output = query;
+
+  const auto sorted = [](std::vector<ScheduleNode::ParticipantId> ids)
+    {
+      std::sort(ids.begin(), ids.end());
+      ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+      return ids;
+    };
+
+  const auto& participants = query.participants();
+  if (participants.get_mode() == Participants::Mode::Include)
+  {
+    output.participants() =
+      Participants::make_only(sorted(participants.include()->get_ids()));
+  }
+  else if (participants.get_mode() == Participants::Mode::Exclude)
+  {
+    const auto ids = sorted(participants.exclude()->get_ids());
+    if (ids.empty())
+      output.participants() = Participants::make_all();
+    else
+      output.participants() = Participants::make_all_except(ids);
+  }
+
+  return output;
+}
+
+//==============================================================================
+/// Hash a query that has been canonicalized. Queries that compare as equal
+/// will always have the same hash.
+std::size_t hash_query(const rmf_traffic::schedule::Query& query)
+{
+  using Participants = rmf_traffic::schedule::Query::Participants;
+  using Spacetime = rmf_traffic::schedule::Query::Spacetime;
+
+  std::size_t seed = 0;
+  const auto& participants = query.participants();
+  hash_combine(seed, static_cast<std::size_t>(participants.get_mode()));
+  const std::vector<ScheduleNode::ParticipantId>* ids = nullptr;
+  if (participants.get_mode() == Participants::Mode::Include)
+    ids = &participants.include()->get_ids();
+  else if (participants.get_mode() == Participants::Mode::Exclude)
+    ids = &participants.exclude()->get_ids();
+
+  if (ids)
+  {
+    for (const auto id : *ids)
+      hash_combine(seed, std::hash<ScheduleNode::ParticipantId>()(id));
+  }
+
+  const auto& spacetime = query.spacetime();
+  hash_combine(seed, static_cast<std::size_t>(spacetime.get_mode()));
+  if (spacetime.get_mode() == Spacetime::Mode::Timespan)
+  {
+    const auto* timespan = spacetime.timespan();
+    hash_time_bounds(
+      seed,
+      timespan->get_lower_time_bound(),
+      timespan->get_upper_time_bound());
+  }
+  else if (spacetime.get_mode() == Spacetime::Mode::Regions)
+  {
+    for (const auto& region : *spacetime.regions())
+    {
+      hash_combine(seed, std::hash<std::string>()(region.get_map()));
+      hash_time_bounds(
+        seed,
+        region.get_lower_time_bound(),
+        region.get_upper_time_bound());
+    }
+  }
+
+  return seed;
+}
 }
 
 //==============================================================================
 std::vector<ScheduleNode::ConflictSet> get_conflicts(
   const rmf_traffic::schedule::Viewer::View& view_changes,
-  const rmf_traffic::schedule::ItineraryViewer& viewer)
+  const rmf_traffic::schedule::ItineraryViewer& viewer,
+  const ConflictBroadPhase& broad_phase,
+  WorkerPool* pool)
 {
   const auto is_unresponsive = [](
     const rmf_traffic::schedule::ParticipantDescription& desc) -> bool
@@ -86,7 +244,28 @@ std::vector<ScheduleNode::ConflictSet> get_conflicts(
         == rmf_traffic::schedule::ParticipantDescription::Rx::Unresponsive;
     };
 
-  std::vector<ScheduleNode::ConflictSet> conflicts;
+  // Use the broad-phase index to find which routes could possibly be in
+  // conflict with each of the changes. Only these candidates need to be passed
+  // along to DetectConflict.
+  std::vector<ConflictBroadPhase::Candidates> candidates;
+  for (const auto& vc : view_changes)
+  {
+    candidates.push_back(
+      broad_phase.candidates(*vc.route, vc.description.profile()));
+  }
+
+  // Each narrow-phase check that needs to be performed, in the order that
+  // their conflicts should be reported.
+  struct NarrowPhase
+  {
+    ScheduleNode::ParticipantId participant;
+    std::shared_ptr<const rmf_traffic::schedule::ParticipantDescription>
+    description;
+    std::shared_ptr<const rmf_traffic::Route> route;
+    const rmf_traffic::schedule::Viewer::View::Element* change;
+  };
+  std::vector<NarrowPhase> checks;
+
   const auto& participants = viewer.participant_ids();
   for (const auto participant : participants)
   {
@@ -96,7 +275,9 @@ std::vector<ScheduleNode::ConflictSet> get_conflicts(
     if (!description)
       continue;
 
-    for (auto vc = view_changes.begin(); vc != view_changes.end(); ++vc)
+    std::size_t vc_index = 0;
+    for (auto vc = view_changes.begin(); vc != view_changes.end();
+      ++vc, ++vc_index)
     {
       if (vc->participant == participant)
       {
@@ -111,8 +292,19 @@ std::vector<ScheduleNode::ConflictSet> get_conflicts(
         continue;
       }
 
-      for (std::size_t r = 0; r < itinerary.size(); ++r)
+      const auto candidate_it = candidates[vc_index].find(participant);
+      if (candidate_it == candidates[vc_index].end())
+        continue;
+
+      for (const std::size_t r : candidate_it->second)
       {
+        if (r >= itinerary.size())
+        {
+          // The index may still refer to routes that were removed from the
+          // itinerary since it was last updated.
+          continue;
+        }
+
         const auto& route = itinerary[r];
         assert(route);
         if (route->map() != vc->route->map())
@@ -134,17 +326,43 @@ std::vector<ScheduleNode::ConflictSet> get_conflicts(
         if (dep_u)
           continue;
 
-        const auto found_conflict = rmf_traffic::DetectConflict::between(
-          vc->description.profile(), vc->route->trajectory(), nullptr,
-          description->profile(), route->trajectory(), nullptr);
-        if (found_conflict.has_value())
-        {
-          conflicts.push_back({participant, vc->participant});
-        }
+        checks.push_back({participant, description, route, &(*vc)});
       }
     }
   }
 
+  // The narrow-phase checks are independent of each other, so they can be
+  // spread across the worker pool. Each result is stored in its own slot so
+  // the conflicts can be merged in a deterministic order afterwards.
+  std::vector<char> found(checks.size(), false);
+  const auto narrow_phase = [&](const std::size_t i)
+    {
+      const auto& check = checks[i];
+      found[i] = rmf_traffic::DetectConflict::between(
+        check.change->description.profile(),
+        check.change->route->trajectory(), nullptr,
+        check.description->profile(), check.route->trajectory(), nullptr)
+        .has_value();
+    };
+
+  if (pool)
+    pool->parallel_for(checks.size(), narrow_phase);
+  else
+  {
+    for (std::size_t i = 0; i < checks.size(); ++i)
+      narrow_phase(i);
+  }
+
+  std::vector<ScheduleNode::ConflictSet> conflicts;
+  for (std::size_t i = 0; i < checks.size(); ++i)
+  {
+    if (found[i])
+    {
+      conflicts.push_back(
+        {checks[i].participant, checks[i].change->participant});
+    }
+  }
+
   return conflicts;
 }
 
@@ -171,11 +389,84 @@ ScheduleNode::ScheduleNode(
   declare_parameter<std::string>(
     "log_file_location", ".rmf_schedule_node.yaml");
 
-  // TODO(MXG): Expose a parameter for the update period
-  // TODO(MXG): We can probably do something smarter to decide when to update
-  // than a simple wall timer
+  // Format of the participant registry log: "yaml" rewrites a YAML document
+  // for every registration, while "binary" appends to a compacted journal
+  declare_parameter<std::string>("log_file_format", "yaml");
+
+  // Number of threads used to check for conflicts. A value of 0 will use one
+  // thread per hardware core.
+  declare_parameter<int>("conflict_check_threads", 1);
+
+  // Period, in seconds, for logging how long the database mutex is waited on
+  // and held for. A value of 0 disables the reports.
+  declare_parameter<double>("lock_metrics_period", 0.0);
+
+  // Period, in milliseconds, for collecting changes to the schedule before
+  // they get published to the mirrors. A value of 0 publishes them on the
+  // next spin.
+  declare_parameter<int>("mirror_update_coalesce_period", 10);
+  const int64_t coalesce_period_ms =
+    get_parameter("mirror_update_coalesce_period").as_int();
+  if (coalesce_period_ms < 0)
+  {
+    RCLCPP_WARN(
+      get_logger(),
+      "Invalid value for mirror_update_coalesce_period: %ld. It cannot be "
+      "negative, so 0 will be used instead.",
+      coalesce_period_ms);
+  }
+  mirror_update_coalesce_period = std::chrono::milliseconds(
+    std::max<int64_t>(0, coalesce_period_ms));
+
+  // How long, in seconds, routes are kept in the schedule after they finish
+  declare_parameter<double>("cull_retention_horizon", 7200.0);
+  cull_retention_horizon = rmf_traffic::time::from_seconds(
+    get_parameter("cull_retention_horizon").as_double());
+
+  // Period, in seconds, between each round of culling
+  declare_parameter<double>("cull_period", 10.0);
+  cull_period = std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::duration<double>(get_parameter("cull_period").as_double()));
+
+  // Size, in seconds, of the time buckets that get culled together, and the
+  // maximum number of buckets to cull in each round. Smaller buckets hold the
+  // database_mutex for shorter stretches of time.
+  declare_parameter<double>("cull_bucket_duration", 60.0);
+  cull_bucket_duration = rmf_traffic::time::from_seconds(
+    get_parameter("cull_bucket_duration").as_double());
+  declare_parameter<int>("cull_max_buckets_per_tick", 5);
+  cull_max_buckets_per_tick = static_cast<std::size_t>(
+    std::max<int64_t>(1, get_parameter("cull_max_buckets_per_tick").as_int()));
+
+  // Period, in seconds, for logging the progress of the cull thread. A value
+  // of 0 disables the reports.
+  declare_parameter<double>("cull_metrics_period", 60.0);
+
+  // Period, in milliseconds, for collecting incoming itinerary changes so
+  // they can be applied to the database together. A value of 0 applies each
+  // change as soon as it arrives.
+  declare_parameter<int>("itinerary_batch_period", 0);
+  itinerary_batch_period = std::chrono::milliseconds(
+    get_parameter("itinerary_batch_period").as_int());
+
+  // Period, in seconds, for publishing the full trees of the open negotiations
+  // while they are changing. Every change in between is published as a delta
+  // on the negotiation_state_updates topic. A value of 0 only publishes the
+  // full trees when a negotiation opens or closes.
+  declare_parameter<double>("negotiation_keyframe_period", 1.0);
+
+  // The mirror updates are triggered by changes to the database. This timer
+  // stays cancelled until schedule_mirror_update() is called, and then fires
+  // once after the coalescing period, so that a burst of changes only produces
+  // one round of updates.
   mirror_update_timer = create_wall_timer(
-    std::chrono::milliseconds(10), [this]() { this->update_mirrors(); });
+    mirror_update_coalesce_period,
+    [this]()
+    {
+      this->mirror_update_timer->cancel();
+      this->update_mirrors();
+    });
+  mirror_update_timer->cancel();
 }
 
 //==============================================================================
@@ -243,6 +534,14 @@ ScheduleNode::~ScheduleNode()
   conflict_check_quit = true;
   if (conflict_check_thread.joinable())
     conflict_check_thread.join();
+
+  {
+    std::lock_guard<std::mutex> lock(cull_mutex);
+    cull_quit = true;
+  }
+  cull_cv.notify_all();
+  if (cull_thread.joinable())
+    cull_thread.join();
 }
 
 //==============================================================================
@@ -260,7 +559,11 @@ void ScheduleNode::setup(const QueryMap& queries)
 
   try
   {
-    auto participant_logger = std::make_unique<YamlLogger>(log_file_name);
+    std::unique_ptr<AbstractParticipantLogger> participant_logger;
+    if (get_parameter("log_file_format").as_string() == "binary")
+      participant_logger = std::make_unique<BinaryLogger>(log_file_name);
+    else
+      participant_logger = std::make_unique<YamlLogger>(log_file_name);
 
     participant_registry =
       std::make_shared<ParticipantRegistry>(
@@ -286,7 +589,9 @@ void ScheduleNode::setup(const QueryMap& queries)
   setup_itinerary_topics();
   setup_incosistency_pub();
   setup_conflict_topics_and_thread();
-  setup_cull_timer();
+  setup_cull_thread();
+  setup_lock_metrics();
+  setup_cull_metrics();
 }
 
 //==============================================================================
@@ -343,6 +648,19 @@ void ScheduleNode::setup_changes_services()
 //==============================================================================
 void ScheduleNode::setup_itinerary_topics()
 {
+  if (itinerary_batch_period > std::chrono::nanoseconds(0))
+  {
+    // This timer stays cancelled until a change gets queued up
+    itinerary_batch_timer = create_wall_timer(
+      itinerary_batch_period,
+      [this]()
+      {
+        this->itinerary_batch_timer->cancel();
+        this->apply_itinerary_batch();
+      });
+    itinerary_batch_timer->cancel();
+  }
+
   const auto itinerary_qos =
     rclcpp::SystemDefaultsQoS()
     .reliable()
@@ -352,45 +670,60 @@ void ScheduleNode::setup_itinerary_topics()
     create_subscription<ItinerarySet>(
     rmf_traffic_ros2::ItinerarySetTopicName,
     itinerary_qos,
-    [=](const ItinerarySet::UniquePtr msg)
+    [=](ItinerarySet::UniquePtr msg)
     {
-      this->itinerary_set(*msg);
+      if (this->itinerary_batch_timer)
+        this->queue_itinerary_change(std::move(*msg));
+      else
+        this->itinerary_set(*msg);
     });
 
   itinerary_extend_sub =
     create_subscription<ItineraryExtend>(
     rmf_traffic_ros2::ItineraryExtendTopicName,
     itinerary_qos,
-    [=](const ItineraryExtend::UniquePtr msg)
+    [=](ItineraryExtend::UniquePtr msg)
     {
-      this->itinerary_extend(*msg);
+      if (this->itinerary_batch_timer)
+        this->queue_itinerary_change(std::move(*msg));
+      else
+        this->itinerary_extend(*msg);
     });
 
   itinerary_delay_sub =
     create_subscription<ItineraryDelay>(
     rmf_traffic_ros2::ItineraryDelayTopicName,
     itinerary_qos,
-    [=](const ItineraryDelay::UniquePtr msg)
+    [=](ItineraryDelay::UniquePtr msg)
     {
-      this->itinerary_delay(*msg);
+      if (this->itinerary_batch_timer)
+        this->queue_itinerary_change(std::move(*msg));
+      else
+        this->itinerary_delay(*msg);
     });
 
   itinerary_reached_sub =
     create_subscription<ItineraryReached>(
     rmf_traffic_ros2::ItineraryReachedTopicName,
     itinerary_qos,
-    [=](const ItineraryReached::UniquePtr msg)
+    [=](ItineraryReached::UniquePtr msg)
     {
-      this->itinerary_reached(*msg);
+      if (this->itinerary_batch_timer)
+        this->queue_itinerary_change(std::move(*msg));
+      else
+        this->itinerary_reached(*msg);
     });
 
   itinerary_clear_sub =
     create_subscription<ItineraryClear>(
     rmf_traffic_ros2::ItineraryClearTopicName,
     itinerary_qos,
-    [=](const ItineraryClear::UniquePtr msg)
+    [=](ItineraryClear::UniquePtr msg)
     {
-      this->itinerary_clear(*msg);
+      if (this->itinerary_batch_timer)
+        this->queue_itinerary_change(std::move(*msg));
+      else
+        this->itinerary_clear(*msg);
     });
 }
 
@@ -404,12 +737,9 @@ void ScheduleNode::setup_incosistency_pub()
 }
 
 //==============================================================================
-void ScheduleNode::setup_conflict_topics_and_thread()
+void ScheduleNode::setup_negotiation_subscriptions(
+  const rclcpp::QoS& negotiation_qos)
 {
-  const auto negotiation_qos = rclcpp::ServicesQoS()
-    .reliable()
-    .keep_last(1000);
-
   conflict_ack_sub = create_subscription<ConflictAck>(
     rmf_traffic_ros2::NegotiationAckTopicName, negotiation_qos,
     [&](const ConflictAck::UniquePtr msg)
@@ -417,9 +747,6 @@ void ScheduleNode::setup_conflict_topics_and_thread()
       this->receive_conclusion_ack(*msg);
     });
 
-  conflict_notice_pub = create_publisher<ConflictNotice>(
-    rmf_traffic_ros2::NegotiationNoticeTopicName, negotiation_qos);
-
   conflict_refusal_sub = create_subscription<ConflictRefusal>(
     rmf_traffic_ros2::NegotiationRefusalTopicName, negotiation_qos,
     [&](const ConflictRefusal::UniquePtr msg)
@@ -447,6 +774,19 @@ void ScheduleNode::setup_conflict_topics_and_thread()
     {
       this->receive_forfeit(*msg);
     });
+}
+
+//==============================================================================
+void ScheduleNode::setup_conflict_topics_and_thread()
+{
+  const auto negotiation_qos = rclcpp::ServicesQoS()
+    .reliable()
+    .keep_last(1000);
+
+  conflict_notice_pub = create_publisher<ConflictNotice>(
+    rmf_traffic_ros2::NegotiationNoticeTopicName, negotiation_qos);
+
+  setup_negotiation_subscriptions(negotiation_qos);
 
   conflict_conclusion_pub = create_publisher<ConflictConclusion>(
     rmf_traffic_ros2::NegotiationConclusionTopicName, negotiation_qos);
@@ -460,35 +800,86 @@ void ScheduleNode::setup_conflict_topics_and_thread()
   negotiation_states_pub = create_publisher<NegotiationStates>(
     rmf_traffic_ros2::NegotiationStatesTopicName,
     single_reliable_transient_local);
-  // Initial conflict-free publication
-  negotiation_states_pub->publish(NegotiationStates{});
+
+  negotiation_state_updates_pub = create_publisher<NegotiationStates>(
+    rmf_traffic_ros2::NegotiationStateUpdatesTopicName,
+    rclcpp::ServicesQoS().reliable().keep_last(1000));
 
   negotiation_stasuses_pub = create_publisher<NegotiationStatuses>(
     rmf_traffic_ros2::NegotiationStatusesTopicName,
     single_reliable_transient_local);
-  // Initial conflict-free publication
-  negotiation_stasuses_pub->publish(NegotiationStatuses{});
+
+  // Initial publication. This is conflict-free unless the node has taken over
+  // the negotiations of a primary schedule node.
+  {
+    std::lock_guard<std::mutex> lock(active_conflicts_mutex);
+    publish_negotiation_states();
+  }
+
+  const double keyframe_period =
+    get_parameter("negotiation_keyframe_period").as_double();
+  if (keyframe_period > 0.0)
+  {
+    negotiation_keyframe_timer = create_wall_timer(
+      std::chrono::duration<double>(keyframe_period),
+      [this]()
+      {
+        std::lock_guard<std::mutex> lock(active_conflicts_mutex);
+        for (const auto& [_, n_opt] : active_conflicts._negotiations)
+        {
+          if (n_opt.has_value() && n_opt->keyframe_outdated)
+          {
+            publish_negotiation_states();
+            return;
+          }
+        }
+      });
+  }
+
+  int64_t conflict_check_threads =
+    get_parameter("conflict_check_threads").as_int();
+  if (conflict_check_threads <= 0)
+  {
+    conflict_check_threads =
+      std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  conflict_check_pool = std::make_unique<WorkerPool>(
+    static_cast<std::size_t>(conflict_check_threads));
+  RCLCPP_INFO(
+    get_logger(),
+    "Checking for conflicts with %lu threads",
+    conflict_check_pool->size());
 
   conflict_check_quit = false;
   conflict_check_thread = std::thread(
     [&]()
     {
       rmf_traffic::schedule::Mirror mirror;
+      ConflictBroadPhase broad_phase;
+      DependencyIndex dependency_index;
       const auto query_all = rmf_traffic::schedule::query_all();
 
       while (rclcpp::ok(get_node_options().context()) && !conflict_check_quit)
       {
         rmf_utils::optional<rmf_traffic::schedule::Patch> next_patch;
         rmf_traffic::schedule::Viewer::View view_changes;
+        std::optional<rmf_traffic::schedule::ParticipantDescriptionsMap>
+        participants;
 
-        // Use this scope to minimize how long we lock the database for
+        // Use this scope to minimize how long we lock the database for. We
+        // only take immutable snapshots of the changes while the database is
+        // locked. The mirror gets updated and analysed after the lock is
+        // released so that incoming itinerary updates are not held up.
         {
-          std::unique_lock<std::mutex> lock(database_mutex);
-          conflict_check_cv.wait_for(lock, std::chrono::milliseconds(100), [&]()
-          {
-            return !(database->latest_version() <= mirror.latest_version())
-            && !conflict_check_quit;
-          });
+          MeasuredLock lock(database_mutex, conflict_check_lock_metrics);
+          conflict_check_cv.wait_for(
+            lock.get(), std::chrono::milliseconds(100), [&]()
+            {
+              return !(database->latest_version() <= mirror.latest_version())
+              && !conflict_check_quit;
+            });
+          lock.restart_hold_timer();
 
           if ( (database->latest_version() == mirror.latest_version()
           && last_known_participants_version == current_participants_version)
@@ -501,43 +892,17 @@ void ScheduleNode::setup_conflict_topics_and_thread()
           if (last_known_participants_version != current_participants_version)
           {
             last_known_participants_version = current_participants_version;
-            rmf_traffic::schedule::ParticipantDescriptionsMap participants;
+            participants = rmf_traffic::schedule::ParticipantDescriptionsMap();
             for (const auto& id: database->participant_ids())
             {
-              participants.insert({id, *database->get_participant(id)});
-            }
-
-            try
-            {
-              mirror.update_participants_info(participants);
-            }
-            catch (const std::exception& e)
-            {
-              RCLCPP_ERROR(get_logger(), "%s", e.what());
+              participants->insert({id, *database->get_participant(id)});
             }
           }
 
           const auto last_checked_version = mirror.latest_version().value_or(0);
-          next_patch = database->changes(query_all, mirror.latest_version());
-          // TODO(MXG): Check whether the database really needs to remain locked
-          // during this update.
           try
           {
-            if (!mirror.update(*next_patch))
-            {
-              const std::string mirror_version = mirror.latest_version() ?
-              std::to_string(*mirror.latest_version()) : "none";
-              const std::string patch_base = next_patch->base_version() ?
-              std::to_string(*next_patch->base_version()) : "any";
-              RCLCPP_ERROR(
-                get_logger(),
-                "Failed to update conflict detection mirror. Mirror version: %s"
-                ", patch base: %s",
-                mirror_version.c_str(),
-                patch_base.c_str());
-              continue;
-            }
-
+            next_patch = database->changes(query_all, mirror.latest_version());
             view_changes = database->query(query_all, last_checked_version);
           }
           catch (const std::exception& e)
@@ -547,45 +912,50 @@ void ScheduleNode::setup_conflict_topics_and_thread()
           }
         }
 
-        auto conflicts = get_conflicts(view_changes, mirror);
-        for (ConflictSet& conflict : conflicts)
+        if (participants.has_value())
         {
-          // Collect all other participants that have dependencies on the ones
-          // conflicting before we open the negotiation.
-          std::vector<rmf_traffic::ParticipantId> queue;
-          for (const auto p : conflict)
-            queue.push_back(p);
-
-          while (!queue.empty())
+          try
           {
-            const auto check = queue.back();
-            queue.pop_back();
+            mirror.update_participants_info(*participants);
+          }
+          catch (const std::exception& e)
+          {
+            RCLCPP_ERROR(get_logger(), "%s", e.what());
+          }
+        }
 
-            for (const auto& p : mirror.participant_ids())
-            {
-              if (conflict.count(p) > 0)
-                continue;
-
-              const auto& itinerary = mirror.get_itinerary(p);
-              if (!itinerary.has_value())
-                continue;
-
-              for (const auto& r : *itinerary)
-              {
-                const auto d_it = r->dependencies().find(check);
-                const bool include = d_it != r->dependencies().end()
-                && d_it->second.plan().has_value();
-
-                if (include)
-                {
-                  queue.push_back(p);
-                  conflict.insert(p);
-                  break;
-                }
-              }
-            }
+        try
+        {
+          if (!mirror.update(*next_patch))
+          {
+            const std::string mirror_version = mirror.latest_version() ?
+              std::to_string(*mirror.latest_version()) : "none";
+            const std::string patch_base = next_patch->base_version() ?
+              std::to_string(*next_patch->base_version()) : "any";
+            RCLCPP_ERROR(
+              get_logger(),
+              "Failed to update conflict detection mirror. Mirror version: %s"
+              ", patch base: %s",
+              mirror_version.c_str(),
+              patch_base.c_str());
+            continue;
           }
         }
+        catch (const std::exception& e)
+        {
+          RCLCPP_ERROR(get_logger(), "%s", e.what());
+          continue;
+        }
+
+        broad_phase.update(view_changes, mirror);
+        auto conflicts = get_conflicts(
+          view_changes, mirror, broad_phase, conflict_check_pool.get());
+        dependency_index.update(view_changes, mirror);
+
+        // Collect all other participants that have dependencies on the ones
+        // conflicting before we open the negotiation.
+        for (ConflictSet& conflict : conflicts)
+          dependency_index.expand(conflict);
 
         std::unordered_map<Version, const Negotiation*> new_negotiations;
         for (const auto& conflict : conflicts)
@@ -622,10 +992,95 @@ void ScheduleNode::setup_conflict_topics_and_thread()
 }
 
 //==============================================================================
-void ScheduleNode::setup_cull_timer()
+void ScheduleNode::setup_cull_thread()
+{
+  // The first round of culling decides where to start from, based on the
+  // routes that are in the database by then.
+  last_cull_time = std::nullopt;
+
+  cull_thread = std::thread(
+    [this]()
+    {
+      std::unique_lock<std::mutex> lock(cull_mutex);
+      while (rclcpp::ok(get_node_options().context()))
+      {
+        cull_cv.wait_for(lock, cull_period, [&]() { return cull_quit; });
+        if (cull_quit)
+          return;
+
+        lock.unlock();
+        try
+        {
+          cull();
+        }
+        catch (const std::exception& e)
+        {
+          RCLCPP_ERROR(
+            get_logger(), "Error while culling the schedule: %s", e.what());
+        }
+        lock.lock();
+      }
+    });
+}
+
+//==============================================================================
+void ScheduleNode::setup_lock_metrics()
+{
+  const double period = get_parameter("lock_metrics_period").as_double();
+  if (period <= 0.0)
+    return;
+
+  lock_metrics_timer = create_wall_timer(
+    std::chrono::duration<double>(period),
+    [this]()
+    {
+      RCLCPP_INFO(
+        get_logger(),
+        "[database_mutex] conflict check: %s",
+        conflict_check_lock_metrics.summary().c_str());
+      RCLCPP_INFO(
+        get_logger(),
+        "[database_mutex] itinerary updates: %s",
+        itinerary_lock_metrics.summary().c_str());
+      RCLCPP_INFO(
+        get_logger(),
+        "[database_mutex] culling: %s",
+        cull_lock_metrics.summary().c_str());
+
+      conflict_check_lock_metrics.reset();
+      itinerary_lock_metrics.reset();
+      cull_lock_metrics.reset();
+    });
+}
+
+//==============================================================================
+void ScheduleNode::setup_cull_metrics()
 {
-  cull_timer = create_wall_timer(
-    std::chrono::minutes(1), [this]() { cull(); });
+  const double period = get_parameter("cull_metrics_period").as_double();
+  if (period <= 0.0)
+    return;
+
+  cull_metrics_timer = create_wall_timer(
+    std::chrono::duration<double>(period),
+    [this]()
+    {
+      const double lag = cull_lag_seconds.load();
+      const std::string report =
+        "[cull] " + std::to_string(culled_routes_since_report.exchange(0))
+        + " routes from " + std::to_string(
+          culled_buckets_since_report.exchange(0))
+        + " time buckets in " + std::to_string(
+          cull_rounds_since_report.exchange(0))
+        + " rounds since the last report (" + std::to_string(
+          culled_routes_total.load()) + " routes in total). Culling is "
+        + std::to_string(lag) + "s behind the retention horizon.";
+
+      // Only bother the operator when culling cannot keep up
+      if (lag > 0.0)
+        RCLCPP_INFO(get_logger(), "%s", report.c_str());
+      else
+        RCLCPP_DEBUG(get_logger(), "%s", report.c_str());
+    });
 }
 
 //==============================================================================
@@ -719,10 +1174,11 @@ void ScheduleNode::register_query(
 
   response->node_id = node_id;
 
-  // Search for an existing query with the same search parameters
+  // Search for an existing query with equivalent search parameters
+  const auto canonical = canonicalize(new_query);
   for (auto& [existing_query_id, existing_query] : registered_queries)
   {
-    if (existing_query.query == new_query)
+    if (existing_query.canonical == canonical)
     {
       RCLCPP_INFO(
         get_logger(),
@@ -789,12 +1245,16 @@ void ScheduleNode::register_query(
     query_id,
     QueryInfo{
       query,
+      canonicalize(query),
       std::move(update_publisher),
       std::nullopt,
       std::nullopt,
       std::chrono::steady_clock::now(),
       {}
     });
+
+  // Send the initial update for this query
+  schedule_mirror_update();
 }
 
 //==============================================================================
@@ -823,27 +1283,137 @@ void ScheduleNode::cleanup_queries()
   }
 
   if (any_erased)
+  {
+    prune_canonical_queries();
     broadcast_queries();
+  }
+}
+
+//==============================================================================
+auto ScheduleNode::canonicalize(const rmf_traffic::schedule::Query& query)
+-> CanonicalQueryPtr
+{
+  auto canonical = canonicalize_query(query);
+  const auto hash = hash_query(canonical);
+  auto& bucket = canonical_queries[hash];
+  for (const auto& existing : bucket)
+  {
+    if (existing->query == canonical)
+      return existing;
+  }
+
+  bucket.push_back(
+    std::make_shared<CanonicalQuery>(
+      CanonicalQuery{std::move(canonical), hash}));
+
+  return bucket.back();
+}
+
+//==============================================================================
+void ScheduleNode::prune_canonical_queries()
+{
+  auto it = canonical_queries.begin();
+  while (it != canonical_queries.end())
+  {
+    auto& bucket = it->second;
+    bucket.erase(
+      std::remove_if(bucket.begin(), bucket.end(),
+      [](const CanonicalQueryPtr& c) { return c.use_count() <= 1; }),
+      bucket.end());
+
+    if (bucket.empty())
+      canonical_queries.erase(it++);
+    else
+      ++it;
+  }
 }
 
 //==============================================================================
 void ScheduleNode::cull()
 {
   const auto time = rmf_traffic_ros2::convert(now());
+  const auto target = time - cull_retention_horizon;
+  if (!last_cull_time.has_value())
   {
-    // Cull unnecessary data from the schedule
-    std::lock_guard<std::mutex> lock(database_mutex);
+    // Start from the oldest route instead of the retention horizon, so that
+    // any history that was already in the schedule at startup or takeover
+    // gets culled one bucket at a time like everything else.
+    std::optional<rmf_traffic::Time> oldest;
+    {
+      MeasuredLock lock(database_mutex, cull_lock_metrics);
+      oldest = earliest_finish_time(*database);
+    }
+
+    last_cull_time = oldest.has_value() ? std::min(*oldest, target) : target;
+  }
+
+  // The routes are counted in their own lock sections, before and after the
+  // buckets, so that counting does not add to the time each bucket holds the
+  // database_mutex. Routes that arrive in between get netted out.
+  std::size_t routes_before = 0;
+  if (*last_cull_time < target)
+  {
+    MeasuredLock lock(database_mutex, cull_lock_metrics);
+    routes_before = count_routes(*database);
+  }
+
+  // Cull unnecessary data from the schedule, one bucket of time at a time.
+  // The database_mutex is released after each bucket so that itinerary
+  // updates can get through while we catch up on a large history.
+  std::size_t buckets = 0;
+  while (*last_cull_time < target && buckets < cull_max_buckets_per_tick)
+  {
+    const auto cutoff =
+      std::min(*last_cull_time + cull_bucket_duration, target);
+
+    MeasuredLock lock(database_mutex, cull_lock_metrics);
     database->set_current_time(time);
-    database->cull(time - std::chrono::hours(2));
+    database->cull(cutoff);
+    lock.unlock();
+
+    last_cull_time = cutoff;
+    ++buckets;
+  }
+
+  ++cull_rounds_since_report;
+  cull_lag_seconds = std::max(
+    0.0, rmf_traffic::time::to_seconds(target - *last_cull_time));
+
+  if (buckets > 0)
+  {
+    std::size_t routes_after = 0;
+    {
+      MeasuredLock lock(database_mutex, cull_lock_metrics);
+      routes_after = count_routes(*database);
+    }
+
+    const std::size_t routes =
+      routes_before - std::min(routes_before, routes_after);
+
+    schedule_mirror_update();
+    culled_buckets_total += buckets;
+    culled_buckets_since_report += buckets;
+    culled_routes_total += routes;
+    culled_routes_since_report += routes;
+
+    RCLCPP_DEBUG(
+      get_logger(),
+      "Culled %lu routes from %lu time buckets. The schedule now keeps %fs of "
+      "history.",
+      routes,
+      buckets,
+      rmf_traffic::time::to_seconds(time - *last_cull_time));
   }
 
   {
-    // Break out of negotiation waits that have hung up
+    // Break out of negotiation waits that have hung up. A wait or negotiation
+    // is only considered hung once it has been quiet for 30s, since this runs
+    // every cull_period.
     std::lock_guard<std::mutex> lock(active_conflicts_mutex);
     std::vector<std::size_t> cull_wait;
     for (const auto& [v, wait] : active_conflicts._waiting)
     {
-      if (wait.conclusion_time + std::chrono::seconds(30) > time)
+      if (wait.conclusion_time + std::chrono::seconds(30) < time)
       {
         cull_wait.push_back(v);
       }
@@ -864,7 +1434,7 @@ void ScheduleNode::cull()
       if (open.has_value())
       {
         // TODO(MXG): Make this deadline configurable
-        if (open->last_active_time + std::chrono::seconds(30) > time)
+        if (open->last_active_time + std::chrono::seconds(30) < time)
         {
           cull_negotiation.push_back(v);
         }
@@ -985,6 +1555,7 @@ void ScheduleNode::unregister_participant(
     auto version = database->itinerary_version(request->participant_id);
     database->clear(request->participant_id, version);
     response->confirmation = true;
+    schedule_mirror_update();
 
     RCLCPP_INFO(
       get_logger(),
@@ -1082,13 +1653,60 @@ void ScheduleNode::request_changes(
     }
 
     response->result = RequestChanges::Response::REQUEST_ACCEPTED;
+    schedule_mirror_update();
   }
 }
 
 //==============================================================================
 void ScheduleNode::itinerary_set(const ItinerarySet& set)
 {
-  std::unique_lock<std::mutex> lock(database_mutex);
+  MeasuredLock lock(database_mutex, itinerary_lock_metrics);
+  std::vector<ItineraryCheck> checks;
+  if (apply_itinerary_change(set, checks))
+    finish_itinerary_changes(checks);
+}
+
+//==============================================================================
+void ScheduleNode::itinerary_extend(const ItineraryExtend& extend)
+{
+  MeasuredLock lock(database_mutex, itinerary_lock_metrics);
+  std::vector<ItineraryCheck> checks;
+  if (apply_itinerary_change(extend, checks))
+    finish_itinerary_changes(checks);
+}
+
+//==============================================================================
+void ScheduleNode::itinerary_delay(const ItineraryDelay& delay)
+{
+  MeasuredLock lock(database_mutex, itinerary_lock_metrics);
+  std::vector<ItineraryCheck> checks;
+  if (apply_itinerary_change(delay, checks))
+    finish_itinerary_changes(checks);
+}
+
+//==============================================================================
+void ScheduleNode::itinerary_reached(const ItineraryReached& msg)
+{
+  MeasuredLock lock(database_mutex, itinerary_lock_metrics);
+  std::vector<ItineraryCheck> checks;
+  if (apply_itinerary_change(msg, checks))
+    finish_itinerary_changes(checks);
+}
+
+//==============================================================================
+void ScheduleNode::itinerary_clear(const ItineraryClear& clear)
+{
+  MeasuredLock lock(database_mutex, itinerary_lock_metrics);
+  std::vector<ItineraryCheck> checks;
+  if (apply_itinerary_change(clear, checks))
+    finish_itinerary_changes(checks);
+}
+
+//==============================================================================
+bool ScheduleNode::apply_itinerary_change(
+  const ItinerarySet& set,
+  std::vector<ItineraryCheck>& checks)
+{
   assert(!set.itinerary.empty());
   try
   {
@@ -1099,21 +1717,22 @@ void ScheduleNode::itinerary_set(const ItinerarySet& set)
       set.storage_base,
       set.itinerary_version);
 
-    publish_inconsistencies(set.participant);
-
-    std::lock_guard<std::mutex> lock2(active_conflicts_mutex);
-    active_conflicts.check(set.participant, set.itinerary_version);
+    checks.push_back({set.participant, set.itinerary_version});
+    return true;
   }
   catch (const std::exception& e)
   {
     RCLCPP_WARN(get_logger(), "Failed to set itinerary: %s", e.what());
   }
+
+  return false;
 }
 
 //==============================================================================
-void ScheduleNode::itinerary_extend(const ItineraryExtend& extend)
+bool ScheduleNode::apply_itinerary_change(
+  const ItineraryExtend& extend,
+  std::vector<ItineraryCheck>& checks)
 {
-  std::unique_lock<std::mutex> lock(database_mutex);
   try
   {
     database->extend(
@@ -1121,22 +1740,26 @@ void ScheduleNode::itinerary_extend(const ItineraryExtend& extend)
       rmf_traffic_ros2::convert(extend.routes),
       extend.itinerary_version);
 
-    publish_inconsistencies(extend.participant);
-
-    std::lock_guard<std::mutex> lock2(active_conflicts_mutex);
-    active_conflicts.check(
-      extend.participant, database->itinerary_version(extend.participant));
+    checks.push_back(
+      {
+        extend.participant,
+        database->itinerary_version(extend.participant)
+      });
+    return true;
   }
   catch (const std::exception& e)
   {
     RCLCPP_WARN(get_logger(), "Failed to extend itinerary: %s", e.what());
   }
+
+  return false;
 }
 
 //==============================================================================
-void ScheduleNode::itinerary_delay(const ItineraryDelay& delay)
+bool ScheduleNode::apply_itinerary_change(
+  const ItineraryDelay& delay,
+  std::vector<ItineraryCheck>& checks)
 {
-  std::unique_lock<std::mutex> lock(database_mutex);
   const auto duration = rmf_traffic::Duration(delay.delay);
 
   static const auto delay_limit = std::chrono::hours(1);
@@ -1152,7 +1775,7 @@ void ScheduleNode::itinerary_delay(const ItineraryDelay& delay)
       desc->owner().c_str(),
       rmf_traffic::time::to_seconds(delay_limit));
 
-    return;
+    return false;
   }
 
   try
@@ -1181,22 +1804,26 @@ void ScheduleNode::itinerary_delay(const ItineraryDelay& delay)
       duration,
       delay.itinerary_version);
 
-    publish_inconsistencies(delay.participant);
-
-    std::lock_guard<std::mutex> lock2(active_conflicts_mutex);
-    active_conflicts.check(
-      delay.participant, database->itinerary_version(delay.participant));
+    checks.push_back(
+      {
+        delay.participant,
+        database->itinerary_version(delay.participant)
+      });
+    return true;
   }
   catch (const std::exception& e)
   {
     RCLCPP_WARN(get_logger(), "Failed to delay itinerary: %s", e.what());
   }
+
+  return false;
 }
 
 //==============================================================================
-void ScheduleNode::itinerary_reached(const ItineraryReached& msg)
+bool ScheduleNode::apply_itinerary_change(
+  const ItineraryReached& msg,
+  std::vector<ItineraryCheck>&)
 {
-  std::unique_lock<std::mutex> lock(database_mutex);
   try
   {
     database->reached(
@@ -1207,32 +1834,99 @@ void ScheduleNode::itinerary_reached(const ItineraryReached& msg)
 
     // There is no risk of inconsistencies or conflicts occurring due to new
     // progress being reported, so we do not need to check for either.
+    return true;
   }
   catch (const std::exception& e)
   {
     RCLCPP_WARN(
       get_logger(), "Failed to update itinerary progress: %s", e.what());
   }
+
+  return false;
 }
 
 //==============================================================================
-void ScheduleNode::itinerary_clear(const ItineraryClear& clear)
+bool ScheduleNode::apply_itinerary_change(
+  const ItineraryClear& clear,
+  std::vector<ItineraryCheck>& checks)
 {
-  std::unique_lock<std::mutex> lock(database_mutex);
   try
   {
     database->clear(clear.participant, clear.itinerary_version);
 
-    publish_inconsistencies(clear.participant);
-
-    std::lock_guard<std::mutex> lock2(active_conflicts_mutex);
-    active_conflicts.check(
-      clear.participant, database->itinerary_version(clear.participant));
+    checks.push_back(
+      {
+        clear.participant,
+        database->itinerary_version(clear.participant)
+      });
+    return true;
   }
   catch (const std::exception& e)
   {
     RCLCPP_WARN(get_logger(), "Failed to clear itinerary: %s", e.what());
   }
+
+  return false;
+}
+
+//==============================================================================
+void ScheduleNode::finish_itinerary_changes(
+  const std::vector<ItineraryCheck>& checks)
+{
+  schedule_mirror_update();
+
+  // Only the latest inconsistencies of each participant need to be published
+  std::unordered_set<rmf_traffic::schedule::ParticipantId> published;
+  for (const auto& check : checks)
+  {
+    if (published.insert(check.participant).second)
+      publish_inconsistencies(check.participant);
+  }
+
+  if (checks.empty())
+    return;
+
+  std::lock_guard<std::mutex> lock(active_conflicts_mutex);
+  for (const auto& check : checks)
+    active_conflicts.check(check.participant, check.version);
+}
+
+//==============================================================================
+void ScheduleNode::queue_itinerary_change(ItineraryChange change)
+{
+  std::lock_guard<std::mutex> lock(itinerary_batch_mutex);
+  itinerary_batch.emplace_back(std::move(change));
+  if (itinerary_batch_timer->is_canceled())
+    itinerary_batch_timer->reset();
+}
+
+//==============================================================================
+void ScheduleNode::apply_itinerary_batch()
+{
+  std::vector<ItineraryChange> batch;
+  {
+    std::lock_guard<std::mutex> lock(itinerary_batch_mutex);
+    batch.swap(itinerary_batch);
+  }
+
+  if (batch.empty())
+    return;
+
+  // The changes of each participant are kept in the order they arrived in.
+  // Changes that arrive out of order are already handled by the database
+  // through the itinerary versions.
+  MeasuredLock lock(database_mutex, itinerary_lock_metrics);
+  std::vector<ItineraryCheck> checks;
+  bool changed = false;
+  for (const auto& change : batch)
+  {
+    changed |= std::visit(
+      [&](const auto& msg) { return apply_itinerary_change(msg, checks); },
+      change);
+  }
+
+  if (changed)
+    finish_itinerary_changes(checks);
 }
 
 //==============================================================================
@@ -1283,83 +1977,172 @@ void ScheduleNode::receive_startup_msg(const ScheduleId& msg)
 
     node_id.timestamp = now();
     startup_pub->publish(node_id);
+
+    // The cached mirror updates were stamped with the old node ID
+    std::lock_guard<std::mutex> lock(database_mutex);
+    mirror_update_cache.clear();
   }
 }
 
+//==============================================================================
+void ScheduleNode::schedule_mirror_update()
+{
+  if (mirror_update_timer->is_canceled())
+    mirror_update_timer->reset();
+}
+
 //==============================================================================
 void ScheduleNode::update_mirrors()
 {
-  for (auto& [query_id, query_info] : registered_queries)
+  // Registered queries that are equivalent and need changes starting from the
+  // same version will share a single cached update, so the patch only needs to
+  // be computed, converted and serialized once for each unique pair.
+  struct Publication
+  {
+    MirrorUpdateTopicPublisher publisher;
+    std::shared_ptr<CachedMirrorUpdate> update;
+  };
+  std::vector<Publication> publications;
+
   {
-    for (const auto request : query_info.remediation_requests)
+    std::unique_lock<std::mutex> lock(database_mutex);
+    const auto latest_version = database->latest_version();
+
+    // Cached updates that lead up to an older version of the database will not
+    // be requested again.
+    auto cache_it = mirror_update_cache.begin();
+    while (cache_it != mirror_update_cache.end())
+    {
+      if (std::get<2>(cache_it->first) != latest_version)
+        mirror_update_cache.erase(cache_it++);
+      else
+        ++cache_it;
+    }
+
+    const auto get_update = [&](
+      const CanonicalQueryPtr& query,
+      const VersionOpt base_version,
+      const bool is_remedial) -> std::shared_ptr<CachedMirrorUpdate>
+      {
+        const MirrorUpdateCacheKey key{
+          query->hash, base_version, latest_version, is_remedial};
+
+        const auto it = mirror_update_cache.find(key);
+        if (it != mirror_update_cache.end() && it->second->query == query)
+          return it->second;
+
+        auto update = std::make_shared<CachedMirrorUpdate>(
+          CachedMirrorUpdate{
+            query,
+            make_mirror_update(query->query, base_version, is_remedial),
+            nullptr
+          });
+
+        // If two different queries have the same hash then we simply won't
+        // cache the second one.
+        if (it == mirror_update_cache.end()
+          && mirror_update_cache.size() < mirror_update_cache_limit)
+        {
+          mirror_update_cache.insert({key, update});
+        }
+
+        return update;
+      };
+
+    for (auto& [query_id, query_info] : registered_queries)
     {
-      const auto updated = update_query(
-        query_info.publisher,
-        query_info.query,
-        request,
-        true);
+      for (const auto request : query_info.remediation_requests)
+      {
+        auto update = get_update(query_info.canonical, request, true);
+        if (update->msg)
+        {
+          publications.push_back({query_info.publisher, std::move(update)});
+
+          const std::string starting_from = request.has_value() ?
+            "version " + std::to_string(*request) : "the beginning";
+
+          RCLCPP_INFO(
+            get_logger(),
+            "[ScheduleNode::update_mirrors] Sending remedial update starting "
+            "from %s going to %lu for query %ld",
+            starting_from.c_str(),
+            latest_version,
+            query_id);
+        }
+      }
+      query_info.remediation_requests.clear();
+
+      if (query_info.last_checked_version == latest_version)
+        continue;
+
+      query_info.last_checked_version = latest_version;
+      auto update = get_update(
+        query_info.canonical, query_info.last_sent_version, false);
 
-      if (updated)
+      if (update->msg)
       {
-        const std::string starting_from = request.has_value() ?
-          "version " + std::to_string(*request) : "the beginning";
+        publications.push_back({query_info.publisher, std::move(update)});
 
-        RCLCPP_INFO(
+        // Update the latest version sent to this topic
+        query_info.last_sent_version = latest_version;
+
+        RCLCPP_DEBUG(
           get_logger(),
-          "[ScheduleNode::update_mirrors] Sending remedial update starting "
-          "from %s going to %lu for query %ld",
-          starting_from.c_str(),
-          database->latest_version(),
+          "[ScheduleNode::update_mirrors] Updated query [%ld]",
           query_id);
       }
     }
-    query_info.remediation_requests.clear();
-
-    if (query_info.last_checked_version == database->latest_version())
-      continue;
+  }
 
-    query_info.last_checked_version = database->latest_version();
-    const auto updated = update_query(
-      query_info.publisher,
-      query_info.query,
-      query_info.last_sent_version,
-      false);
+  // The messages are immutable snapshots, so they can be serialized and
+  // published without holding onto the database. Each message only gets
+  // serialized once no matter how many topics it gets published to. The
+  // intra-process transport does not accept serialized messages, so we fall
+  // back to publishing the message itself when it is enabled.
+  const bool publish_serialized =
+    !get_node_options().use_intra_process_comms();
 
-    if (updated)
+  for (const auto& publication : publications)
+  {
+    auto& update = *publication.update;
+    if (!publish_serialized)
     {
-      // Update the latest version sent to this topic
-      query_info.last_sent_version = database->latest_version();
+      publication.publisher->publish(*update.msg);
+      continue;
+    }
 
-      RCLCPP_DEBUG(
-        get_logger(),
-        "[ScheduleNode::update_mirrors] Updated query [%ld]",
-        query_id);
+    if (!update.serialized)
+    {
+      static const rclcpp::Serialization<MirrorUpdate> serializer;
+      auto serialized = std::make_shared<rclcpp::SerializedMessage>();
+      serializer.serialize_message(update.msg.get(), serialized.get());
+      update.serialized = std::move(serialized);
     }
+
+    publication.publisher->publish(*update.serialized);
   }
 
   conflict_check_cv.notify_all();
 }
 
 //==============================================================================
-bool ScheduleNode::update_query(
-  const MirrorUpdateTopicPublisher& publisher,
+auto ScheduleNode::make_mirror_update(
   const rmf_traffic::schedule::Query& query,
   VersionOpt last_sent_version,
-  bool is_remedial)
+  bool is_remedial) -> std::shared_ptr<const MirrorUpdate>
 {
   const auto patch = database->changes(query, last_sent_version);
 
   if (!is_remedial && patch.size() == 0 && !patch.cull())
-    return false;
+    return nullptr;
 
-  rmf_traffic_msgs::msg::MirrorUpdate msg;
-  msg.node_id = node_id;
-  msg.database_version = database->latest_version();
-  msg.patch = rmf_traffic_ros2::convert(patch);
-  msg.is_remedial_update = is_remedial;
-  publisher->publish(msg);
+  auto msg = std::make_shared<MirrorUpdate>();
+  msg->node_id = node_id;
+  msg->database_version = database->latest_version();
+  msg->patch = rmf_traffic_ros2::convert(patch);
+  msg->is_remedial_update = is_remedial;
 
-  return true;
+  return msg;
 }
 
 //==============================================================================
@@ -1445,6 +2228,8 @@ void ScheduleNode::refuse(std::size_t conflict_version)
   RCLCPP_INFO(get_logger(), "%s", output.c_str());
 
   active_conflicts.refuse(conflict_version);
+  if (standby)
+    return;
 
   ConflictConclusion conclusion;
   conclusion.conflict_version = conflict_version;
@@ -1488,18 +2273,25 @@ void ScheduleNode::receive_proposal(const ConflictProposal& msg)
     return;
   }
 
-  table->submit(
+  const bool updated = table->submit(
     msg.plan_id,
     rmf_traffic_ros2::convert(msg.itinerary),
     msg.proposal_version);
 
-  room.check_cache({});
+  if (updated)
+    open->changes.orphan_proposals.push_back(msg);
+
+  room.check_cache({}, &open->changes);
 
   // TODO(MXG): This should be removed once we have a negotiation visualizer
   rmf_traffic_ros2::schedule::print_negotiation_status(
     msg.conflict_version,
     negotiation);
-  open->update_state_msg(msg.conflict_version);
+  open->keyframe_outdated = true;
+
+  // A standby node waits for the primary node to announce the conclusion
+  if (standby)
+    return;
 
   if (negotiation.ready())
   {
@@ -1546,7 +2338,11 @@ void ScheduleNode::receive_proposal(const ConflictProposal& msg)
 //    print_conclusion(active_conflicts._waiting);
   }
 
-  publish_negotiation_states();
+  // The set of open negotiations only changes when one of them concludes
+  if (active_conflicts.negotiation(msg.conflict_version))
+    publish_negotiation_updates();
+  else
+    publish_negotiation_states();
 }
 
 //==============================================================================
@@ -1581,20 +2377,23 @@ void ScheduleNode::receive_rejection(const ConflictRejection& msg)
     return;
   }
 
-  table->reject(
+  const bool updated = table->reject(
     msg.table.back().version,
     msg.rejected_by,
     rmf_traffic_ros2::convert(msg.alternatives));
 
-  room.check_cache({});
+  if (updated)
+    open->changes.orphan_rejections.push_back(msg);
+
+  room.check_cache({}, &open->changes);
 
   // TODO(MXG): This should be removed once we have a negotiation visualizer
   rmf_traffic_ros2::schedule::print_negotiation_status(
     msg.conflict_version,
     negotiation);
-  open->update_state_msg(msg.conflict_version);
+  open->keyframe_outdated = true;
 
-  publish_negotiation_states();
+  publish_negotiation_updates();
 }
 
 //==============================================================================
@@ -1629,14 +2428,22 @@ void ScheduleNode::receive_forfeit(const ConflictForfeit& msg)
     return;
   }
 
-  table->forfeit(msg.table.back().version);
-  room.check_cache({});
+  const bool updated = table->forfeit(msg.table.back().version);
+
+  if (updated)
+    open->changes.orphan_forfeits.push_back(msg);
+
+  room.check_cache({}, &open->changes);
 
   // TODO(MXG): This should be removed once we have a negotiation visualizer
   rmf_traffic_ros2::schedule::print_negotiation_status(
     msg.conflict_version,
     negotiation);
-  open->update_state_msg(msg.conflict_version);
+  open->keyframe_outdated = true;
+
+  // A standby node waits for the primary node to announce the conclusion
+  if (standby)
+    return;
 
   if (negotiation.complete())
   {
@@ -1655,27 +2462,218 @@ void ScheduleNode::receive_forfeit(const ConflictForfeit& msg)
 //    print_conclusion(active_conflicts._waiting);
   }
 
-  publish_negotiation_states();
+  // The set of open negotiations only changes when one of them concludes
+  if (active_conflicts.negotiation(msg.conflict_version))
+    publish_negotiation_updates();
+  else
+    publish_negotiation_states();
 }
 
 //==============================================================================
 void ScheduleNode::publish_negotiation_states()
 {
+  if (standby)
+    return;
+
   NegotiationStates states;
   NegotiationStatuses statuses;
-  for (const auto& [_, n_opt] : active_conflicts._negotiations)
+  for (auto& [version, n_opt] : active_conflicts._negotiations)
+  {
+    if (!n_opt.has_value())
+      continue;
+
+    if (n_opt->keyframe_outdated)
+      n_opt->update_state_msg(version);
+
+    // The keyframe already contains any changes that were waiting to go out
+    n_opt->changes = rmf_traffic_msgs::msg::NegotiationState();
+
+    states.negotiations.push_back(n_opt->room.state_msg);
+    statuses.negotiations.push_back(make_negotiation_status(version, *n_opt));
+  }
+
+  negotiation_states_pub->publish(states);
+  negotiation_stasuses_pub->publish(statuses);
+}
+
+//==============================================================================
+void ScheduleNode::publish_negotiation_updates()
+{
+  if (standby)
+    return;
+
+  NegotiationStates updates;
+  NegotiationStatuses statuses;
+  for (auto& [version, n_opt] : active_conflicts._negotiations)
   {
-    if (n_opt.has_value())
+    if (!n_opt.has_value())
+      continue;
+
+    auto status = make_negotiation_status(version, *n_opt);
+    statuses.negotiations.push_back(status);
+
+    auto& changes = n_opt->changes;
+    if (changes.orphan_proposals.empty()
+      && changes.orphan_rejections.empty()
+      && changes.orphan_forfeits.empty())
     {
-      states.negotiations.push_back(n_opt->room.state_msg);
-      statuses.negotiations.push_back(n_opt->room.state_msg.status);
+      continue;
     }
+
+    changes.status = std::move(status);
+    updates.negotiations.push_back(std::move(changes));
+    changes = rmf_traffic_msgs::msg::NegotiationState();
   }
 
-  negotiation_states_pub->publish(states);
+  if (!updates.negotiations.empty())
+    negotiation_state_updates_pub->publish(updates);
+
   negotiation_stasuses_pub->publish(statuses);
 }
 
+//==============================================================================
+void ScheduleNode::setup_standby(MirrorManager mirror)
+{
+  standby = true;
+  standby_mirror = std::move(mirror);
+
+  const auto negotiation_qos = rclcpp::ServicesQoS()
+    .reliable()
+    .keep_last(1000);
+
+  standby_notice_sub = create_subscription<ConflictNotice>(
+    rmf_traffic_ros2::NegotiationNoticeTopicName, negotiation_qos,
+    [&](const ConflictNotice::UniquePtr msg)
+    {
+      this->replicate_notice(*msg);
+    });
+
+  standby_conclusion_sub = create_subscription<ConflictConclusion>(
+    rmf_traffic_ros2::NegotiationConclusionTopicName, negotiation_qos,
+    [&](const ConflictConclusion::UniquePtr msg)
+    {
+      this->replicate_conclusion(*msg);
+    });
+
+  // The messages from the negotiating participants are handled the same way
+  // that the primary node handles them, except that nothing gets published
+  // while the node is on standby.
+  setup_negotiation_subscriptions(negotiation_qos);
+
+  // Participants that are waiting to update their itineraries after a
+  // negotiation are released when the update arrives. The itineraries
+  // themselves arrive through the mirror.
+  const auto check = [this](
+    const ParticipantId participant,
+    const ItineraryVersion version)
+    {
+      std::lock_guard<std::mutex> lock(active_conflicts_mutex);
+      active_conflicts.check(participant, version);
+    };
+
+  const auto itinerary_qos =
+    rclcpp::SystemDefaultsQoS()
+    .reliable()
+    .keep_last(100);
+
+  itinerary_set_sub = create_subscription<ItinerarySet>(
+    rmf_traffic_ros2::ItinerarySetTopicName, itinerary_qos,
+    [check](const ItinerarySet::UniquePtr msg)
+    {
+      check(msg->participant, msg->itinerary_version);
+    });
+
+  itinerary_extend_sub = create_subscription<ItineraryExtend>(
+    rmf_traffic_ros2::ItineraryExtendTopicName, itinerary_qos,
+    [check](const ItineraryExtend::UniquePtr msg)
+    {
+      check(msg->participant, msg->itinerary_version);
+    });
+
+  itinerary_delay_sub = create_subscription<ItineraryDelay>(
+    rmf_traffic_ros2::ItineraryDelayTopicName, itinerary_qos,
+    [check](const ItineraryDelay::UniquePtr msg)
+    {
+      check(msg->participant, msg->itinerary_version);
+    });
+
+  itinerary_clear_sub = create_subscription<ItineraryClear>(
+    rmf_traffic_ros2::ItineraryClearTopicName, itinerary_qos,
+    [check](const ItineraryClear::UniquePtr msg)
+    {
+      check(msg->participant, msg->itinerary_version);
+    });
+
+  RCLCPP_INFO(get_logger(), "Standing by to take over the traffic schedule");
+}
+
+//==============================================================================
+void ScheduleNode::replicate_notice(const ConflictNotice& msg)
+{
+  if (!standby || !standby_mirror.has_value())
+    return;
+
+  const auto viewer = standby_mirror->snapshots();
+  const std::vector<ParticipantId> participants(
+    msg.participants.begin(), msg.participants.end());
+
+  std::lock_guard<std::mutex> lock(active_conflicts_mutex);
+  active_conflicts.replicate(
+    msg.conflict_version,
+    participants,
+    rmf_traffic_ros2::convert(now()),
+    *viewer);
+}
+
+//==============================================================================
+void ScheduleNode::replicate_conclusion(const ConflictConclusion& msg)
+{
+  if (!standby)
+    return;
+
+  // If the negotiation was refused then our record of it has already been
+  // removed by receive_refusal(~).
+  std::lock_guard<std::mutex> lock(active_conflicts_mutex);
+  active_conflicts.conclude(
+    msg.conflict_version, rmf_traffic_ros2::convert(now()));
+}
+
+//==============================================================================
+void ScheduleNode::take_over(const QueryMap& queries)
+{
+  const auto start = std::chrono::steady_clock::now();
+  standby_notice_sub.reset();
+  standby_conclusion_sub.reset();
+
+  if (standby_mirror.has_value())
+  {
+    database = std::make_shared<rmf_traffic::schedule::Database>(
+      standby_mirror->fork());
+    standby_mirror.reset();
+  }
+
+  // Make sure that every mirror sees us as the newest schedule node
+  node_id.timestamp = now();
+  standby = false;
+
+  setup(queries);
+
+  std::size_t negotiations = 0;
+  {
+    std::lock_guard<std::mutex> lock(active_conflicts_mutex);
+    negotiations = active_conflicts._negotiations.size();
+  }
+
+  RCLCPP_INFO(
+    get_logger(),
+    "Took over the traffic schedule at version %lu with %lu open "
+    "negotiations in %.1fms",
+    database->latest_version(),
+    negotiations,
+    std::chrono::duration<double, std::milli>(
+      std::chrono::steady_clock::now() - start).count());
+}
+
 std::shared_ptr<rclcpp::Node> make_node(const rclcpp::NodeOptions& options)
 {
   return std::make_shared<ScheduleNode>(options);
@@ -0,0 +1,142 @@
+/*
+ * Copyright (C) 2022 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include "internal_WorkerPool.hpp"
+
+namespace rmf_traffic_ros2 {
+namespace schedule {
+
+//==============================================================================
+WorkerPool::WorkerPool(const std::size_t num_threads)
+{
+  for (std::size_t i = 1; i < num_threads; ++i)
+  {
+    _threads.emplace_back(
+      [this]()
+      {
+        uint64_t last_generation = 0;
+        while (true)
+        {
+          std::unique_lock<std::mutex> lock(_mutex);
+          _start_cv.wait(lock, [&]()
+          {
+            return _quit || _generation != last_generation;
+          });
+
+          if (_quit)
+            return;
+
+          last_generation = _generation;
+          const auto* const job = _job;
+          const auto count = _count;
+          lock.unlock();
+
+          _work(*job, count);
+
+          lock.lock();
+          if (--_busy == 0)
+            _done_cv.notify_all();
+        }
+      });
+  }
+}
+
+//==============================================================================
+std::size_t WorkerPool::size() const
+{
+  return _threads.size() + 1;
+}
+
+//==============================================================================
+void WorkerPool::parallel_for(
+  const std::size_t count,
+  const std::function<void(std::size_t)>& job)
+{
+  if (_threads.empty() || count < 2)
+  {
+    for (std::size_t i = 0; i < count; ++i)
+      job(i);
+
+    return;
+  }
+
+  std::unique_lock<std::mutex> lock(_mutex);
+  _job = &job;
+  _count = count;
+  _next = 0;
+  _busy = _threads.size();
+  _exception = nullptr;
+  ++_generation;
+  lock.unlock();
+  _start_cv.notify_all();
+
+  _work(job, count);
+
+  lock.lock();
+  _done_cv.wait(lock, [&]() { return _busy == 0; });
+  _job = nullptr;
+
+  if (_exception)
+  {
+    auto e = _exception;
+    _exception = nullptr;
+    std::rethrow_exception(e);
+  }
+}
+
+//==============================================================================
+WorkerPool::~WorkerPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _quit = true;
+  }
+  _start_cv.notify_all();
+
+  for (auto& thread : _threads)
+  {
+    if (thread.joinable())
+      thread.join();
+  }
+}
+
+//==============================================================================
+void WorkerPool::_work(
+  const std::function<void(std::size_t)>& job,
+  const std::size_t count)
+{
+  while (true)
+  {
+    const std::size_t i = _next.fetch_add(1);
+    if (i >= count)
+      return;
+
+    try
+    {
+      job(i);
+    }
+    catch (...)
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      if (!_exception)
+        _exception = std::current_exception();
+    }
+  }
+}
+
+} // namespace schedule
+} // namespace rmf_traffic_ros2
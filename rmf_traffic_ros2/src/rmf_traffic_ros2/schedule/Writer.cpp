@@ -35,6 +35,12 @@
 
 #include <rmf_utils/RateLimiter.hpp>
 
+#include <deque>
+#include <exception>
+#include <functional>
+#include <map>
+#include <mutex>
+
 using namespace std::chrono_literals;
 
 namespace rmf_traffic_ros2 {
@@ -303,6 +309,45 @@ public:
 
     std::weak_ptr<rclcpp::Node> weak_node;
 
+    // Participant registrations wait in this queue until the register service
+    // is ready. At most max_registrations_in_flight of them are sent to the
+    // schedule node at a time, and their responses are received by whatever
+    // spins the node, so no threads are left blocking on the service.
+    using RegisterResponse = Register::Response;
+    struct PendingRegistration
+    {
+      rmf_traffic::schedule::ParticipantDescription description;
+
+      // Triggered with the registration that the schedule node assigned
+      std::function<void(Registration)> on_registered;
+
+      // Triggered if the participant could not be registered
+      std::function<void(std::exception_ptr)> on_error;
+    };
+
+    std::mutex registration_mutex;
+    std::deque<PendingRegistration> registration_queue;
+    std::map<uint64_t, PendingRegistration> registrations_in_flight;
+    uint64_t next_registration_id = 0;
+    std::size_t max_registrations_in_flight = 16;
+    rclcpp::TimerBase::SharedPtr registration_retry_timer;
+    rclcpp::OnShutdownCallbackHandle shutdown_handle;
+
+    // The registration that finish_participant() is handing to the participant
+    // that it is constructing on this thread. The participant asks for it
+    // through register_participant(~) while it is being constructed.
+    static inline thread_local const Registration* handed_registration =
+      nullptr;
+
+    using CompletionExecutor = std::function<void(std::function<void()>)>;
+    CompletionExecutor completion_executor;
+
+    // Itinerary messages that are waiting to be published together. This is
+    // only used while batching is turned on.
+    std::mutex batch_mutex;
+    std::vector<std::function<void()>> batch;
+    rclcpp::TimerBase::SharedPtr batch_timer;
+
     static std::shared_ptr<Transport> make(
       const std::shared_ptr<rclcpp::Node>& node)
     {
@@ -334,6 +379,12 @@ public:
         itinerary_qos);
 
       transport->context = node->get_node_options().context();
+      transport->shutdown_handle = transport->context->add_on_shutdown_callback(
+        [w = transport->weak_from_this()]()
+        {
+          if (const auto self = w.lock())
+            self->fail_registrations();
+        });
 
       transport->register_client =
         node->create_client<Register>(RegisterParticipantSrvName);
@@ -377,6 +428,61 @@ public:
       return transport;
     }
 
+    template<typename Msg>
+    void publish(
+      const typename rclcpp::Publisher<Msg>::SharedPtr& pub,
+      Msg msg)
+    {
+      std::unique_lock<std::mutex> lock(batch_mutex);
+      if (!batch_timer)
+      {
+        lock.unlock();
+        pub->publish(msg);
+        return;
+      }
+
+      batch.push_back([pub, msg = std::move(msg)]() { pub->publish(msg); });
+    }
+
+    void flush_batch()
+    {
+      // The messages are published while the mutex is locked so that they
+      // cannot get ahead of each other.
+      std::lock_guard<std::mutex> lock(batch_mutex);
+      for (const auto& publish_msg : batch)
+        publish_msg();
+
+      batch.clear();
+    }
+
+    void set_batching(std::optional<rmf_traffic::Duration> period)
+    {
+      const auto node = weak_node.lock();
+
+      std::lock_guard<std::mutex> lock(batch_mutex);
+      if (batch_timer)
+      {
+        batch_timer->cancel();
+        batch_timer = nullptr;
+      }
+
+      for (const auto& publish_msg : batch)
+        publish_msg();
+
+      batch.clear();
+
+      if (!period.has_value() || !node)
+        return;
+
+      batch_timer = node->create_wall_timer(
+        *period,
+        [w = weak_from_this()]()
+        {
+          if (const auto self = w.lock())
+            self->flush_batch();
+        });
+    }
+
     void set(
       const rmf_traffic::schedule::ParticipantId participant,
       const PlanId plan,
@@ -384,7 +490,8 @@ public:
       const StorageId storage,
       const rmf_traffic::schedule::ItineraryVersion version) final
     {
-      set_pub->publish(
+      publish(
+        set_pub,
         rmf_traffic_msgs::build<Set>()
         .participant(participant)
         .plan(plan)
@@ -398,7 +505,8 @@ public:
       const Itinerary& routes,
       const rmf_traffic::schedule::ItineraryVersion version) final
     {
-      extend_pub->publish(
+      publish(
+        extend_pub,
         rmf_traffic_msgs::build<Extend>()
         .participant(participant)
         .routes(convert(routes))
@@ -410,7 +518,8 @@ public:
       const rmf_traffic::Duration duration,
       const rmf_traffic::schedule::ItineraryVersion version) final
     {
-      delay_pub->publish(
+      publish(
+        delay_pub,
         rmf_traffic_msgs::build<Delay>()
         .participant(participant)
         .delay(duration.count())
@@ -423,7 +532,8 @@ public:
       const std::vector<CheckpointId>& reached_checkpoints,
       const ProgressVersion version) final
     {
-      reached_pub->publish(
+      publish(
+        reached_pub,
         rmf_traffic_msgs::build<Reached>()
         .participant(participant)
         .plan(plan)
@@ -435,7 +545,8 @@ public:
       const rmf_traffic::schedule::ParticipantId participant,
       const rmf_traffic::schedule::ItineraryVersion version) final
     {
-      clear_pub->publish(
+      publish(
+        clear_pub,
         rmf_traffic_msgs::build<Clear>()
         .participant(participant)
         .itinerary_version(version));
@@ -446,6 +557,15 @@ public:
     {
       using namespace std::chrono_literals;
 
+      // Participants that were queued up by make_participant(~) have already
+      // been registered by the time they get constructed.
+      if (handed_registration)
+      {
+        const auto registration = *handed_registration;
+        handed_registration = nullptr;
+        return registration;
+      }
+
       auto request = std::make_shared<Register::Request>();
       request->description = convert(participant_info);
 
@@ -495,6 +615,170 @@ public:
       register_client->async_send_request(std::move(request), std::move(cb));
     }
 
+    void queue_registration(PendingRegistration registration)
+    {
+      {
+        std::lock_guard<std::mutex> lock(registration_mutex);
+        registration_queue.push_back(std::move(registration));
+      }
+
+      dispatch_registrations();
+    }
+
+    static std::exception_ptr make_teardown_error()
+    {
+      // *INDENT-OFF*
+      return std::make_exception_ptr(
+        std::runtime_error(
+          "[rmf_traffic_ros2::schedule::Writer] Tearing down while waiting "
+          "for a schedule participant to finish registering"));
+      // *INDENT-ON*
+    }
+
+    // Fail every registration that is still waiting, because the context is
+    // shutting down and no response will ever arrive for them.
+    void fail_registrations()
+    {
+      std::vector<PendingRegistration> failed;
+      {
+        std::lock_guard<std::mutex> lock(registration_mutex);
+        if (registration_retry_timer)
+        {
+          registration_retry_timer->cancel();
+          registration_retry_timer = nullptr;
+        }
+
+        for (auto& r : registration_queue)
+          failed.push_back(std::move(r));
+        registration_queue.clear();
+
+        for (auto& [_, r] : registrations_in_flight)
+          failed.push_back(std::move(r));
+        registrations_in_flight.clear();
+      }
+
+      const auto error = make_teardown_error();
+      for (const auto& r : failed)
+        r.on_error(error);
+    }
+
+    void dispatch_registrations()
+    {
+      if (!rclcpp::ok(context))
+      {
+        fail_registrations();
+        return;
+      }
+
+      std::lock_guard<std::mutex> lock(registration_mutex);
+      if (registration_queue.empty())
+      {
+        registration_retry_timer = nullptr;
+        return;
+      }
+
+      if (!register_client->service_is_ready())
+      {
+        // Try again once the schedule node might be available
+        if (!registration_retry_timer)
+        {
+          const auto node = weak_node.lock();
+          if (!node)
+            return;
+
+          registration_retry_timer = node->create_wall_timer(
+            100ms,
+            [w = weak_from_this()]()
+            {
+              if (const auto self = w.lock())
+                self->dispatch_registrations();
+            });
+        }
+
+        return;
+      }
+
+      registration_retry_timer = nullptr;
+      while (!registration_queue.empty()
+        && registrations_in_flight.size() < max_registrations_in_flight)
+      {
+        const auto id = next_registration_id++;
+        auto request = std::make_shared<Register::Request>();
+        request->description = convert(registration_queue.front().description);
+        registrations_in_flight.insert(
+          {id, std::move(registration_queue.front())});
+        registration_queue.pop_front();
+
+        register_client->async_send_request(
+          std::move(request),
+          [w = weak_from_this(), id](
+            const rclcpp::Client<Register>::SharedFuture response_future)
+          {
+            if (const auto self = w.lock())
+              self->receive_registration(id, response_future.get());
+          });
+      }
+    }
+
+    void receive_registration(
+      const uint64_t id,
+      const std::shared_ptr<RegisterResponse>& response)
+    {
+      std::optional<PendingRegistration> pending;
+      CompletionExecutor executor;
+      {
+        std::lock_guard<std::mutex> lock(registration_mutex);
+        const auto it = registrations_in_flight.find(id);
+        if (it == registrations_in_flight.end())
+        {
+          // This request was queued up again when the services reconnected,
+          // or it was failed because the context is shutting down.
+          return;
+        }
+
+        pending = std::move(it->second);
+        registrations_in_flight.erase(it);
+        executor = completion_executor;
+      }
+
+      // Make room for the next registrations before finishing this one
+      dispatch_registrations();
+
+      std::function<void()> work;
+      if (response->error.empty())
+      {
+        work = [on_registered = std::move(pending->on_registered),
+            registration = convert(*response)]()
+          {
+            on_registered(registration);
+          };
+      }
+      else
+      {
+        // *INDENT-OFF*
+        const auto error = std::make_exception_ptr(
+          std::runtime_error(
+            "[rmf_traffic_ros2::schedule::Writer] Error while attempting to "
+            "register a participant: " + response->error));
+        // *INDENT-ON*
+        work = [on_error = std::move(pending->on_error), error]()
+          {
+            on_error(error);
+          };
+      }
+
+      if (executor)
+        executor(std::move(work));
+      else
+        work();
+    }
+
+    void set_completion_executor(CompletionExecutor executor)
+    {
+      std::lock_guard<std::mutex> lock(registration_mutex);
+      completion_executor = std::move(executor);
+    }
+
     void update_description(
       rmf_traffic::schedule::ParticipantId,
       rmf_traffic::schedule::ParticipantDescription participant_info)
@@ -536,11 +820,25 @@ public:
       RCLCPP_INFO(
         node->get_logger(),
         "Reconnecting services for Writer::Transport");
-      // Deleting the old services will shut them down
-      register_client =
-        node->create_client<Register>(RegisterParticipantSrvName);
+      {
+        // Deleting the old services will shut them down, so any registrations
+        // that were waiting for a response need to be sent again.
+        std::lock_guard<std::mutex> lock(registration_mutex);
+        register_client =
+          node->create_client<Register>(RegisterParticipantSrvName);
+
+        for (auto it = registrations_in_flight.rbegin();
+          it != registrations_in_flight.rend(); ++it)
+        {
+          registration_queue.push_front(std::move(it->second));
+        }
+        registrations_in_flight.clear();
+      }
+
       unregister_client =
         node->create_client<Unregister>(UnregisterParticipantSrvName);
+
+      dispatch_registrations();
     }
 
     void validate_participant_information(
@@ -577,6 +875,12 @@ public:
       }
     }
 
+    ~Transport()
+    {
+      if (context)
+        context->remove_on_shutdown_callback(shutdown_handle);
+    }
+
   private:
     Transport(const std::shared_ptr<rclcpp::Node>& node)
     : rectifier_factory(std::make_shared<RectifierFactory>()),
@@ -594,30 +898,38 @@ public:
 
   std::shared_ptr<Transport> transport;
 
+  using Registration = rmf_traffic::schedule::Writer::Registration;
+
+  // Participants are constructed once their registration has arrived, so
+  // constructing them will not block on the register service.
   std::future<rmf_traffic::schedule::Participant> make_participant(
     rmf_traffic::schedule::ParticipantDescription description)
   {
-    // TODO(MXG): This implementation assumes that the async promise will be
-    // finished before the Writer instance is destructed. If that is not true,
-    // then we could get undefined behavior from this implementation. However,
-    // the Writer should only get destructed during the teardown of the whole
-    // Node, which implies that the program is exiting.
-    //
-    // This shouldn't be a major concern, but it may be worth revisiting whether
-    // a cleaner approach is possible.
-
-    std::promise<rmf_traffic::schedule::Participant> promise;
-    auto future = promise.get_future();
-    std::thread worker(
-      [this](
-        rmf_traffic::schedule::ParticipantDescription description,
-        std::promise<rmf_traffic::schedule::Participant> promise)
-      {
-        promise.set_value(rmf_traffic::schedule::make_participant(
-          std::move(description), transport, transport->rectifier_factory));
-      }, std::move(description), std::move(promise));
-
-    worker.detach();
+    auto promise =
+      std::make_shared<std::promise<rmf_traffic::schedule::Participant>>();
+    auto future = promise->get_future();
+
+    transport->queue_registration(
+      Transport::PendingRegistration{
+        description,
+        [w = std::weak_ptr<Transport>(transport), description, promise](
+          const Registration& registration)
+        {
+          try
+          {
+            promise->set_value(
+              finish_participant(w, description, registration));
+          }
+          catch (...)
+          {
+            promise->set_exception(std::current_exception());
+          }
+        },
+        [promise](std::exception_ptr error)
+        {
+          promise->set_exception(std::move(error));
+        }
+      });
 
     return future;
   }
@@ -626,24 +938,85 @@ public:
     rmf_traffic::schedule::ParticipantDescription description,
     std::function<void(rmf_traffic::schedule::Participant)> ready_callback)
   {
-    std::thread worker(
-      [description = std::move(description),
-      this,
-      ready_callback = std::move(ready_callback)]()
+    const auto log_error =
+      [w = std::weak_ptr<Transport>(transport), description](
+      const std::exception_ptr& error)
       {
-        // TODO(MXG): We could probably make an implementation of the
-        // RectifierFactory that allows us to pass the ready_callback along to
-        // the service call so that it gets triggered when the service response
-        // is received. That way we don't need to create an additional thread
-        // here and worry about the threat of race conditions.
-        auto participant = rmf_traffic::schedule::make_participant(
-          std::move(description), transport, transport->rectifier_factory);
-
-        if (ready_callback)
-          ready_callback(std::move(participant));
+        const auto transport = w.lock();
+        const auto node = transport ? transport->weak_node.lock() : nullptr;
+        if (!node)
+          return;
+
+        try
+        {
+          std::rethrow_exception(error);
+        }
+        catch (const std::exception& e)
+        {
+          RCLCPP_ERROR(
+            node->get_logger(),
+            "[rmf_traffic_ros2::schedule::Writer] Failed to make participant "
+            "[%s] of [%s]: %s",
+            description.name().c_str(),
+            description.owner().c_str(),
+            e.what());
+        }
+      };
+
+    transport->queue_registration(
+      Transport::PendingRegistration{
+        description,
+        [w = std::weak_ptr<Transport>(transport), description, log_error,
+        ready_callback = std::move(ready_callback)](
+          const Registration& registration)
+        {
+          std::optional<rmf_traffic::schedule::Participant> participant;
+          try
+          {
+            participant.emplace(
+              finish_participant(w, description, registration));
+          }
+          catch (...)
+          {
+            log_error(std::current_exception());
+            return;
+          }
+
+          if (ready_callback)
+            ready_callback(std::move(*participant));
+        },
+        log_error
       });
+  }
+
+  static rmf_traffic::schedule::Participant finish_participant(
+    const std::weak_ptr<Transport>& w,
+    rmf_traffic::schedule::ParticipantDescription description,
+    const Registration& registration)
+  {
+    const auto transport = w.lock();
+    if (!transport)
+    {
+      // *INDENT-OFF*
+      throw std::runtime_error(
+        "[rmf_traffic_ros2::schedule::Writer] The writer was destroyed while "
+        "a participant was being registered");
+      // *INDENT-ON*
+    }
 
-    worker.detach();
+    // The participant will ask the transport for its registration while it is
+    // being constructed, so we hand it over for the duration of the call.
+    Transport::handed_registration = &registration;
+    struct Reset
+    {
+      ~Reset()
+      {
+        Transport::handed_registration = nullptr;
+      }
+    } reset;
+
+    return rmf_traffic::schedule::make_participant(
+      std::move(description), transport, transport->rectifier_factory);
   }
 };
 
@@ -700,6 +1073,19 @@ void Writer::async_make_participant(
     std::move(description), std::move(ready_callback));
 }
 
+//==============================================================================
+void Writer::set_completion_executor(CompletionExecutor executor)
+{
+  _pimpl->transport->set_completion_executor(std::move(executor));
+}
+
+//==============================================================================
+void Writer::set_itinerary_batching(
+  std::optional<rmf_traffic::Duration> period)
+{
+  _pimpl->transport->set_batching(period);
+}
+
 //==============================================================================
 Writer::Writer()
 {
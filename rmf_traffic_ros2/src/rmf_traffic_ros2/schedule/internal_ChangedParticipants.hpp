@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2022 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SRC__RMF_TRAFFIC_ROS2__SCHEDULE__INTERNAL_CHANGEDPARTICIPANTS_HPP
+#define SRC__RMF_TRAFFIC_ROS2__SCHEDULE__INTERNAL_CHANGEDPARTICIPANTS_HPP
+
+#include <rmf_traffic/schedule/Viewer.hpp>
+
+#include <unordered_set>
+#include <vector>
+
+namespace rmf_traffic_ros2 {
+namespace schedule {
+
+//==============================================================================
+/// The participants that an index of the schedule needs to act on after the
+/// viewer it is built from has received some changes.
+struct ChangedParticipants
+{
+  /// Participants whose itineraries need to be indexed again
+  std::unordered_set<rmf_traffic::schedule::ParticipantId> changed;
+
+  /// Participants that are indexed but no longer exist in the viewer
+  std::vector<rmf_traffic::schedule::ParticipantId> stale;
+};
+
+//==============================================================================
+/// Find out which participants of an index have changed.
+///
+/// \param[in] view_changes
+///   The changes that the viewer has just received.
+///
+/// \param[in] viewer
+///   The viewer that the index is built from.
+///
+/// \param[in] indexed
+///   A map from each indexed participant to what the index holds for it.
+///
+/// \param[in] indexed_size
+///   Gets the number of routes that the index holds for an entry of indexed.
+template<typename IndexedMap, typename GetSize>
+ChangedParticipants find_changed_participants(
+  const rmf_traffic::schedule::Viewer::View& view_changes,
+  const rmf_traffic::schedule::ItineraryViewer& viewer,
+  const IndexedMap& indexed,
+  GetSize indexed_size)
+{
+  ChangedParticipants result;
+  for (const auto& vc : view_changes)
+    result.changed.insert(vc.participant);
+
+  const auto& participants = viewer.participant_ids();
+  for (const auto& [participant, entry] : indexed)
+  {
+    if (result.changed.count(participant) > 0)
+      continue;
+
+    if (participants.count(participant) == 0)
+    {
+      result.stale.push_back(participant);
+      continue;
+    }
+
+    // Routes can disappear from an itinerary without showing up in the view of
+    // changes, e.g. when the itinerary gets cleared or culled.
+    const auto itinerary = viewer.get_itinerary(participant);
+    if (!itinerary.has_value() || itinerary->size() != indexed_size(entry))
+      result.changed.insert(participant);
+  }
+
+  return result;
+}
+
+} // namespace schedule
+} // namespace rmf_traffic_ros2
+
+#endif // SRC__RMF_TRAFFIC_ROS2__SCHEDULE__INTERNAL_CHANGEDPARTICIPANTS_HPP
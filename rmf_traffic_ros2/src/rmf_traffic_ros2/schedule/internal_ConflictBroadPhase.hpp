@@ -0,0 +1,172 @@
+/*
+ * Copyright (C) 2022 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SRC__RMF_TRAFFIC_ROS2__SCHEDULE__INTERNAL_CONFLICTBROADPHASE_HPP
+#define SRC__RMF_TRAFFIC_ROS2__SCHEDULE__INTERNAL_CONFLICTBROADPHASE_HPP
+
+#include <rmf_traffic/Profile.hpp>
+#include <rmf_traffic/Route.hpp>
+#include <rmf_traffic/schedule/Viewer.hpp>
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace rmf_traffic_ros2 {
+namespace schedule {
+
+//==============================================================================
+/// A broad-phase index for schedule conflict detection.
+///
+/// Every route in the schedule is broken down into its trajectory segments, and
+/// each segment is inserted into the cells of a per-map grid whose cells are
+/// keyed by a spatial position and a time window. The bounding box of a segment
+/// is computed from the control points of its cubic spline, so it contains the
+/// entire swept motion of the segment, and it is inflated by the radius of the
+/// participant's profile.
+///
+/// Only routes that share at least one cell with a changed route can possibly
+/// be in conflict with it, so only those routes need to be passed along to
+/// rmf_traffic::DetectConflict.
+class ConflictBroadPhase
+{
+public:
+
+  using ParticipantId = rmf_traffic::schedule::ParticipantId;
+  using ItineraryViewer = rmf_traffic::schedule::ItineraryViewer;
+  using View = rmf_traffic::schedule::Viewer::View;
+
+  /// The route indices of each participant that might conflict with a route.
+  /// The indices for each participant are sorted in ascending order.
+  using Candidates =
+    std::unordered_map<ParticipantId, std::vector<std::size_t>>;
+
+  /// Constructor
+  ///
+  /// \param[in] cell_size
+  ///   The width (in meters) of each spatial cell in the grid.
+  ///
+  /// \param[in] time_window
+  ///   The duration of each temporal cell in the grid.
+  ///
+  /// \param[in] max_cells_per_segment
+  ///   If a single trajectory segment would need to be inserted into more
+  ///   cells than this, it will instead be treated as a candidate for every
+  ///   query on its map.
+  ConflictBroadPhase(
+    double cell_size = 5.0,
+    rmf_traffic::Duration time_window = std::chrono::seconds(10),
+    std::size_t max_cells_per_segment = 4096);
+
+  /// Bring the index up to date with a viewer that has just received the
+  /// changes described by view_changes.
+  ///
+  /// Participants that appear in view_changes will be re-indexed. Participants
+  /// that have disappeared from the viewer will be removed, and participants
+  /// whose itineraries have shrunk (e.g. because they were cleared or culled)
+  /// will be re-indexed.
+  void update(const View& view_changes, const ItineraryViewer& viewer);
+
+  /// Re-index the current itinerary of one participant.
+  void update(ParticipantId participant, const ItineraryViewer& viewer);
+
+  /// Remove a participant from the index.
+  void erase(ParticipantId participant);
+
+  /// Get the routes in the index that might conflict with the given route.
+  /// This will include routes that belong to the participant of the route, so
+  /// the caller should filter those out if necessary.
+  Candidates candidates(
+    const rmf_traffic::Route& route,
+    const rmf_traffic::Profile& profile) const;
+
+  /// The number of participants that currently have routes in the index.
+  std::size_t participant_count() const;
+
+  /// The number of grid cells that are currently occupied.
+  std::size_t cell_count() const;
+
+  /// Get the conservative radius that a profile can reach around its
+  /// trajectory.
+  static double radius(const rmf_traffic::Profile& profile);
+
+private:
+
+  struct CellKey
+  {
+    int64_t x;
+    int64_t y;
+    int64_t t;
+
+    bool operator==(const CellKey& other) const
+    {
+      return x == other.x && y == other.y && t == other.t;
+    }
+  };
+
+  struct CellKeyHash
+  {
+    std::size_t operator()(const CellKey& key) const;
+  };
+
+  using CellSet = std::unordered_set<CellKey, CellKeyHash>;
+
+  struct Entry
+  {
+    ParticipantId participant;
+    std::size_t route;
+  };
+
+  struct MapIndex
+  {
+    std::unordered_map<CellKey, std::vector<Entry>, CellKeyHash> cells;
+    std::vector<Entry> oversized;
+  };
+
+  struct RouteRecord
+  {
+    std::string map;
+    std::vector<CellKey> cells;
+    bool oversized;
+  };
+
+  struct ParticipantRecord
+  {
+    std::vector<RouteRecord> routes;
+  };
+
+  /// Find all the cells that a route's swept volume touches. Returns false if
+  /// any of its segments would touch more than _max_cells_per_segment cells.
+  bool _collect_cells(
+    const rmf_traffic::Route& route,
+    double radius,
+    CellSet& cells) const;
+
+  double _cell_size;
+  int64_t _time_window;
+  std::size_t _max_cells_per_segment;
+
+  std::unordered_map<std::string, MapIndex> _maps;
+  std::unordered_map<ParticipantId, ParticipantRecord> _participants;
+};
+
+} // namespace schedule
+} // namespace rmf_traffic_ros2
+
+#endif // SRC__RMF_TRAFFIC_ROS2__SCHEDULE__INTERNAL_CONFLICTBROADPHASE_HPP
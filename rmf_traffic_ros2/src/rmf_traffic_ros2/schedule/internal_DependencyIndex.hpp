@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2022 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SRC__RMF_TRAFFIC_ROS2__SCHEDULE__INTERNAL_DEPENDENCYINDEX_HPP
+#define SRC__RMF_TRAFFIC_ROS2__SCHEDULE__INTERNAL_DEPENDENCYINDEX_HPP
+
+#include <rmf_traffic/schedule/Viewer.hpp>
+
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace rmf_traffic_ros2 {
+namespace schedule {
+
+//==============================================================================
+/// A reverse index of the dependencies between schedule participants. For each
+/// participant, this keeps track of which other participants have a route that
+/// depends on one of its plans.
+///
+/// This is kept up to date in the same way as ConflictBroadPhase, so finding
+/// every participant that is affected by a conflict only needs to traverse the
+/// dependency graph instead of scanning every route in the schedule.
+class DependencyIndex
+{
+public:
+
+  using ParticipantId = rmf_traffic::schedule::ParticipantId;
+  using ItineraryViewer = rmf_traffic::schedule::ItineraryViewer;
+  using View = rmf_traffic::schedule::Viewer::View;
+  using ParticipantSet = std::unordered_set<ParticipantId>;
+
+  /// Bring the index up to date with a viewer that has just received the
+  /// changes described by view_changes.
+  ///
+  /// Participants that appear in view_changes will be re-indexed. Participants
+  /// that no longer exist in the viewer will be removed, and participants whose
+  /// itinerary size has changed will be re-indexed as well.
+  void update(const View& view_changes, const ItineraryViewer& viewer);
+
+  /// Re-index the current itinerary of a single participant.
+  void update(ParticipantId participant, const ItineraryViewer& viewer);
+
+  /// Remove a participant's dependencies from the index. Any dependencies that
+  /// other participants have on it will remain until those participants are
+  /// updated.
+  void erase(ParticipantId participant);
+
+  /// Get the participants that directly depend on a plan of the given
+  /// participant. Returns a nullptr if there are none.
+  const ParticipantSet* dependents(ParticipantId participant) const;
+
+  /// Expand the set of participants to include every participant that directly
+  /// or transitively depends on one of them.
+  void expand(ParticipantSet& participants) const;
+
+  /// The number of participants that currently have dependencies.
+  std::size_t participant_count() const;
+
+private:
+
+  /// Participant -> the participants that it depends on
+  std::unordered_map<ParticipantId, std::vector<ParticipantId>> _dependencies;
+
+  /// The itinerary size of each participant when it was last indexed
+  std::unordered_map<ParticipantId, std::size_t> _itinerary_sizes;
+
+  /// Participant -> the participants that depend on it
+  std::unordered_map<ParticipantId, ParticipantSet> _dependents;
+};
+
+} // namespace schedule
+} // namespace rmf_traffic_ros2
+
+#endif // SRC__RMF_TRAFFIC_ROS2__SCHEDULE__INTERNAL_DEPENDENCYINDEX_HPP
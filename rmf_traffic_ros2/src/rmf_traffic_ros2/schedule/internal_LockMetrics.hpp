@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2022 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SRC__RMF_TRAFFIC_ROS2__SCHEDULE__INTERNAL_LOCKMETRICS_HPP
+#define SRC__RMF_TRAFFIC_ROS2__SCHEDULE__INTERNAL_LOCKMETRICS_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+
+namespace rmf_traffic_ros2 {
+namespace schedule {
+
+//==============================================================================
+/// A lock-free histogram of durations with logarithmic buckets. Bucket 0
+/// counts durations below 1us and bucket i counts durations in the range
+/// [2^(i-1), 2^i) us. The last bucket also counts everything longer.
+class LatencyHistogram
+{
+public:
+
+  static constexpr std::size_t NumBuckets = 24;
+
+  /// Add a sample to the histogram. This can be called from any thread.
+  void record(std::chrono::nanoseconds duration);
+
+  /// The number of samples that have been recorded.
+  uint64_t count() const;
+
+  /// The mean of the recorded samples in microseconds.
+  double mean_us() const;
+
+  /// The longest recorded sample in microseconds.
+  double max_us() const;
+
+  /// An upper bound, in microseconds, for the given percentile of samples.
+  double percentile_us(double percentile) const;
+
+  /// A one-line summary of the histogram.
+  std::string summary() const;
+
+  /// Clear all the recorded samples.
+  void reset();
+
+private:
+  std::array<std::atomic<uint64_t>, NumBuckets> _buckets = {};
+  std::atomic<uint64_t> _count{0};
+  std::atomic<uint64_t> _total_ns{0};
+  std::atomic<uint64_t> _max_ns{0};
+};
+
+//==============================================================================
+/// How long threads wait to acquire a mutex, and how long they hold it for.
+struct LockMetrics
+{
+  LatencyHistogram wait;
+  LatencyHistogram hold;
+
+  std::string summary() const;
+  void reset();
+};
+
+//==============================================================================
+/// A std::unique_lock that records its wait and hold times in a LockMetrics.
+class MeasuredLock
+{
+public:
+
+  MeasuredLock(std::mutex& mutex, LockMetrics& metrics);
+
+  /// Access the underlying lock, e.g. to wait on a condition variable.
+  std::unique_lock<std::mutex>& get();
+
+  /// Start measuring the hold time from now. Use this after waiting on a
+  /// condition variable, since the mutex is released while waiting.
+  void restart_hold_timer();
+
+  /// Release the mutex before the lock goes out of scope.
+  void unlock();
+
+  ~MeasuredLock();
+
+private:
+  using Clock = std::chrono::steady_clock;
+  std::unique_lock<std::mutex> _lock;
+  LockMetrics& _metrics;
+  Clock::time_point _acquired;
+};
+
+} // namespace schedule
+} // namespace rmf_traffic_ros2
+
+#endif // SRC__RMF_TRAFFIC_ROS2__SCHEDULE__INTERNAL_LOCKMETRICS_HPP
@@ -20,6 +20,7 @@
 
 #include "internal_Node.hpp"  // For QueryMap and QuerySubscriberCountMap
 
+#include <rclcpp/executors/single_threaded_executor.hpp>
 #include <rclcpp/node.hpp>
 
 #include <rmf_traffic_msgs/msg/heartbeat.hpp>
@@ -31,6 +32,7 @@
 #include <rmf_traffic_ros2/schedule/MirrorManager.hpp>
 
 #include <optional>
+#include <thread>
 #include <unordered_map>
 
 namespace rmf_traffic_ros2 {
@@ -53,6 +55,8 @@ public:
     std::function<void(std::shared_ptr<rclcpp::Node>)> callback,
     const rclcpp::NodeOptions& options);
 
+  ~MonitorNode();
+
   void setup();
 
   std::chrono::milliseconds heartbeat_period = 10s;
@@ -75,6 +79,25 @@ public:
   std::optional<rmf_traffic_ros2::schedule::MirrorManager> mirror;
   std::function<void(std::shared_ptr<rclcpp::Node>)> on_fail_over_callback;
   ScheduleNode::QueryMap registered_queries;
+  bool failed_over = false;
+
+  // In hot standby mode the replacement schedule node is created ahead of
+  // time and kept up to date with the primary node on its own executor
+  // thread, so failing over only requires a role switch.
+  bool hot_standby = false;
+  std::shared_ptr<ScheduleNode> standby_node;
+  std::shared_ptr<rclcpp::executors::SingleThreadedExecutor> standby_executor;
+  std::thread standby_thread;
+
+  // Create the standby node and wait for its mirror of the primary node to be
+  // ready. Returns false if the mirror was not ready before the timeout.
+  bool start_hot_standby(std::chrono::nanoseconds timeout);
+
+  // Stop the standby node's executor thread and promote it to be the primary
+  // schedule node.
+  std::shared_ptr<rclcpp::Node> promote_standby();
+
+  void stop_standby_thread();
 };
 
 } // namespace schedule
@@ -19,11 +19,16 @@
 #define SRC__RMF_TRAFFIC_SCHEDULE__SCHEDULENODE_HPP
 
 #include "NegotiationRoom.hpp"
+#include "internal_ConflictBroadPhase.hpp"
+#include "internal_DependencyIndex.hpp"
+#include "internal_LockMetrics.hpp"
+#include "internal_WorkerPool.hpp"
 
 #include <rmf_traffic/schedule/Database.hpp>
 #include <rmf_traffic/schedule/Negotiation.hpp>
 
 #include <rclcpp/node.hpp>
+#include <rclcpp/serialized_message.hpp>
 
 #include <rmf_traffic_msgs/msg/mirror_update.hpp>
 #include <rmf_traffic_msgs/msg/participant.hpp>
@@ -59,14 +64,20 @@
 
 #include <rmf_traffic_msgs/msg/negotiation_notice.hpp>
 
+#include <rmf_traffic_ros2/schedule/MirrorManager.hpp>
 #include <rmf_traffic_ros2/schedule/ParticipantRegistry.hpp>
 
 #include <rmf_utils/Modular.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <map>
 #include <optional>
 #include <set>
+#include <tuple>
 #include <unordered_map>
 #include <utility>
+#include <variant>
 
 namespace rmf_traffic_ros2 {
 namespace schedule {
@@ -147,9 +158,31 @@ public:
   rclcpp::TimerBase::SharedPtr query_cleanup_timer;
   void cleanup_queries();
 
-  rclcpp::TimerBase::SharedPtr cull_timer;
+  // Old routes are culled from the schedule by a background thread. Each tick
+  // advances the cull horizon by at most cull_max_buckets_per_tick buckets of
+  // cull_bucket_duration, releasing the database_mutex between buckets, so
+  // catching up on a large history never stalls itinerary updates for long.
+  rmf_traffic::Duration cull_retention_horizon = std::chrono::hours(2);
+  rmf_traffic::Duration cull_bucket_duration = std::chrono::minutes(1);
+  std::chrono::nanoseconds cull_period = std::chrono::seconds(10);
+  std::size_t cull_max_buckets_per_tick = 5;
+  std::optional<rmf_traffic::Time> last_cull_time;
+  std::thread cull_thread;
+  std::mutex cull_mutex;
+  std::condition_variable cull_cv;
+  bool cull_quit = false;
   void cull();
 
+  // Progress of the cull thread, reported every cull_metrics_period
+  std::atomic<uint64_t> culled_routes_total{0};
+  std::atomic<uint64_t> culled_routes_since_report{0};
+  std::atomic<uint64_t> culled_buckets_total{0};
+  std::atomic<uint64_t> culled_buckets_since_report{0};
+  std::atomic<uint64_t> cull_rounds_since_report{0};
+  std::atomic<double> cull_lag_seconds{0.0};
+  rclcpp::TimerBase::SharedPtr cull_metrics_timer;
+  void setup_cull_metrics();
+
   virtual void setup_query_services();
 
   using RegisterParticipant = rmf_traffic_msgs::srv::RegisterParticipant;
@@ -224,6 +257,48 @@ public:
 
   virtual void setup_itinerary_topics();
 
+  // A participant whose itinerary was changed, and the itinerary version of
+  // the change, so its inconsistencies and active conflicts can be checked.
+  struct ItineraryCheck
+  {
+    rmf_traffic::schedule::ParticipantId participant;
+    rmf_traffic::schedule::ItineraryVersion version;
+  };
+
+  // Apply one change to the database. The database_mutex must be locked while
+  // calling these. Returns true if the database was changed.
+  bool apply_itinerary_change(
+    const ItinerarySet& set, std::vector<ItineraryCheck>& checks);
+  bool apply_itinerary_change(
+    const ItineraryExtend& extend, std::vector<ItineraryCheck>& checks);
+  bool apply_itinerary_change(
+    const ItineraryDelay& delay, std::vector<ItineraryCheck>& checks);
+  bool apply_itinerary_change(
+    const ItineraryReached& msg, std::vector<ItineraryCheck>& checks);
+  bool apply_itinerary_change(
+    const ItineraryClear& clear, std::vector<ItineraryCheck>& checks);
+
+  // Notify the mirrors and check for inconsistencies and conflicts after one
+  // or more changes were applied. The database_mutex must be locked while
+  // calling this.
+  void finish_itinerary_changes(const std::vector<ItineraryCheck>& checks);
+
+  // When itinerary_batch_period is positive, incoming itinerary changes are
+  // queued up and applied together under a single lock of the database.
+  using ItineraryChange = std::variant<
+    ItinerarySet,
+    ItineraryExtend,
+    ItineraryDelay,
+    ItineraryReached,
+    ItineraryClear>;
+  std::chrono::nanoseconds itinerary_batch_period =
+    std::chrono::nanoseconds(0);
+  std::mutex itinerary_batch_mutex;
+  std::vector<ItineraryChange> itinerary_batch;
+  rclcpp::TimerBase::SharedPtr itinerary_batch_timer;
+  void queue_itinerary_change(ItineraryChange change);
+  void apply_itinerary_batch();
+
   using InconsistencyMsg = rmf_traffic_msgs::msg::ScheduleInconsistency;
   rclcpp::Publisher<InconsistencyMsg>::SharedPtr inconsistency_pub;
   void publish_inconsistencies(rmf_traffic::schedule::ParticipantId id);
@@ -234,10 +309,19 @@ public:
 
   virtual void setup_incosistency_pub();
 
+  // Changes to the schedule that arrive within this period of each other will
+  // be sent to the mirrors in a single update.
+  std::chrono::nanoseconds mirror_update_coalesce_period = 10ms;
   rclcpp::TimerBase::SharedPtr mirror_update_timer;
+
+  // Call this whenever the database changes or a query needs to be updated.
+  void schedule_mirror_update();
+
   void update_mirrors();
-  bool update_query(
-    const MirrorUpdateTopicPublisher& publisher,
+
+  // The database_mutex must be locked while calling this. Returns a nullptr if
+  // there are no changes to send.
+  std::shared_ptr<const MirrorUpdate> make_mirror_update(
     const rmf_traffic::schedule::Query& query,
     VersionOpt last_sent_version,
     bool is_remedial);
@@ -246,9 +330,37 @@ public:
   std::mutex database_mutex;
   std::shared_ptr<rmf_traffic::schedule::Database> database;
 
+  // Contention on the database_mutex from the conflict checking thread and
+  // from the itinerary update topics
+  LockMetrics conflict_check_lock_metrics;
+  LockMetrics itinerary_lock_metrics;
+  LockMetrics cull_lock_metrics;
+  rclcpp::TimerBase::SharedPtr lock_metrics_timer;
+  void setup_lock_metrics();
+
+  // Registered queries are put into a canonical form so that equivalent
+  // queries can share the work of computing their mirror updates.
+  struct CanonicalQuery
+  {
+    rmf_traffic::schedule::Query query;
+    std::size_t hash;
+  };
+  using CanonicalQueryPtr = std::shared_ptr<const CanonicalQuery>;
+
+  // Get the canonical form of a query. Equivalent queries will get the same
+  // pointer for as long as any registered query is using it.
+  CanonicalQueryPtr canonicalize(const rmf_traffic::schedule::Query& query);
+
+  // Remove canonical queries that are no longer used by any registered query.
+  void prune_canonical_queries();
+
+  std::unordered_map<std::size_t, std::vector<CanonicalQueryPtr>>
+  canonical_queries;
+
   struct QueryInfo
   {
     rmf_traffic::schedule::Query query;
+    CanonicalQueryPtr canonical;
     MirrorUpdateTopicPublisher publisher;
     VersionOpt last_checked_version;
     VersionOpt last_sent_version;
@@ -260,10 +372,30 @@ public:
   std::size_t last_query_id = 0;
   QueryInfoMap registered_queries;
 
+  // Mirror updates that have already been converted into messages, so that
+  // topics which need the same changes can share them. The serialized message
+  // is filled in the first time the update gets published.
+  struct CachedMirrorUpdate
+  {
+    CanonicalQueryPtr query;
+    std::shared_ptr<const MirrorUpdate> msg;
+    std::shared_ptr<const rclcpp::SerializedMessage> serialized;
+  };
+
+  // Keyed by (query hash, base version, target version, is remedial). This is
+  // guarded by the database_mutex.
+  using MirrorUpdateCacheKey =
+    std::tuple<
+    std::size_t, VersionOpt, rmf_traffic::schedule::Version, bool>;
+  std::map<MirrorUpdateCacheKey, std::shared_ptr<CachedMirrorUpdate>>
+  mirror_update_cache;
+  std::size_t mirror_update_cache_limit = 1024;
+
   // TODO(MXG): Make this a separate node
   std::thread conflict_check_thread;
   std::condition_variable conflict_check_cv;
   std::atomic_bool conflict_check_quit;
+  std::unique_ptr<WorkerPool> conflict_check_pool;
 
   using ConflictAck = rmf_traffic_msgs::msg::NegotiationAck;
   using ConflictAckSub = rclcpp::Subscription<ConflictAck>;
@@ -308,9 +440,23 @@ public:
 
   using NegotiationStates = rmf_traffic_msgs::msg::NegotiationStates;
   using NegotiationStatesPub = rclcpp::Publisher<NegotiationStates>;
+
+  // Keyframes: the full tree of every open negotiation. These are published
+  // when a negotiation opens or closes, and periodically while any tree has
+  // changed since the last keyframe.
   NegotiationStatesPub::SharedPtr negotiation_states_pub;
   void publish_negotiation_states();
 
+  // Deltas: for each negotiation that changed, a NegotiationState whose tree
+  // is empty and whose orphan_proposals, orphan_rejections, and
+  // orphan_forfeits hold the proposals, rejections, and forfeits that were
+  // applied to the tree since the last delta. A proposal for a table that was
+  // not in the tree before means the table was added.
+  NegotiationStatesPub::SharedPtr negotiation_state_updates_pub;
+  void publish_negotiation_updates();
+
+  rclcpp::TimerBase::SharedPtr negotiation_keyframe_timer;
+
   using NegotiationStatuses = rmf_traffic_msgs::msg::NegotiationStatuses;
   using NegotiationStatusesPub = rclcpp::Publisher<NegotiationStatuses>;
   // Published by publish_negotiation_states
@@ -328,9 +474,16 @@ public:
       rmf_traffic::Time start_time;
       rmf_traffic::Time last_active_time;
 
+      // Changes to the tree that have not been published as a delta yet
+      rmf_traffic_msgs::msg::NegotiationState changes = {};
+
+      // True if room.state_msg does not reflect the current tree
+      bool keyframe_outdated = true;
+
       void update_state_msg(uint64_t conflict_version)
       {
         room.update_state_msg(conflict_version, start_time, last_active_time);
+        keyframe_outdated = false;
       }
     };
 
@@ -411,12 +564,60 @@ public:
           update_negotiation->room.negotiation.add_participant(p);
           update_negotiation->last_active_time = time;
         }
+
+        update_negotiation->keyframe_outdated = true;
       }
 
-      update_negotiation->update_state_msg(negotiation_version);
       return Entry{negotiation_version, &update_negotiation->room.negotiation};
     }
 
+    // Open a negotiation that was announced by another schedule node, keeping
+    // the version that it was given there. This is used by standby nodes to
+    // follow the negotiations of the primary node.
+    void replicate(
+      const Version version,
+      const std::vector<ParticipantId>& participants,
+      const rmf_traffic::Time time,
+      const rmf_traffic::schedule::Snappable& viewer)
+    {
+      if (_next_negotiation_version <= version)
+        _next_negotiation_version = version + 1;
+
+      auto& replica = _negotiations[version];
+      if (!replica)
+      {
+        const auto negotiation = rmf_traffic::schedule::Negotiation::make(
+          viewer.snapshot(), participants);
+
+        if (!negotiation)
+        {
+          _negotiations.erase(version);
+          return;
+        }
+
+        replica = OpenNegotiation{*negotiation, time, time};
+      }
+      else
+      {
+        const auto& existing = replica->room.negotiation.participants();
+        for (const auto p : participants)
+        {
+          if (std::find(existing.begin(), existing.end(), p) == existing.end())
+          {
+            replica->room.negotiation.add_participant(p);
+            replica->last_active_time = time;
+            replica->keyframe_outdated = true;
+          }
+        }
+      }
+
+      for (const auto p : participants)
+      {
+        _version[p] = version;
+        _waiting.erase(p);
+      }
+    }
+
     OpenNegotiation* negotiation(const Version version)
     {
       const auto it = _negotiations.find(version);
@@ -537,15 +738,57 @@ public:
   std::mutex active_conflicts_mutex;
   std::shared_ptr<ParticipantRegistry> participant_registry;
 
+  // Subscribe to the messages that participants send while negotiating
+  void setup_negotiation_subscriptions(const rclcpp::QoS& negotiation_qos);
+
   virtual void setup_conflict_topics_and_thread();
-  void setup_cull_timer();
+  void setup_cull_thread();
 
   // TODO(MXG): Build this into the Database/Mirror class, tracking participant
   // description versions separately from itinerary versions.
   std::size_t last_known_participants_version = 0;
   std::size_t current_participants_version = 1;
+
+  // A hot standby node follows the primary schedule node by mirroring its
+  // database and listening to its negotiations, without publishing or serving
+  // anything itself. When the primary dies, take_over() only needs to fork
+  // the mirror and open up the topics and services.
+  std::atomic_bool standby{false};
+  std::optional<MirrorManager> standby_mirror;
+
+  using ConflictNoticeSub = rclcpp::Subscription<ConflictNotice>;
+  ConflictNoticeSub::SharedPtr standby_notice_sub;
+
+  using ConflictConclusionSub = rclcpp::Subscription<ConflictConclusion>;
+  ConflictConclusionSub::SharedPtr standby_conclusion_sub;
+
+  // Begin following the primary schedule node. The mirror must be using
+  // query_all() and must belong to this node. This should be used instead of
+  // setup(~).
+  virtual void setup_standby(MirrorManager mirror);
+
+  void replicate_notice(const ConflictNotice& msg);
+  void replicate_conclusion(const ConflictConclusion& msg);
+
+  // Switch from standby to being the primary schedule node. This finishes the
+  // setup of the node using the replicated database and negotiations.
+  virtual void take_over(const QueryMap& queries);
 };
 
+//==============================================================================
+/// Find the sets of participants whose routes conflict with the changes that
+/// are described by view_changes. The broad_phase index must already be up to
+/// date with the viewer.
+///
+/// If a pool is provided, the narrow-phase checks will be split across its
+/// threads. The conflicts are always reported in the same order, no matter
+/// how many threads are used.
+std::vector<ScheduleNode::ConflictSet> get_conflicts(
+  const rmf_traffic::schedule::Viewer::View& view_changes,
+  const rmf_traffic::schedule::ItineraryViewer& viewer,
+  const ConflictBroadPhase& broad_phase,
+  WorkerPool* pool = nullptr);
+
 } // namespace schedule
 } // namespace rmf_traffic_ros2
 
@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2022 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SRC__RMF_TRAFFIC_ROS2__SCHEDULE__INTERNAL_WORKERPOOL_HPP
+#define SRC__RMF_TRAFFIC_ROS2__SCHEDULE__INTERNAL_WORKERPOOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace rmf_traffic_ros2 {
+namespace schedule {
+
+//==============================================================================
+/// A fixed-size pool of threads for splitting up a batch of independent jobs.
+class WorkerPool
+{
+public:
+
+  /// Constructor
+  ///
+  /// \param[in] num_threads
+  ///   The total number of threads that will work on each batch, including
+  ///   the thread that calls parallel_for(). A value of 0 or 1 means all jobs
+  ///   will be run by the calling thread.
+  explicit WorkerPool(std::size_t num_threads);
+
+  /// The total number of threads that work on each batch.
+  std::size_t size() const;
+
+  /// Call job(i) for every i in [0, count) and wait until all the calls have
+  /// finished. The calling thread will also work on the batch. Only one thread
+  /// may call this function at a time.
+  ///
+  /// If any of the jobs throws an exception, the first exception will be
+  /// rethrown after every job has finished.
+  void parallel_for(
+    std::size_t count,
+    const std::function<void(std::size_t)>& job);
+
+  ~WorkerPool();
+
+private:
+
+  void _work(const std::function<void(std::size_t)>& job, std::size_t count);
+
+  std::vector<std::thread> _threads;
+  std::mutex _mutex;
+  std::condition_variable _start_cv;
+  std::condition_variable _done_cv;
+  bool _quit = false;
+  uint64_t _generation = 0;
+  const std::function<void(std::size_t)>* _job = nullptr;
+  std::size_t _count = 0;
+  std::size_t _busy = 0;
+  std::atomic<std::size_t> _next{0};
+  std::exception_ptr _exception;
+};
+
+} // namespace schedule
+} // namespace rmf_traffic_ros2
+
+#endif // SRC__RMF_TRAFFIC_ROS2__SCHEDULE__INTERNAL_WORKERPOOL_HPP
@@ -0,0 +1,250 @@
+/*
+ * Copyright (C) 2022 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+// This load generator drives a number of synthetic blockade participants
+// through a blockade moderator that runs in the same process. The participants
+// are spread over several maps and each of them repeatedly reserves a short
+// straight lane, asks to move along it, and reports that it reached each
+// checkpoint as soon as it is allowed to. The maps are grouped round-robin
+// into the requested number of moderator shards. The generator reports how
+// many reservations were completed per second and how long participants had
+// to wait for each of their requests to be granted.
+//
+// Usage:
+//   benchmark_blockade_load [participants] [maps] [shards] [duration_s]
+
+#include <rmf_traffic_ros2/blockade/Node.hpp>
+#include <rmf_traffic_ros2/blockade/Writer.hpp>
+
+#include <rclcpp/executors/single_threaded_executor.hpp>
+#include <rclcpp/rclcpp.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <future>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+using Clock = std::chrono::steady_clock;
+using Checkpoint = rmf_traffic::blockade::Writer::Checkpoint;
+using ReservedRange = rmf_traffic::blockade::ReservedRange;
+using ReservationId = rmf_traffic::blockade::ReservationId;
+
+//==============================================================================
+struct SyntheticParticipant
+{
+  std::optional<rmf_traffic::blockade::Participant> blockade;
+  std::vector<Checkpoint> path;
+
+  // The checkpoint that the participant is waiting to move past
+  std::size_t waiting_at = 0;
+  Clock::time_point requested;
+};
+
+//==============================================================================
+struct Range
+{
+  std::size_t participant;
+  ReservationId reservation;
+  ReservedRange range;
+};
+
+//==============================================================================
+struct LoadStatistics
+{
+  std::size_t completed_reservations = 0;
+  std::size_t grants = 0;
+  Clock::duration total_latency = Clock::duration(0);
+  Clock::duration max_latency = Clock::duration(0);
+};
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+  using namespace std::chrono_literals;
+
+  const std::size_t N_participants = argc > 1 ? std::stoul(argv[1]) : 50;
+  const std::size_t N_maps =
+    std::max<std::size_t>(1, argc > 2 ? std::stoul(argv[2]) : 5);
+  const std::size_t N_shards =
+    std::clamp<std::size_t>(argc > 3 ? std::stoul(argv[3]) : N_maps, 1, N_maps);
+  const std::chrono::duration<double> duration(
+    argc > 4 ? std::stod(argv[4]) : 10.0);
+  const std::size_t N_checkpoints = 5;
+
+  rclcpp::init(argc, argv);
+
+  // Maps that are not listed belong to the default shard, so the maps of the
+  // first group do not need to be listed.
+  std::vector<std::string> shard_maps;
+  for (std::size_t s = 1; s < N_shards; ++s)
+  {
+    std::string maps;
+    for (std::size_t m = s; m < N_maps; m += N_shards)
+      maps += (maps.empty() ? "" : ",") + ("L" + std::to_string(m));
+
+    shard_maps.push_back(maps);
+  }
+
+  const auto blockade_node = rmf_traffic_ros2::blockade::make_node(
+    "benchmark_blockade_moderator",
+    rclcpp::NodeOptions().parameter_overrides(
+      {rclcpp::Parameter("shard_maps", shard_maps)}));
+
+  const auto driver = std::make_shared<rclcpp::Node>("benchmark_blockade_load");
+  const auto writer = rmf_traffic_ros2::blockade::Writer::make(*driver);
+
+  std::mutex ranges_mutex;
+  std::deque<Range> ranges;
+
+  std::vector<SyntheticParticipant> participants(N_participants);
+  for (std::size_t i = 0; i < N_participants; ++i)
+  {
+    auto& p = participants[i];
+    const std::string map = "L" + std::to_string(i % N_maps);
+    for (std::size_t c = 0; c < N_checkpoints; ++c)
+    {
+      p.path.push_back(
+        Checkpoint{
+          Eigen::Vector2d{2.0 * c, 5.0 * i},
+          map,
+          true
+        });
+    }
+
+    // The range callbacks only queue up the work so that the participants are
+    // never updated from inside of their own callbacks.
+    p.blockade = writer->make_participant(
+      i, 0.5,
+      [i, &ranges_mutex, &ranges](
+        const ReservationId reservation,
+        const ReservedRange& range)
+      {
+        std::lock_guard<std::mutex> lock(ranges_mutex);
+        ranges.push_back(Range{i, reservation, range});
+      });
+  }
+
+  LoadStatistics stats;
+  const auto begin_reservation = [&](SyntheticParticipant& p)
+    {
+      p.blockade->set(p.path);
+      p.waiting_at = 0;
+      p.requested = Clock::now();
+      p.blockade->ready(0);
+    };
+
+  const auto handle_range = [&](const Range& r)
+    {
+      auto& p = participants.at(r.participant);
+      if (r.reservation != p.blockade->reservation_id())
+        return;
+
+      while (p.waiting_at < r.range.end)
+      {
+        const auto latency = Clock::now() - p.requested;
+        ++stats.grants;
+        stats.total_latency += latency;
+        stats.max_latency = std::max(stats.max_latency, latency);
+
+        ++p.waiting_at;
+        p.blockade->reached(p.waiting_at);
+        if (p.waiting_at + 1 >= p.path.size())
+        {
+          ++stats.completed_reservations;
+          begin_reservation(p);
+          return;
+        }
+
+        p.requested = Clock::now();
+        p.blockade->ready(p.waiting_at);
+      }
+    };
+
+  bool started = false;
+  Clock::time_point start;
+  const auto driver_timer = driver->create_wall_timer(
+    1ms,
+    [&]()
+    {
+      if (!started)
+      {
+        start = Clock::now();
+        for (auto& p : participants)
+          begin_reservation(p);
+
+        started = true;
+        return;
+      }
+
+      std::deque<Range> queue;
+      {
+        std::lock_guard<std::mutex> lock(ranges_mutex);
+        queue.swap(ranges);
+      }
+
+      for (const auto& r : queue)
+        handle_range(r);
+    });
+
+  rclcpp::executors::SingleThreadedExecutor moderator_executor;
+  moderator_executor.add_node(blockade_node);
+  std::thread moderator_thread([&]() { moderator_executor.spin(); });
+
+  // Give the subscriptions a moment to discover each other
+  std::this_thread::sleep_for(1s);
+
+  // Nothing ever completes this promise, so the driver spins for the whole
+  // duration
+  std::promise<void> never;
+  rclcpp::executors::SingleThreadedExecutor driver_executor;
+  driver_executor.add_node(driver);
+  driver_executor.spin_until_future_complete(
+    never.get_future(),
+    std::chrono::duration_cast<std::chrono::nanoseconds>(duration));
+
+  const auto elapsed = Clock::now() - start;
+  moderator_executor.cancel();
+  moderator_thread.join();
+
+  const double seconds = std::chrono::duration<double>(elapsed).count();
+  std::cout << "Participants:              " << N_participants
+            << "\nMaps:                      " << N_maps
+            << "\nShards:                    " << N_shards
+            << "\nDuration [s]:              " << seconds
+            << "\nCompleted reservations:    " << stats.completed_reservations
+            << "\nReservations per second:   "
+            << stats.completed_reservations / seconds
+            << "\nGranted requests:          " << stats.grants;
+
+  if (stats.grants > 0)
+  {
+    std::cout << "\nMean grant latency [ms]:   "
+              << std::chrono::duration<double, std::milli>(
+      stats.total_latency).count() / stats.grants
+              << "\nMax grant latency [ms]:    "
+              << std::chrono::duration<double, std::milli>(
+      stats.max_latency).count();
+  }
+
+  std::cout << std::endl;
+  rclcpp::shutdown();
+  return stats.completed_reservations > 0 ? 0 : 1;
+}
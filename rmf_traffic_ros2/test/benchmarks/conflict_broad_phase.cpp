@@ -0,0 +1,199 @@
+/*
+ * Copyright (C) 2022 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+// This benchmark replays a synthetic schedule of many participants that keep
+// replanning, and compares the time spent by the schedule node's conflict
+// detection with and without the broad-phase index.
+//
+// Usage:
+//   benchmark_conflict_broad_phase [participants] [rounds] [replans] [threads]
+
+#include <rmf_traffic_ros2/schedule/internal_Node.hpp>
+
+#include <rmf_traffic/geometry/Circle.hpp>
+#include <rmf_traffic/schedule/Database.hpp>
+#include <rmf_traffic/schedule/Mirror.hpp>
+#include <rmf_traffic/schedule/Participant.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <random>
+
+using rmf_traffic_ros2::schedule::ConflictBroadPhase;
+using rmf_traffic_ros2::schedule::WorkerPool;
+using rmf_traffic_ros2::schedule::get_conflicts;
+
+//==============================================================================
+std::vector<rmf_traffic::Route> random_itinerary(
+  std::mt19937& rng,
+  const rmf_traffic::Time start)
+{
+  using namespace std::chrono_literals;
+  std::uniform_real_distribution<double> coordinate(0.0, 200.0);
+  std::uniform_real_distribution<double> speed(0.5, 1.0);
+  std::uniform_int_distribution<int> legs(5, 15);
+  std::bernoulli_distribution second_floor(0.1);
+
+  const std::string map = second_floor(rng) ? "L2" : "L1";
+  rmf_traffic::Trajectory trajectory;
+  Eigen::Vector3d p{coordinate(rng), coordinate(rng), 0.0};
+  rmf_traffic::Time t = start;
+  trajectory.insert(t, p, Eigen::Vector3d::Zero());
+
+  const int N = legs(rng);
+  for (int i = 0; i < N; ++i)
+  {
+    const Eigen::Vector3d next{
+      p.x() + coordinate(rng)/10.0 - 10.0,
+      p.y() + coordinate(rng)/10.0 - 10.0,
+      0.0
+    };
+
+    const double dist = (next - p).norm();
+    t += rmf_traffic::time::from_seconds(dist/speed(rng));
+    trajectory.insert(t, next, Eigen::Vector3d::Zero());
+
+    // Wait at the waypoint for a moment
+    t += 2s;
+    trajectory.insert(t, next, Eigen::Vector3d::Zero());
+    p = next;
+  }
+
+  return {rmf_traffic::Route(map, std::move(trajectory))};
+}
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+  const std::size_t N_participants = argc > 1 ? std::stoul(argv[1]) : 200;
+  const std::size_t N_rounds = argc > 2 ? std::stoul(argv[2]) : 50;
+  const std::size_t N_replans = argc > 3 ? std::stoul(argv[3]) : 20;
+  const std::size_t N_threads = argc > 4 ? std::stoul(argv[4]) : 1;
+
+  auto database = std::make_shared<rmf_traffic::schedule::Database>();
+  const rmf_traffic::Profile profile{
+    rmf_traffic::geometry::make_final_convex<
+      rmf_traffic::geometry::Circle>(0.5)
+  };
+
+  std::vector<rmf_traffic::schedule::Participant> participants;
+  rmf_traffic::schedule::ParticipantDescriptionsMap descriptions;
+  for (std::size_t i = 0; i < N_participants; ++i)
+  {
+    participants.emplace_back(
+      rmf_traffic::schedule::make_participant(
+        rmf_traffic::schedule::ParticipantDescription{
+          "participant_" + std::to_string(i),
+          "benchmark",
+          rmf_traffic::schedule::ParticipantDescription::Rx::Responsive,
+          profile
+        },
+        database));
+
+    descriptions.insert({participants.back().id(),
+        participants.back().description()});
+  }
+
+  std::mt19937 rng(42);
+  const auto start = std::chrono::steady_clock::now();
+  for (auto& participant : participants)
+    participant.set(participant.assign_plan_id(), random_itinerary(rng, start));
+
+  rmf_traffic::schedule::Mirror mirror;
+  mirror.update_participants_info(descriptions);
+  const auto query_all = rmf_traffic::schedule::query_all();
+
+  ConflictBroadPhase indexed;
+  WorkerPool pool(N_threads);
+
+  // An index where every trajectory segment is considered oversized will offer
+  // every route on the map as a candidate, which is equivalent to checking
+  // every pair of routes.
+  ConflictBroadPhase exhaustive(5.0, std::chrono::seconds(10), 0);
+
+  using Clock = std::chrono::steady_clock;
+  Clock::duration indexed_total = Clock::duration::zero();
+  Clock::duration exhaustive_total = Clock::duration::zero();
+  std::size_t total_conflicts = 0;
+
+  std::uniform_int_distribution<std::size_t> pick(0, N_participants - 1);
+  for (std::size_t round = 0; round < N_rounds; ++round)
+  {
+    if (round > 0)
+    {
+      for (std::size_t i = 0; i < N_replans; ++i)
+      {
+        auto& participant = participants[pick(rng)];
+        participant.set(
+          participant.assign_plan_id(), random_itinerary(rng, start));
+      }
+    }
+
+    const auto last_checked_version = mirror.latest_version().value_or(0);
+    const auto patch = database->changes(query_all, mirror.latest_version());
+    if (!mirror.update(patch))
+    {
+      std::cerr << "Failed to update the mirror in round " << round
+                << std::endl;
+      return 1;
+    }
+
+    const auto view_changes = database->query(query_all, last_checked_version);
+
+    const auto indexed_start = Clock::now();
+    indexed.update(view_changes, mirror);
+    const auto indexed_conflicts =
+      get_conflicts(view_changes, mirror, indexed, &pool);
+    indexed_total += Clock::now() - indexed_start;
+
+    const auto exhaustive_start = Clock::now();
+    exhaustive.update(view_changes, mirror);
+    const auto exhaustive_conflicts =
+      get_conflicts(view_changes, mirror, exhaustive);
+    exhaustive_total += Clock::now() - exhaustive_start;
+
+    if (indexed_conflicts != exhaustive_conflicts)
+    {
+      std::cerr << "Mismatch in round " << round << ": the broad-phase index "
+                << "found " << indexed_conflicts.size() << " conflicts while "
+                << "the exhaustive check found " << exhaustive_conflicts.size()
+                << std::endl;
+      return 1;
+    }
+
+    total_conflicts += indexed_conflicts.size();
+  }
+
+  const auto to_ms = [](const Clock::duration d)
+    {
+      return std::chrono::duration<double, std::milli>(d).count();
+    };
+
+  std::cout << "Participants:        " << N_participants
+            << "\nRounds:              " << N_rounds
+            << "\nReplans per round:   " << N_replans
+            << "\nThreads:             " << pool.size()
+            << "\nConflicts found:     " << total_conflicts
+            << "\nOccupied cells:      " << indexed.cell_count()
+            << "\nExhaustive [ms]:     " << to_ms(exhaustive_total)
+            << "\nBroad-phase [ms]:    " << to_ms(indexed_total)
+            << "\nSpeedup:             "
+            << to_ms(exhaustive_total) / to_ms(indexed_total)
+            << std::endl;
+
+  return 0;
+}
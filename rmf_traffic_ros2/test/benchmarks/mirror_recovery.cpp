@@ -0,0 +1,411 @@
+/*
+ * Copyright (C) 2022 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+// This harness runs a schedule node and a MirrorManager in one process, with
+// a relay in between them that randomly drops some of the regular mirror
+// updates. Whenever the MirrorManager notices that it missed an update, it
+// goes through its normal recovery path: it asks the schedule node for the
+// changes since the version that it already holds, and the schedule node
+// answers with a remedial update. The harness reports how many remedial
+// updates were needed, how many bytes they put on the wire compared to a full
+// update, and how long it takes for the mirror to become consistent again.
+//
+// Usage:
+//   benchmark_mirror_recovery [participants] [rounds] [replans] [drop_rate]
+
+#include <rmf_traffic_ros2/StandardNames.hpp>
+#include <rmf_traffic_ros2/schedule/Itinerary.hpp>
+#include <rmf_traffic_ros2/schedule/MirrorManager.hpp>
+#include <rmf_traffic_ros2/schedule/ParticipantDescription.hpp>
+#include <rmf_traffic_ros2/schedule/Patch.hpp>
+#include <rmf_traffic_ros2/schedule/internal_Node.hpp>
+
+#include <rmf_traffic/geometry/Circle.hpp>
+
+#include <rclcpp/executors/single_threaded_executor.hpp>
+#include <rclcpp/serialization.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <thread>
+
+using rmf_traffic_ros2::schedule::ScheduleNode;
+using MirrorUpdate = rmf_traffic_msgs::msg::MirrorUpdate;
+using Clock = std::chrono::steady_clock;
+
+//==============================================================================
+std::vector<rmf_traffic::Route> random_itinerary(
+  std::mt19937& rng,
+  const rmf_traffic::Time start)
+{
+  using namespace std::chrono_literals;
+  std::uniform_real_distribution<double> coordinate(0.0, 200.0);
+  std::uniform_int_distribution<int> legs(5, 15);
+
+  rmf_traffic::Trajectory trajectory;
+  Eigen::Vector3d p{coordinate(rng), coordinate(rng), 0.0};
+  rmf_traffic::Time t = start;
+  trajectory.insert(t, p, Eigen::Vector3d::Zero());
+
+  const int N = legs(rng);
+  for (int i = 0; i < N; ++i)
+  {
+    const Eigen::Vector3d next{
+      p.x() + coordinate(rng)/10.0 - 10.0,
+      p.y() + coordinate(rng)/10.0 - 10.0,
+      0.0
+    };
+
+    t += rmf_traffic::time::from_seconds((next - p).norm());
+    trajectory.insert(t, next, Eigen::Vector3d::Zero());
+    p = next;
+  }
+
+  return {rmf_traffic::Route("L1", std::move(trajectory))};
+}
+
+//==============================================================================
+std::size_t serialized_size(const MirrorUpdate& msg)
+{
+  static const rclcpp::Serialization<MirrorUpdate> serializer;
+  rclcpp::SerializedMessage serialized;
+  serializer.serialize_message(&msg, &serialized);
+  return serialized.size();
+}
+
+//==============================================================================
+/// Sits between the schedule node and the mirror. Regular updates are dropped
+/// when the harness asks for it, while remedial updates always get through.
+class LossyRelay
+{
+public:
+
+  LossyRelay(rclcpp::Node& node, const std::string& input, uint64_t query_id)
+  {
+    const auto qos = rclcpp::ServicesQoS().reliable().keep_last(5000);
+    output = node.create_publisher<MirrorUpdate>(
+      rmf_traffic_ros2::QueryUpdateTopicNameBase + std::to_string(query_id),
+      qos);
+
+    subscription = node.create_subscription<MirrorUpdate>(
+      input, qos,
+      [this](const MirrorUpdate::SharedPtr msg)
+      {
+        if (msg->is_remedial_update)
+        {
+          ++remedial_updates;
+          remedial_bytes += serialized_size(*msg);
+        }
+        else if (drop_next.exchange(false))
+        {
+          return;
+        }
+
+        output->publish(*msg);
+      });
+  }
+
+  rclcpp::Publisher<MirrorUpdate>::SharedPtr output;
+  rclcpp::Subscription<MirrorUpdate>::SharedPtr subscription;
+  std::atomic_bool drop_next{false};
+  std::atomic<std::size_t> remedial_updates{0};
+  std::atomic<std::size_t> remedial_bytes{0};
+};
+
+//==============================================================================
+/// A participant that sends its itinerary changes straight to the schedule
+/// node, the same way that the itinerary topics would.
+struct SimulatedParticipant
+{
+  ScheduleNode::RegisterParticipant::Response registration;
+  rmf_traffic::PlanId plan;
+  rmf_traffic::schedule::ItineraryVersion version;
+  uint64_t storage;
+
+  void set(ScheduleNode& node, const rmf_traffic::schedule::Itinerary& it)
+  {
+    ScheduleNode::ItinerarySet msg;
+    msg.participant = registration.participant_id;
+    msg.plan = ++plan;
+    msg.itinerary = rmf_traffic_ros2::convert(it);
+    msg.storage_base = storage;
+    msg.itinerary_version = ++version;
+    node.itinerary_set(msg);
+    storage += it.size();
+  }
+};
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+  using namespace std::chrono_literals;
+
+  const std::size_t N_participants = argc > 1 ? std::stoul(argv[1]) : 200;
+  const std::size_t N_rounds = argc > 2 ? std::stoul(argv[2]) : 200;
+  const std::size_t N_replans = argc > 3 ? std::stoul(argv[3]) : 5;
+  const double drop_rate = argc > 4 ? std::stod(argv[4]) : 0.05;
+
+  rclcpp::init(argc, argv);
+
+  const auto log_dir =
+    std::filesystem::temp_directory_path() / "benchmark_mirror_recovery";
+  std::filesystem::remove_all(log_dir);
+  std::filesystem::create_directories(log_dir);
+
+  auto schedule_node = std::make_shared<ScheduleNode>(
+    rclcpp::NodeOptions().parameter_overrides({
+      rclcpp::Parameter(
+        "log_file_location", (log_dir / "registry.yaml").string())
+    }));
+
+  const rmf_traffic::Profile profile{
+    rmf_traffic::geometry::make_final_convex<
+      rmf_traffic::geometry::Circle>(0.5)
+  };
+
+  std::vector<SimulatedParticipant> participants;
+  for (std::size_t i = 0; i < N_participants; ++i)
+  {
+    auto request =
+      std::make_shared<ScheduleNode::RegisterParticipant::Request>();
+    request->description = rmf_traffic_ros2::convert(
+      rmf_traffic::schedule::ParticipantDescription{
+        "participant_" + std::to_string(i),
+        "benchmark",
+        rmf_traffic::schedule::ParticipantDescription::Rx::Responsive,
+        profile
+      });
+
+    auto response =
+      std::make_shared<ScheduleNode::RegisterParticipant::Response>();
+    schedule_node->register_participant(nullptr, request, response);
+    if (!response->error.empty())
+    {
+      std::cerr << "Failed to register a participant: " << response->error
+                << std::endl;
+      return 1;
+    }
+
+    participants.push_back(
+      SimulatedParticipant{
+        *response,
+        response->last_plan_id,
+        response->last_itinerary_version,
+        response->next_storage_base
+      });
+  }
+
+  std::mt19937 rng(42);
+  const auto start = std::chrono::steady_clock::now();
+  for (auto& participant : participants)
+    participant.set(*schedule_node, random_itinerary(rng, start));
+
+  auto mirror_node = std::make_shared<rclcpp::Node>("benchmark_mirror");
+  auto relay_node = std::make_shared<rclcpp::Node>("benchmark_relay");
+
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(schedule_node);
+  executor.add_node(mirror_node);
+  executor.add_node(relay_node);
+  auto spin_thread = std::thread([&]() { executor.spin(); });
+
+  auto mirror_future = rmf_traffic_ros2::schedule::make_mirror(
+    mirror_node, rmf_traffic::schedule::query_all());
+  if (mirror_future.wait_for(10s) != std::future_status::ready)
+  {
+    std::cerr << "Timed out while waiting for the mirror" << std::endl;
+    return 1;
+  }
+  auto mirror = mirror_future.get();
+
+  // Reroute the schedule node's updates for the mirror's query through the
+  // relay. The executor is stopped so that the swap cannot race with the
+  // schedule node publishing an update.
+  executor.cancel();
+  spin_thread.join();
+
+  if (schedule_node->registered_queries.size() != 1)
+  {
+    std::cerr << "Expected exactly one registered query" << std::endl;
+    return 1;
+  }
+
+  auto& query_info = schedule_node->registered_queries.begin()->second;
+  const uint64_t query_id = schedule_node->registered_queries.begin()->first;
+  const std::string relay_input = "benchmark_mirror_recovery/lossy";
+  query_info.publisher = schedule_node->create_publisher<MirrorUpdate>(
+    relay_input, rclcpp::ServicesQoS().reliable().keep_last(5000));
+  LossyRelay relay(*relay_node, relay_input, query_id);
+
+  spin_thread = std::thread([&]() { executor.spin(); });
+
+  const auto discovery_timeout = Clock::now() + 10s;
+  while ((query_info.publisher->get_subscription_count() == 0
+    || relay.output->get_subscription_count() == 0)
+    && Clock::now() < discovery_timeout)
+  {
+    std::this_thread::sleep_for(10ms);
+  }
+
+  const auto database_version = [&]()
+    {
+      std::lock_guard<std::mutex> lock(schedule_node->database_mutex);
+      return schedule_node->database->latest_version();
+    };
+
+  const auto snapshots = mirror.snapshots();
+  const auto wait_for_mirror = [&](const Clock::duration timeout) -> bool
+    {
+      const auto target = database_version();
+      const auto stop = Clock::now() + timeout;
+      while (Clock::now() < stop)
+      {
+        if (snapshots->snapshot()->latest_version() == target)
+          return true;
+
+        std::this_thread::sleep_for(1ms);
+      }
+
+      return false;
+    };
+
+  if (!wait_for_mirror(10s))
+  {
+    std::cerr << "The mirror never received the initial schedule"
+              << std::endl;
+    return 1;
+  }
+
+  std::size_t drops = 0;
+  std::size_t recoveries = 0;
+  std::size_t regular_rounds = 0;
+  Clock::duration regular_time = Clock::duration::zero();
+  Clock::duration recovery_time = Clock::duration::zero();
+  Clock::duration worst_recovery_time = Clock::duration::zero();
+  bool recovering = false;
+  int status = 0;
+
+  std::uniform_int_distribution<std::size_t> pick(0, N_participants - 1);
+  std::bernoulli_distribution drop(drop_rate);
+  for (std::size_t round = 0; round < N_rounds; ++round)
+  {
+    // Nothing can be dropped in the last round, or else there would be no
+    // later update to reveal the gap to the mirror.
+    const bool dropping = round + 1 < N_rounds && drop(rng);
+    relay.drop_next = dropping;
+
+    const auto round_start = Clock::now();
+    for (std::size_t i = 0; i < N_replans; ++i)
+    {
+      participants[pick(rng)].set(
+        *schedule_node, random_itinerary(rng, start));
+    }
+
+    if (dropping)
+    {
+      const auto timeout = Clock::now() + 5s;
+      while (relay.drop_next && Clock::now() < timeout)
+        std::this_thread::sleep_for(1ms);
+
+      ++drops;
+      recovering = true;
+      continue;
+    }
+
+    if (!wait_for_mirror(30s))
+    {
+      std::cerr << "The mirror did not converge onto the database in round "
+                << round << std::endl;
+      status = 1;
+      break;
+    }
+
+    const auto duration = Clock::now() - round_start;
+    if (recovering)
+    {
+      ++recoveries;
+      recovery_time += duration;
+      worst_recovery_time = std::max(worst_recovery_time, duration);
+      recovering = false;
+    }
+    else
+    {
+      ++regular_rounds;
+      regular_time += duration;
+    }
+  }
+
+  std::size_t full_update_bytes = 0;
+  {
+    std::lock_guard<std::mutex> lock(schedule_node->database_mutex);
+    MirrorUpdate full;
+    full.database_version = schedule_node->database->latest_version();
+    full.patch = rmf_traffic_ros2::convert(
+      schedule_node->database->changes(
+        rmf_traffic::schedule::query_all(), std::nullopt));
+    full.is_remedial_update = true;
+    full_update_bytes = serialized_size(full);
+  }
+
+  executor.cancel();
+  spin_thread.join();
+
+  const auto to_ms = [](const Clock::duration d)
+    {
+      return std::chrono::duration<double, std::milli>(d).count();
+    };
+
+  const auto mean_ms = [&](const Clock::duration d, const std::size_t n)
+    {
+      return n > 0 ? to_ms(d) / n : 0.0;
+    };
+
+  const std::size_t remedial_updates = relay.remedial_updates;
+  const std::size_t remedial_bytes = relay.remedial_bytes;
+  std::cout << "Participants:             " << N_participants
+            << "\nRounds:                   " << N_rounds
+            << "\nReplans per round:        " << N_replans
+            << "\nDropped updates:          " << drops
+            << "\nRecoveries:               " << recoveries
+            << "\nRemedial updates:         " << remedial_updates
+            << "\nRemedial bytes:           " << remedial_bytes
+            << "\nFull update bytes (each): " << full_update_bytes
+            << "\nRegular latency [ms]:     "
+            << mean_ms(regular_time, regular_rounds)
+            << "\nMean recovery [ms]:       "
+            << mean_ms(recovery_time, recoveries)
+            << "\nMax recovery [ms]:        " << to_ms(worst_recovery_time)
+            << std::endl;
+
+  // Each recovery should only need one remedial update. More than that means
+  // the MirrorManager sent duplicate change requests.
+  if (remedial_updates > recoveries)
+  {
+    std::cerr << "More remedial updates were sent than there were recoveries"
+              << std::endl;
+    status = 1;
+  }
+
+  schedule_node.reset();
+  rclcpp::shutdown();
+  std::filesystem::remove_all(log_dir);
+  return status;
+}
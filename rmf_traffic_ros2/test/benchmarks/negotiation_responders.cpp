@@ -0,0 +1,246 @@
+/*
+ * Copyright (C) 2022 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+// This benchmark opens a batch of simultaneous negotiations between the same
+// group of participants, all of which are managed by a single Negotiation
+// manager, the way they would be for one fleet adapter. Every negotiator
+// spends a fixed amount of time "planning" before it submits a proposal, so
+// each negotiation fills out its entire tree of tables. The benchmark reports
+// how long it takes until every table has received its proposal when the
+// tables are answered one at a time compared to when they are answered by the
+// responder pool.
+//
+// Usage:
+//   benchmark_negotiation_responders [negotiations] [participants]
+//     [planning_ms] [threads]
+
+#include <rmf_traffic_ros2/StandardNames.hpp>
+#include <rmf_traffic_ros2/schedule/Negotiation.hpp>
+
+#include <rmf_traffic/geometry/Circle.hpp>
+#include <rmf_traffic/schedule/Database.hpp>
+#include <rmf_traffic/schedule/Participant.hpp>
+
+#include <rmf_traffic_msgs/msg/negotiation_notice.hpp>
+#include <rmf_traffic_msgs/msg/negotiation_proposal.hpp>
+
+#include <rclcpp/executors/single_threaded_executor.hpp>
+#include <rclcpp/rclcpp.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+using Notice = rmf_traffic_msgs::msg::NegotiationNotice;
+using Proposal = rmf_traffic_msgs::msg::NegotiationProposal;
+using Clock = std::chrono::steady_clock;
+
+//==============================================================================
+/// The number of tables in a negotiation where every participant accommodates
+/// every ordering of the other participants.
+std::size_t count_tables(const std::size_t participants)
+{
+  std::size_t total = 0;
+  std::size_t level = 1;
+  for (std::size_t depth = 0; depth < participants; ++depth)
+  {
+    level *= participants - depth;
+    total += level;
+  }
+
+  return total;
+}
+
+//==============================================================================
+/// Spin without sleeping to imitate a planner that is busy with a search.
+void plan_for(const std::chrono::microseconds duration)
+{
+  const auto finish = Clock::now() + duration;
+  while (Clock::now() < finish)
+  {
+    // Do nothing
+  }
+}
+
+//==============================================================================
+struct RunResult
+{
+  bool finished;
+  Clock::duration duration;
+  std::size_t proposals;
+};
+
+//==============================================================================
+RunResult run(
+  const std::size_t threads,
+  const uint64_t first_conflict_version,
+  const std::size_t N_negotiations,
+  const std::vector<rmf_traffic::schedule::ParticipantId>& participants,
+  const std::shared_ptr<rmf_traffic::schedule::Database>& database,
+  const std::chrono::microseconds planning_cost)
+{
+  using namespace std::chrono_literals;
+
+  auto node = std::make_shared<rclcpp::Node>(
+    "benchmark_negotiation_responders_" + std::to_string(threads));
+
+  rmf_traffic_ros2::schedule::Negotiation negotiation(*node, database);
+  negotiation.responder_threads(threads);
+
+  std::vector<std::shared_ptr<void>> handles;
+  for (const auto p : participants)
+  {
+    handles.push_back(
+      negotiation.register_negotiator(
+        p,
+        [planning_cost](auto, auto responder)
+        {
+          plan_for(planning_cost);
+          responder->submit(0, {}, nullptr);
+        }));
+  }
+
+  const auto qos = rclcpp::ServicesQoS().reliable().keep_last(1000);
+  const uint64_t last_conflict_version =
+    first_conflict_version + N_negotiations;
+  const std::size_t expected = N_negotiations * count_tables(
+    participants.size());
+
+  std::atomic<std::size_t> proposals{0};
+  std::atomic<int64_t> last_proposal{0};
+  auto proposal_sub = node->create_subscription<Proposal>(
+    rmf_traffic_ros2::NegotiationProposalTopicName, qos,
+    [&](const Proposal::UniquePtr msg)
+    {
+      if (msg->conflict_version < first_conflict_version
+      || last_conflict_version <= msg->conflict_version)
+        return;
+
+      last_proposal = Clock::now().time_since_epoch().count();
+      ++proposals;
+    });
+
+  auto notice_pub = node->create_publisher<Notice>(
+    rmf_traffic_ros2::NegotiationNoticeTopicName, qos);
+
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  std::thread spin_thread([&]() { executor.spin(); });
+
+  const auto discovery_timeout = Clock::now() + 10s;
+  while (notice_pub->get_subscription_count() == 0
+    && Clock::now() < discovery_timeout)
+  {
+    std::this_thread::sleep_for(10ms);
+  }
+
+  const auto start = Clock::now();
+  for (uint64_t v = first_conflict_version; v < last_conflict_version; ++v)
+  {
+    Notice notice;
+    notice.conflict_version = v;
+    notice.participants = participants;
+    notice_pub->publish(notice);
+  }
+
+  const auto timeout = start + 60s;
+  while (proposals < expected && Clock::now() < timeout)
+    std::this_thread::sleep_for(1ms);
+
+  executor.cancel();
+  spin_thread.join();
+
+  return RunResult{
+    proposals >= expected,
+    Clock::time_point(Clock::duration(last_proposal.load())) - start,
+    proposals.load()
+  };
+}
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+  const std::size_t N_negotiations = argc > 1 ? std::stoul(argv[1]) : 10;
+  const std::size_t N_participants = argc > 2 ? std::stoul(argv[2]) : 4;
+  const std::chrono::microseconds planning_cost(
+    static_cast<int64_t>(1000.0 * (argc > 3 ? std::stod(argv[3]) : 2.0)));
+  const std::size_t default_threads =
+    std::max(2u, std::thread::hardware_concurrency());
+  const std::size_t N_threads =
+    argc > 4 ? std::stoul(argv[4]) : default_threads;
+
+  rclcpp::init(argc, argv);
+
+  auto database = std::make_shared<rmf_traffic::schedule::Database>();
+  const rmf_traffic::Profile profile{
+    rmf_traffic::geometry::make_final_convex<
+      rmf_traffic::geometry::Circle>(0.5)
+  };
+
+  std::vector<rmf_traffic::schedule::Participant> schedule_participants;
+  std::vector<rmf_traffic::schedule::ParticipantId> participants;
+  for (std::size_t i = 0; i < N_participants; ++i)
+  {
+    schedule_participants.emplace_back(
+      rmf_traffic::schedule::make_participant(
+        rmf_traffic::schedule::ParticipantDescription{
+          "participant_" + std::to_string(i),
+          "benchmark",
+          rmf_traffic::schedule::ParticipantDescription::Rx::Responsive,
+          profile
+        },
+        database));
+
+    participants.push_back(schedule_participants.back().id());
+  }
+
+  std::cout << "Negotiations:          " << N_negotiations
+            << "\nParticipants:          " << N_participants
+            << "\nTables per negotiation: " << count_tables(N_participants)
+            << "\nPlanning time [ms]:    "
+            << std::chrono::duration<double, std::milli>(planning_cost).count();
+
+  int status = 0;
+  uint64_t conflict_version = 0;
+  for (const std::size_t threads : {std::size_t(1), N_threads})
+  {
+    const auto result = run(
+      threads, conflict_version, N_negotiations,
+      participants, database, planning_cost);
+    conflict_version += N_negotiations;
+
+    std::cout << "\n[" << threads << " responder thread(s)]"
+              << "\n  Proposals:           " << result.proposals;
+
+    if (!result.finished)
+    {
+      std::cout << "\n  Timed out before every table received a proposal";
+      status = 1;
+      continue;
+    }
+
+    std::cout << "\n  Total time [ms]:     "
+              << std::chrono::duration<double, std::milli>(
+      result.duration).count();
+  }
+
+  std::cout << std::endl;
+  rclcpp::shutdown();
+  return status;
+}
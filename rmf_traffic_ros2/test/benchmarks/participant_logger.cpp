@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 2022 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+// This benchmark compares the YamlLogger and BinaryLogger implementations of
+// the participant registry's persistence. It measures how long it takes to
+// register a growing number of participants, to update some of their
+// descriptions, and to restore a registry from the resulting file.
+//
+// Usage:
+//   benchmark_participant_logger [participants] [updates]
+
+#include <rmf_traffic_ros2/schedule/ParticipantRegistry.hpp>
+
+#include <rmf_traffic/geometry/Circle.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+
+using rmf_traffic_ros2::schedule::AbstractParticipantLogger;
+using rmf_traffic_ros2::schedule::BinaryLogger;
+using rmf_traffic_ros2::schedule::ParticipantRegistry;
+using rmf_traffic_ros2::schedule::YamlLogger;
+
+using Clock = std::chrono::steady_clock;
+using LoggerFactory =
+  std::function<std::unique_ptr<AbstractParticipantLogger>()>;
+
+//==============================================================================
+rmf_traffic::schedule::ParticipantDescription make_description(
+  const std::size_t i,
+  const double radius)
+{
+  return rmf_traffic::schedule::ParticipantDescription(
+    "participant_" + std::to_string(i),
+    "benchmark",
+    rmf_traffic::schedule::ParticipantDescription::Rx::Responsive,
+    rmf_traffic::Profile{
+      rmf_traffic::geometry::make_final_convex<
+        rmf_traffic::geometry::Circle>(radius)
+    });
+}
+
+//==============================================================================
+double to_ms(const Clock::duration d)
+{
+  return std::chrono::duration<double, std::milli>(d).count();
+}
+
+//==============================================================================
+void run(
+  const std::string& name,
+  const std::string& file_path,
+  const LoggerFactory& make_logger,
+  const std::size_t N_participants,
+  const std::size_t N_updates)
+{
+  std::remove(file_path.c_str());
+
+  Clock::duration register_time;
+  Clock::duration update_time;
+  {
+    auto database = std::make_shared<rmf_traffic::schedule::Database>();
+    ParticipantRegistry registry(make_logger(), database);
+
+    const auto register_start = Clock::now();
+    for (std::size_t i = 0; i < N_participants; ++i)
+      registry.add_or_retrieve_participant(make_description(i, 0.5));
+    register_time = Clock::now() - register_start;
+
+    const auto update_start = Clock::now();
+    for (std::size_t i = 0; i < N_updates; ++i)
+    {
+      registry.add_or_retrieve_participant(
+        make_description(i % N_participants, 0.5 + 0.1*(i+1)));
+    }
+    update_time = Clock::now() - update_start;
+  }
+
+  const auto file_size = std::filesystem::file_size(file_path);
+
+  const auto restore_start = Clock::now();
+  auto database = std::make_shared<rmf_traffic::schedule::Database>();
+  ParticipantRegistry registry(make_logger(), database);
+  const auto restore_time = Clock::now() - restore_start;
+
+  if (database->participant_ids().size() != N_participants)
+  {
+    std::cerr << name << " restored " << database->participant_ids().size()
+              << " participants instead of " << N_participants << std::endl;
+  }
+
+  std::cout << name
+            << "\n  Register [ms]:         " << to_ms(register_time)
+            << "\n  Per registration [us]: "
+            << 1000.0 * to_ms(register_time) / N_participants
+            << "\n  Update [ms]:           " << to_ms(update_time)
+            << "\n  Restore [ms]:          " << to_ms(restore_time)
+            << "\n  File size [bytes]:     " << file_size
+            << std::endl;
+
+  std::remove(file_path.c_str());
+}
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+  const std::size_t N_participants = argc > 1 ? std::stoul(argv[1]) : 2000;
+  const std::size_t N_updates = argc > 2 ? std::stoul(argv[2]) : 200;
+
+  std::cout << "Participants: " << N_participants
+            << "\nUpdates:      " << N_updates << std::endl;
+
+  const std::string yaml_path = "benchmark_participant_logger.yaml";
+  run(
+    "YamlLogger", yaml_path,
+    [&]() { return std::make_unique<YamlLogger>(yaml_path); },
+    N_participants, N_updates);
+
+  const std::string binary_path = "benchmark_participant_logger.log";
+  run(
+    "BinaryLogger", binary_path,
+    [&]() { return std::make_unique<BinaryLogger>(binary_path); },
+    N_participants, N_updates);
+
+  return 0;
+}
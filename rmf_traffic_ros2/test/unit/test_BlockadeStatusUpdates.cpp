@@ -0,0 +1,306 @@
+/*
+ * Copyright (C) 2022 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <rmf_traffic_ros2/StandardNames.hpp>
+#include <rmf_traffic_ros2/blockade/Node.hpp>
+#include <rmf_traffic_ros2/blockade/Writer.hpp>
+
+#include <rmf_traffic_msgs/msg/blockade_heartbeat.hpp>
+
+#include <rclcpp/executors/single_threaded_executor.hpp>
+
+#include <rmf_utils/catch.hpp>
+
+#include <optional>
+
+using HeartbeatMsg = rmf_traffic_msgs::msg::BlockadeHeartbeat;
+using StatusMsg = rmf_traffic_msgs::msg::BlockadeStatus;
+using Checkpoint = rmf_traffic::blockade::Writer::Checkpoint;
+using ReservedRange = rmf_traffic::blockade::ReservedRange;
+using ReservationId = rmf_traffic::blockade::ReservationId;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+//==============================================================================
+template<typename Condition>
+bool spin_until(
+  rclcpp::Executor& executor,
+  Condition condition,
+  const std::chrono::nanoseconds timeout)
+{
+  const auto stop_time = Clock::now() + timeout;
+  while (Clock::now() < stop_time)
+  {
+    if (condition())
+      return true;
+
+    executor.spin_some(std::chrono::milliseconds(10));
+  }
+
+  return condition();
+}
+
+//==============================================================================
+bool mentions(const HeartbeatMsg& msg, const std::size_t participant)
+{
+  for (const auto& status : msg.statuses)
+  {
+    if (status.participant == participant)
+      return true;
+  }
+
+  return false;
+}
+
+//==============================================================================
+std::vector<Checkpoint> make_path(const double y)
+{
+  std::vector<Checkpoint> path;
+  for (std::size_t i = 0; i < 4; ++i)
+    path.push_back(Checkpoint{Eigen::Vector2d{2.0 * i, y}, "test_map", true});
+
+  return path;
+}
+
+//==============================================================================
+StatusMsg make_status(
+  const std::size_t participant,
+  const ReservationId reservation,
+  const uint64_t last_reached,
+  const uint64_t assignment_end)
+{
+  return rmf_traffic_msgs::build<StatusMsg>()
+    .participant(participant)
+    .reservation(reservation)
+    .any_ready(false)
+    .last_ready(0)
+    .last_reached(last_reached)
+    .assignment_begin(0)
+    .assignment_end(assignment_end);
+}
+} // anonymous namespace
+
+//==============================================================================
+SCENARIO("Blockade node publishes only changed statuses between heartbeats")
+{
+  using namespace std::chrono_literals;
+
+  auto context = std::make_shared<rclcpp::Context>();
+  context->init(0, nullptr);
+
+  const auto blockade_node = rmf_traffic_ros2::blockade::make_node(
+    "test_blockade_status_updates_moderator",
+    rclcpp::NodeOptions().context(context));
+
+  const auto node = std::make_shared<rclcpp::Node>(
+    "test_blockade_status_updates", rclcpp::NodeOptions().context(context));
+
+  std::vector<HeartbeatMsg> updates;
+  std::vector<std::pair<Clock::time_point, HeartbeatMsg>> heartbeats;
+  const auto updates_sub = node->create_subscription<HeartbeatMsg>(
+    rmf_traffic_ros2::BlockadeStatusUpdatesTopicName,
+    rclcpp::SystemDefaultsQoS().keep_last(100).reliable(),
+    [&updates](const HeartbeatMsg::UniquePtr msg)
+    {
+      updates.push_back(*msg);
+    });
+
+  const auto heartbeat_sub = node->create_subscription<HeartbeatMsg>(
+    rmf_traffic_ros2::BlockadeHeartbeatTopicName,
+    rclcpp::SystemDefaultsQoS().keep_last(10).reliable(),
+    [&heartbeats](const HeartbeatMsg::UniquePtr msg)
+    {
+      heartbeats.push_back({Clock::now(), *msg});
+    });
+
+  rclcpp::ExecutorOptions options;
+  options.context = context;
+  rclcpp::executors::SingleThreadedExecutor executor(options);
+  executor.add_node(blockade_node);
+  executor.add_node(node);
+
+  const auto writer = rmf_traffic_ros2::blockade::Writer::make(*node);
+  const auto ignore_range = [](ReservationId, const ReservedRange&) {};
+  std::optional<rmf_traffic::blockade::Participant> participant_a =
+    writer->make_participant(1, 0.5, ignore_range);
+  std::optional<rmf_traffic::blockade::Participant> participant_b =
+    writer->make_participant(2, 0.5, ignore_range);
+
+  // Wait until the moderator is receiving from the writer and we are receiving
+  // from the moderator.
+  REQUIRE(spin_until(executor, [&]() { return !heartbeats.empty(); }, 5s));
+  REQUIRE(
+    spin_until(
+      executor, [&]()
+      {
+        return blockade_node->count_subscribers(
+          rmf_traffic_ros2::BlockadeSetTopicName) > 0;
+      }, 5s));
+
+  participant_a->set(make_path(0.0));
+  REQUIRE(
+    spin_until(
+      executor, [&]()
+      {
+        return !updates.empty() && mentions(updates.back(), 1);
+      }, 5s));
+
+  // Setting a reservation for B should not repeat the unchanged status of A
+  const std::size_t updates_before_b = updates.size();
+  participant_b->set(make_path(100.0));
+  REQUIRE(
+    spin_until(
+      executor, [&]()
+      {
+        return updates.size() > updates_before_b && mentions(updates.back(), 2);
+      }, 5s));
+
+  for (std::size_t i = updates_before_b; i < updates.size(); ++i)
+    CHECK_FALSE(mentions(updates[i], 1));
+
+  // Line up with the periodic heartbeat so that the next one is about a second
+  // away, and then remove A.
+  const std::size_t heartbeats_before_sync = heartbeats.size();
+  REQUIRE(
+    spin_until(
+      executor, [&]() { return heartbeats.size() > heartbeats_before_sync; },
+      5s));
+
+  const std::size_t updates_before_removal = updates.size();
+  const std::size_t heartbeats_before_removal = heartbeats.size();
+  const auto removed_at = Clock::now();
+  participant_a.reset();
+
+  // The removal cannot be expressed as an update, so a full heartbeat is
+  // published right away instead of waiting for the periodic one.
+  REQUIRE(
+    spin_until(
+      executor, [&]()
+      {
+        return heartbeats.size() > heartbeats_before_removal
+        && !mentions(heartbeats.back().second, 1);
+      }, 5s));
+
+  CHECK(heartbeats.back().first - removed_at < 500ms);
+  CHECK(mentions(heartbeats.back().second, 2));
+  for (std::size_t i = updates_before_removal; i < updates.size(); ++i)
+    CHECK_FALSE(mentions(updates[i], 1));
+
+  context->shutdown("Finished test");
+}
+
+//==============================================================================
+SCENARIO("Blockade writer orders heartbeats against status updates")
+{
+  using namespace std::chrono_literals;
+
+  auto context = std::make_shared<rclcpp::Context>();
+  context->init(0, nullptr);
+
+  // This node stands in for the blockade moderator
+  const auto moderator = std::make_shared<rclcpp::Node>(
+    "test_blockade_writer_moderator", rclcpp::NodeOptions().context(context));
+
+  const auto heartbeat_pub = moderator->create_publisher<HeartbeatMsg>(
+    rmf_traffic_ros2::BlockadeHeartbeatTopicName,
+    rclcpp::SystemDefaultsQoS().keep_last(10).reliable());
+
+  const auto updates_pub = moderator->create_publisher<HeartbeatMsg>(
+    rmf_traffic_ros2::BlockadeStatusUpdatesTopicName,
+    rclcpp::SystemDefaultsQoS().keep_last(100).reliable());
+
+  const auto node = std::make_shared<rclcpp::Node>(
+    "test_blockade_writer", rclcpp::NodeOptions().context(context));
+
+  rclcpp::ExecutorOptions options;
+  options.context = context;
+  rclcpp::executors::SingleThreadedExecutor executor(options);
+  executor.add_node(moderator);
+  executor.add_node(node);
+
+  const auto writer = rmf_traffic_ros2::blockade::Writer::make(*node);
+  std::vector<std::pair<ReservationId, ReservedRange>> ranges;
+  auto participant = writer->make_participant(
+    1, 0.5,
+    [&ranges](const ReservationId reservation, const ReservedRange& range)
+    {
+      ranges.push_back({reservation, range});
+    });
+
+  participant.set(make_path(0.0));
+  REQUIRE(participant.reservation_id().has_value());
+  const auto reservation = *participant.reservation_id();
+
+  REQUIRE(
+    spin_until(
+      executor, [&]()
+      {
+        return heartbeat_pub->get_subscription_count() > 0
+        && updates_pub->get_subscription_count() > 0;
+      }, 5s));
+
+  const auto publish = [](const auto& pub, std::vector<StatusMsg> statuses)
+    {
+      pub->publish(
+        rmf_traffic_msgs::build<HeartbeatMsg>()
+        .statuses(std::move(statuses))
+        .has_gridlock(false));
+    };
+
+  const auto wait_for_range = [&](const uint64_t end)
+    {
+      return spin_until(
+        executor, [&]()
+        {
+          return !ranges.empty() && ranges.back().second.end == end;
+        }, 5s);
+    };
+
+  WHEN("A heartbeat that was published before an update arrives after it")
+  {
+    publish(updates_pub, {make_status(1, reservation, 2, 3)});
+    REQUIRE(wait_for_range(3));
+
+    // This heartbeat is behind the update, so it should be dropped
+    publish(heartbeat_pub, {make_status(1, reservation, 1, 2)});
+
+    // The next heartbeat is in line with the update, so it gets applied
+    publish(heartbeat_pub, {make_status(1, reservation, 2, 3)});
+    const std::size_t count = ranges.size();
+    REQUIRE(
+      spin_until(executor, [&]() { return ranges.size() > count; }, 5s));
+
+    for (const auto& r : ranges)
+      CHECK(r.second.end != 2);
+  }
+
+  WHEN("The assigned range shrinks without any progress")
+  {
+    publish(updates_pub, {make_status(1, reservation, 1, 3)});
+    REQUIRE(wait_for_range(3));
+
+    // A release can shrink the range within the same reservation and
+    // progress, so that status should not be mistaken for an old one.
+    publish(updates_pub, {make_status(1, reservation, 1, 2)});
+    CHECK(wait_for_range(2));
+
+    publish(heartbeat_pub, {make_status(1, reservation, 1, 1)});
+    CHECK(wait_for_range(1));
+  }
+
+  context->shutdown("Finished test");
+}
@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2022 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <rmf_traffic/geometry/Circle.hpp>
+#include <rmf_traffic/schedule/Database.hpp>
+#include <rmf_traffic/schedule/Mirror.hpp>
+#include <rmf_traffic/schedule/Participant.hpp>
+
+#include <rmf_utils/catch.hpp>
+
+#include "../../src/rmf_traffic_ros2/schedule/internal_ConflictBroadPhase.hpp"
+
+using namespace std::chrono_literals;
+using rmf_traffic_ros2::schedule::ConflictBroadPhase;
+
+//==============================================================================
+rmf_traffic::Route make_route(
+  const std::string& map,
+  const rmf_traffic::Time start,
+  const Eigen::Vector3d& p0,
+  const Eigen::Vector3d& p1)
+{
+  rmf_traffic::Trajectory trajectory;
+  trajectory.insert(start, p0, Eigen::Vector3d::Zero());
+  trajectory.insert(start + 10s, p1, Eigen::Vector3d::Zero());
+  return rmf_traffic::Route(map, std::move(trajectory));
+}
+
+//==============================================================================
+SCENARIO("Broad-phase index of schedule routes")
+{
+  auto database = std::make_shared<rmf_traffic::schedule::Database>();
+  const rmf_traffic::Profile profile{
+    rmf_traffic::geometry::make_final_convex<
+      rmf_traffic::geometry::Circle>(0.5)
+  };
+
+  const auto make_participant = [&](const std::string& name)
+    {
+      return rmf_traffic::schedule::make_participant(
+        rmf_traffic::schedule::ParticipantDescription{
+          name,
+          "test_ConflictBroadPhase",
+          rmf_traffic::schedule::ParticipantDescription::Rx::Responsive,
+          profile
+        },
+        database);
+    };
+
+  auto p0 = make_participant("p0");
+  auto p1 = make_participant("p1");
+  auto p2 = make_participant("p2");
+
+  rmf_traffic::schedule::ParticipantDescriptionsMap descriptions;
+  for (const auto* p : {&p0, &p1, &p2})
+    descriptions.insert({p->id(), p->description()});
+
+  const auto now = std::chrono::steady_clock::now();
+  const auto crossing = make_route("L1", now, {0, 0, 0}, {20, 0, 0});
+  p0.set(p0.assign_plan_id(), {crossing});
+  p1.set(
+    p1.assign_plan_id(),
+    {make_route("L1", now, {10, -10, 0}, {10, 10, 0})});
+  p2.set(
+    p2.assign_plan_id(),
+    {make_route("L1", now, {100, 100, 0}, {120, 100, 0})});
+
+  rmf_traffic::schedule::Mirror mirror;
+  mirror.update_participants_info(descriptions);
+  const auto query_all = rmf_traffic::schedule::query_all();
+  REQUIRE(mirror.update(database->changes(query_all, std::nullopt)));
+
+  ConflictBroadPhase broad_phase;
+  broad_phase.update(database->query(query_all, 0), mirror);
+  CHECK(broad_phase.participant_count() == 3);
+
+  WHEN("Looking for candidates of a route")
+  {
+    const auto candidates = broad_phase.candidates(crossing, profile);
+
+    THEN("Only nearby routes are candidates")
+    {
+      CHECK(candidates.count(p0.id()) == 1);
+      CHECK(candidates.count(p1.id()) == 1);
+      CHECK(candidates.count(p2.id()) == 0);
+    }
+  }
+
+  WHEN("Looking for candidates on a different map")
+  {
+    const auto other = make_route("L2", now, {0, 0, 0}, {20, 0, 0});
+    CHECK(broad_phase.candidates(other, profile).empty());
+  }
+
+  WHEN("Looking for candidates at a different time")
+  {
+    const auto later = make_route("L1", now + 1h, {0, 0, 0}, {20, 0, 0});
+    CHECK(broad_phase.candidates(later, profile).empty());
+  }
+
+  WHEN("A participant's itinerary is cleared")
+  {
+    const auto version = database->latest_version();
+    p1.clear();
+    REQUIRE(mirror.update(database->changes(query_all, version)));
+    broad_phase.update(database->query(query_all, version), mirror);
+
+    THEN("Its routes are no longer candidates")
+    {
+      const auto candidates = broad_phase.candidates(crossing, profile);
+      CHECK(candidates.count(p0.id()) == 1);
+      CHECK(candidates.count(p1.id()) == 0);
+    }
+  }
+}
@@ -0,0 +1,158 @@
+/*
+ * Copyright (C) 2022 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <rmf_traffic/geometry/Circle.hpp>
+#include <rmf_traffic/schedule/Database.hpp>
+#include <rmf_traffic/schedule/Mirror.hpp>
+#include <rmf_traffic/schedule/Participant.hpp>
+
+#include <rmf_utils/catch.hpp>
+
+#include "../../src/rmf_traffic_ros2/schedule/internal_DependencyIndex.hpp"
+
+using namespace std::chrono_literals;
+using rmf_traffic_ros2::schedule::DependencyIndex;
+
+//==============================================================================
+SCENARIO("Reverse index of schedule dependencies")
+{
+  auto database = std::make_shared<rmf_traffic::schedule::Database>();
+  const rmf_traffic::Profile profile{
+    rmf_traffic::geometry::make_final_convex<
+      rmf_traffic::geometry::Circle>(0.5)
+  };
+
+  const auto make_participant = [&](const std::string& name)
+    {
+      return rmf_traffic::schedule::make_participant(
+        rmf_traffic::schedule::ParticipantDescription{
+          name,
+          "test_DependencyIndex",
+          rmf_traffic::schedule::ParticipantDescription::Rx::Responsive,
+          profile
+        },
+        database);
+    };
+
+  auto p0 = make_participant("p0");
+  auto p1 = make_participant("p1");
+  auto p2 = make_participant("p2");
+  auto p3 = make_participant("p3");
+
+  rmf_traffic::schedule::ParticipantDescriptionsMap descriptions;
+  for (const auto* p : {&p0, &p1, &p2, &p3})
+    descriptions.insert({p->id(), p->description()});
+
+  const auto now = std::chrono::steady_clock::now();
+  const auto make_route = [&](const double y)
+    {
+      rmf_traffic::Trajectory trajectory;
+      trajectory.insert(now, {0, y, 0}, Eigen::Vector3d::Zero());
+      trajectory.insert(now + 10s, {20, y, 0}, Eigen::Vector3d::Zero());
+      return rmf_traffic::Route("L1", std::move(trajectory));
+    };
+
+  // p1 depends on p0 and p2 depends on p1, while p3 is independent
+  const auto p0_plan = p0.assign_plan_id();
+  p0.set(p0_plan, {make_route(0)});
+
+  auto p1_route = make_route(10);
+  const auto p1_plan = p1.assign_plan_id();
+  p1_route.add_dependency(1, {p0.id(), p0_plan, 0, 1});
+  p1.set(p1_plan, {p1_route});
+
+  auto p2_route = make_route(20);
+  p2_route.add_dependency(1, {p1.id(), p1_plan, 0, 1});
+  p2.set(p2.assign_plan_id(), {p2_route});
+
+  p3.set(p3.assign_plan_id(), {make_route(30)});
+
+  rmf_traffic::schedule::Mirror mirror;
+  mirror.update_participants_info(descriptions);
+  const auto query_all = rmf_traffic::schedule::query_all();
+
+  DependencyIndex index;
+  const auto sync = [&]()
+    {
+      const auto last_checked_version = mirror.latest_version().value_or(0);
+      REQUIRE(mirror.update(
+          database->changes(query_all, mirror.latest_version())));
+      index.update(
+        database->query(query_all, last_checked_version), mirror);
+    };
+
+  sync();
+  CHECK(index.participant_count() == 2);
+
+  const auto* p0_dependents = index.dependents(p0.id());
+  REQUIRE(p0_dependents);
+  CHECK(p0_dependents->size() == 1);
+  CHECK(p0_dependents->count(p1.id()) == 1);
+  CHECK_FALSE(index.dependents(p2.id()));
+  CHECK_FALSE(index.dependents(p3.id()));
+
+  WHEN("A conflict involving p0 is expanded")
+  {
+    DependencyIndex::ParticipantSet conflict{p0.id(), p3.id()};
+    index.expand(conflict);
+
+    THEN("Transitive dependents are included")
+    {
+      CHECK(conflict == DependencyIndex::ParticipantSet{
+          p0.id(), p1.id(), p2.id(), p3.id()});
+    }
+  }
+
+  WHEN("A conflict involving only p2 is expanded")
+  {
+    DependencyIndex::ParticipantSet conflict{p2.id(), p3.id()};
+    index.expand(conflict);
+
+    THEN("Nothing is added")
+    {
+      CHECK(conflict == DependencyIndex::ParticipantSet{p2.id(), p3.id()});
+    }
+  }
+
+  WHEN("p1 replans without any dependencies")
+  {
+    p1.set(p1.assign_plan_id(), {make_route(10)});
+    sync();
+
+    THEN("p1 is no longer a dependent of p0")
+    {
+      CHECK_FALSE(index.dependents(p0.id()));
+      CHECK(index.participant_count() == 1);
+
+      DependencyIndex::ParticipantSet conflict{p0.id()};
+      index.expand(conflict);
+      CHECK(conflict == DependencyIndex::ParticipantSet{p0.id()});
+    }
+  }
+
+  WHEN("p2 clears its itinerary")
+  {
+    p2.clear();
+    sync();
+
+    THEN("p2 is no longer a dependent of p1")
+    {
+      CHECK_FALSE(index.dependents(p1.id()));
+      CHECK(index.participant_count() == 1);
+    }
+  }
+}
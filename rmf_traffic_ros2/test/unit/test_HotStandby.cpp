@@ -0,0 +1,278 @@
+/*
+ * Copyright (C) 2022 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <rmf_traffic/geometry/Circle.hpp>
+
+#include <rmf_traffic_ros2/Time.hpp>
+#include <rmf_traffic_ros2/schedule/Itinerary.hpp>
+#include <rmf_traffic_ros2/schedule/MonitorNode.hpp>
+#include <rmf_traffic_ros2/schedule/ParticipantDescription.hpp>
+
+#include <rclcpp/executors/single_threaded_executor.hpp>
+
+#include <rmf_utils/catch.hpp>
+
+#include <filesystem>
+#include <future>
+#include <iostream>
+
+#include "../../src/rmf_traffic_ros2/schedule/internal_MonitorNode.hpp"
+
+using rmf_traffic_ros2::schedule::MonitorNode;
+using rmf_traffic_ros2::schedule::ScheduleNode;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+//==============================================================================
+class SpinningNode
+{
+public:
+
+  SpinningNode(
+    std::shared_ptr<rclcpp::Node> node,
+    std::shared_ptr<rclcpp::Context> context)
+  : _node(std::move(node))
+  {
+    rclcpp::ExecutorOptions options;
+    options.context = std::move(context);
+    _executor =
+      std::make_shared<rclcpp::executors::SingleThreadedExecutor>(options);
+    _executor->add_node(_node);
+    _thread = std::thread([executor = _executor]() { executor->spin(); });
+  }
+
+  void stop()
+  {
+    if (!_executor)
+      return;
+
+    _executor->cancel();
+    _thread.join();
+    _executor->remove_node(_node);
+    _executor.reset();
+  }
+
+  ~SpinningNode()
+  {
+    stop();
+  }
+
+private:
+  std::shared_ptr<rclcpp::Node> _node;
+  std::shared_ptr<rclcpp::executors::SingleThreadedExecutor> _executor;
+  std::thread _thread;
+};
+
+//==============================================================================
+std::shared_ptr<rclcpp::Context> make_context()
+{
+  auto context = std::make_shared<rclcpp::Context>();
+  context->init(0, nullptr);
+  return context;
+}
+
+//==============================================================================
+template<typename Condition>
+bool wait_for(Condition condition, const std::chrono::nanoseconds timeout)
+{
+  const auto stop_time = Clock::now() + timeout;
+  while (Clock::now() < stop_time)
+  {
+    if (condition())
+      return true;
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+
+  return condition();
+}
+
+} // anonymous namespace
+
+//==============================================================================
+SCENARIO("Hot standby takes over when the primary schedule node is killed")
+{
+  using namespace std::chrono_literals;
+
+  const auto log_dir =
+    std::filesystem::temp_directory_path() / "rmf_hot_standby_test";
+  std::filesystem::remove_all(log_dir);
+  std::filesystem::create_directories(log_dir);
+
+  const std::vector<rclcpp::Parameter> parameters = {
+    rclcpp::Parameter("heartbeat_period", 200),
+    rclcpp::Parameter("hot_standby", true),
+    rclcpp::Parameter(
+      "log_file_location", (log_dir / "registry.yaml").string())
+  };
+
+  // The primary node gets its own context so that killing it looks the same
+  // to the standby as a schedule node process going away.
+  auto primary_context = make_context();
+  auto primary = std::make_shared<ScheduleNode>(
+    rclcpp::NodeOptions()
+    .context(primary_context)
+    .parameter_overrides(parameters));
+  auto primary_spin = std::make_unique<SpinningNode>(primary, primary_context);
+
+  // Register two participants that will be conflicting with each other
+  const rmf_traffic::Profile profile{
+    rmf_traffic::geometry::make_final_convex<
+      rmf_traffic::geometry::Circle>(0.5)
+  };
+
+  std::vector<ScheduleNode::RegisterParticipant::Response> registrations;
+  for (const std::string name : {"participant_a", "participant_b"})
+  {
+    auto request =
+      std::make_shared<ScheduleNode::RegisterParticipant::Request>();
+    request->description = rmf_traffic_ros2::convert(
+      rmf_traffic::schedule::ParticipantDescription{
+        name,
+        "test_HotStandby",
+        rmf_traffic::schedule::ParticipantDescription::Rx::Responsive,
+        profile
+      });
+
+    auto response =
+      std::make_shared<ScheduleNode::RegisterParticipant::Response>();
+    primary->register_participant(nullptr, request, response);
+    REQUIRE(response->error.empty());
+    registrations.push_back(*response);
+  }
+
+  auto standby_context = make_context();
+  std::promise<std::shared_ptr<rclcpp::Node>> takeover_promise;
+  auto takeover_future = takeover_promise.get_future();
+  Clock::time_point takeover_time;
+
+  auto monitor_node = rmf_traffic_ros2::schedule::make_monitor_node(
+    [&](std::shared_ptr<rclcpp::Node> node)
+    {
+      takeover_time = Clock::now();
+      takeover_promise.set_value(node);
+    },
+    rclcpp::NodeOptions()
+    .context(standby_context)
+    .parameter_overrides(parameters),
+    10s);
+
+  REQUIRE(monitor_node);
+  const auto monitor = std::dynamic_pointer_cast<MonitorNode>(monitor_node);
+  REQUIRE(monitor);
+  REQUIRE(monitor->standby_node);
+  CHECK(monitor->standby_node->standby);
+  auto monitor_spin =
+    std::make_unique<SpinningNode>(monitor_node, standby_context);
+
+  // Negotiation notices are not kept around for late subscribers
+  const bool notices_subscribed = wait_for(
+    [&]()
+    {
+      return primary->conflict_notice_pub->get_subscription_count() > 0;
+    }, 5s);
+  REQUIRE(notices_subscribed);
+
+  // Give both participants the same route so the primary opens a negotiation
+  const auto now = rmf_traffic_ros2::convert(primary->now());
+  rmf_traffic::Trajectory trajectory;
+  trajectory.insert(now, Eigen::Vector3d::Zero(), Eigen::Vector3d::Zero());
+  trajectory.insert(
+    now + 10s, Eigen::Vector3d{10.0, 0.0, 0.0}, Eigen::Vector3d::Zero());
+  const rmf_traffic::schedule::Itinerary itinerary = {
+    rmf_traffic::Route("test_map", trajectory)
+  };
+
+  for (const auto& registration : registrations)
+  {
+    ScheduleNode::ItinerarySet set;
+    set.participant = registration.participant_id;
+    set.plan = registration.last_plan_id + 1;
+    set.itinerary = rmf_traffic_ros2::convert(itinerary);
+    set.storage_base = registration.next_storage_base;
+    set.itinerary_version = registration.last_itinerary_version + 1;
+    primary->itinerary_set(set);
+  }
+
+  std::optional<ScheduleNode::Version> conflict_version;
+  const bool negotiation_replicated = wait_for(
+    [&]()
+    {
+      std::lock_guard<std::mutex> lock(
+        monitor->standby_node->active_conflicts_mutex);
+      const auto& negotiations =
+        monitor->standby_node->active_conflicts._negotiations;
+      if (negotiations.empty())
+        return false;
+
+      conflict_version = negotiations.begin()->first;
+      return true;
+    }, 5s);
+  REQUIRE(negotiation_replicated);
+
+  ScheduleNode::Version primary_version;
+  {
+    std::lock_guard<std::mutex> lock(primary->database_mutex);
+    primary_version = primary->database->latest_version();
+  }
+
+  const bool database_replicated = wait_for(
+    [&]()
+    {
+      const auto snapshot =
+        monitor->standby_node->standby_mirror->snapshots()->snapshot();
+      return snapshot->latest_version() == primary_version;
+    }, 5s);
+  REQUIRE(database_replicated);
+
+  // Kill the primary node
+  const auto kill_time = Clock::now();
+  primary_spin.reset();
+  primary.reset();
+  primary_context->shutdown("Killing the primary schedule node");
+
+  REQUIRE(takeover_future.wait_for(5s) == std::future_status::ready);
+  const auto time_to_takeover = takeover_time - kill_time;
+  std::cout << "Time to takeover: "
+            << std::chrono::duration<double, std::milli>(
+    time_to_takeover).count()
+            << "ms" << std::endl;
+  CHECK(time_to_takeover < 1s);
+
+  const auto new_primary =
+    std::dynamic_pointer_cast<ScheduleNode>(takeover_future.get());
+  REQUIRE(new_primary);
+  CHECK_FALSE(new_primary->standby);
+  CHECK(new_primary->database->participant_ids().size() == 2);
+  CHECK(new_primary->database->latest_version() == primary_version);
+
+  {
+    std::lock_guard<std::mutex> lock(new_primary->active_conflicts_mutex);
+    CHECK(new_primary->active_conflicts.negotiation(*conflict_version));
+    for (const auto& registration : registrations)
+    {
+      const auto& versions = new_primary->active_conflicts._version;
+      const auto it = versions.find(registration.participant_id);
+      REQUIRE(it != versions.end());
+      CHECK(it->second == *conflict_version);
+    }
+  }
+
+  monitor_spin.reset();
+  standby_context->shutdown("Finished test");
+  std::filesystem::remove_all(log_dir);
+}
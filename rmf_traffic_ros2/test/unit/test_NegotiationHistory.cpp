@@ -0,0 +1,179 @@
+/*
+ * Copyright (C) 2022 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <rmf_traffic/geometry/Circle.hpp>
+#include <rmf_traffic/schedule/Database.hpp>
+#include <rmf_traffic/schedule/Participant.hpp>
+
+#include <rmf_traffic_ros2/StandardNames.hpp>
+#include <rmf_traffic_ros2/schedule/Negotiation.hpp>
+
+#include <rmf_traffic_msgs/msg/negotiation_conclusion.hpp>
+#include <rmf_traffic_msgs/msg/negotiation_notice.hpp>
+
+#include <rclcpp/executors/single_threaded_executor.hpp>
+
+#include <rmf_utils/catch.hpp>
+
+using Notice = rmf_traffic_msgs::msg::NegotiationNotice;
+using Conclusion = rmf_traffic_msgs::msg::NegotiationConclusion;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+//==============================================================================
+template<typename Condition>
+bool spin_until(
+  rclcpp::Executor& executor,
+  Condition condition,
+  const std::chrono::nanoseconds timeout)
+{
+  const auto stop_time = Clock::now() + timeout;
+  while (Clock::now() < stop_time)
+  {
+    if (condition())
+      return true;
+
+    executor.spin_some(std::chrono::milliseconds(10));
+  }
+
+  return condition();
+}
+} // anonymous namespace
+
+//==============================================================================
+SCENARIO("Concluded negotiations are kept as a bounded history of summaries")
+{
+  using namespace std::chrono_literals;
+
+  auto context = std::make_shared<rclcpp::Context>();
+  context->init(0, nullptr);
+
+  auto node = std::make_shared<rclcpp::Node>(
+    "test_negotiation_history", rclcpp::NodeOptions().context(context));
+
+  auto database = std::make_shared<rmf_traffic::schedule::Database>();
+  const rmf_traffic::Profile profile{
+    rmf_traffic::geometry::make_final_convex<
+      rmf_traffic::geometry::Circle>(0.5)
+  };
+
+  std::vector<rmf_traffic::schedule::Participant> schedule_participants;
+  std::vector<rmf_traffic::schedule::ParticipantId> participants;
+  for (const std::string name : {"participant_a", "participant_b"})
+  {
+    schedule_participants.emplace_back(
+      rmf_traffic::schedule::make_participant(
+        rmf_traffic::schedule::ParticipantDescription{
+          name,
+          "test_NegotiationHistory",
+          rmf_traffic::schedule::ParticipantDescription::Rx::Responsive,
+          profile
+        },
+        database));
+
+    participants.push_back(schedule_participants.back().id());
+  }
+
+  rmf_traffic_ros2::schedule::Negotiation negotiation(*node, database);
+  negotiation.set_retained_history_count(3);
+
+  std::size_t responses = 0;
+  std::size_t conclusions = 0;
+  negotiation.on_conclusion([&](uint64_t, bool) { ++conclusions; });
+
+  const auto handle = negotiation.register_negotiator(
+    participants.front(),
+    [&](auto, auto responder)
+    {
+      responder->submit(0, {}, nullptr);
+      ++responses;
+    });
+
+  const auto qos = rclcpp::ServicesQoS().reliable().keep_last(1000);
+  auto notice_pub = node->create_publisher<Notice>(
+    rmf_traffic_ros2::NegotiationNoticeTopicName, qos);
+  auto conclusion_pub = node->create_publisher<Conclusion>(
+    rmf_traffic_ros2::NegotiationConclusionTopicName, qos);
+
+  rclcpp::ExecutorOptions options;
+  options.context = context;
+  rclcpp::executors::SingleThreadedExecutor executor(options);
+  executor.add_node(node);
+
+  // The negotiation is only spun on this thread, so it is safe to inspect it
+  // between the calls to spin_some().
+  REQUIRE(
+    spin_until(
+      executor, [&]()
+      {
+        return notice_pub->get_subscription_count() > 0
+        && conclusion_pub->get_subscription_count() > 0;
+      }, 5s));
+
+  const auto conclude = [&](const uint64_t conflict_version)
+    {
+      const auto expected_responses = responses + 1;
+      Notice notice;
+      notice.conflict_version = conflict_version;
+      notice.participants = participants;
+      notice_pub->publish(notice);
+      REQUIRE(
+        spin_until(
+          executor, [&]() { return responses >= expected_responses; }, 5s));
+
+      const auto expected_conclusions = conclusions + 1;
+      Conclusion conclusion;
+      conclusion.conflict_version = conflict_version;
+      conclusion.resolved = false;
+      conclusion_pub->publish(conclusion);
+      REQUIRE(
+        spin_until(
+          executor, [&]() { return conclusions >= expected_conclusions; },
+          5s));
+    };
+
+  for (uint64_t v = 1; v <= 5; ++v)
+    conclude(v);
+
+  const auto history = negotiation.history();
+  REQUIRE(history.size() == 3);
+  for (std::size_t i = 0; i < history.size(); ++i)
+  {
+    CHECK(history[i].conflict_version == i + 3);
+    CHECK_FALSE(history[i].resolved);
+    CHECK(history[i].participants.size() == 2);
+    CHECK(history[i].resolution.empty());
+    CHECK(history[i].started <= history[i].concluded);
+  }
+
+  // The table trees are dropped unless debug mode is on
+  CHECK_FALSE(negotiation.table_view(5, {participants.front()}));
+
+  negotiation.debug_history(true);
+  conclude(6);
+  CHECK(negotiation.table_view(6, {participants.front()}));
+  CHECK(negotiation.history().back().conflict_version == 6);
+
+  // Shrinking the history keeps the most recent summaries
+  negotiation.set_retained_history_count(2);
+  const auto shrunk = negotiation.history();
+  REQUIRE(shrunk.size() == 2);
+  CHECK(shrunk.front().conflict_version == 5);
+  CHECK(shrunk.back().conflict_version == 6);
+
+  context->shutdown("Finished test");
+}
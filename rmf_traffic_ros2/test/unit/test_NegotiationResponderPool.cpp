@@ -0,0 +1,148 @@
+/*
+ * Copyright (C) 2022 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <rmf_traffic/geometry/Circle.hpp>
+#include <rmf_traffic/schedule/Database.hpp>
+#include <rmf_traffic/schedule/Participant.hpp>
+
+#include <rmf_traffic_ros2/StandardNames.hpp>
+#include <rmf_traffic_ros2/schedule/Negotiation.hpp>
+
+#include <rmf_traffic_msgs/msg/negotiation_notice.hpp>
+
+#include <rclcpp/executors/single_threaded_executor.hpp>
+
+#include <rmf_utils/catch.hpp>
+
+#include <atomic>
+
+using Notice = rmf_traffic_msgs::msg::NegotiationNotice;
+using Clock = std::chrono::steady_clock;
+
+//==============================================================================
+SCENARIO("Responder pool is shrunk while tables are waiting for it")
+{
+  using namespace std::chrono_literals;
+
+  auto context = std::make_shared<rclcpp::Context>();
+  context->init(0, nullptr);
+
+  auto node = std::make_shared<rclcpp::Node>(
+    "test_negotiation_responder_pool", rclcpp::NodeOptions().context(context));
+
+  auto database = std::make_shared<rmf_traffic::schedule::Database>();
+  const rmf_traffic::Profile profile{
+    rmf_traffic::geometry::make_final_convex<
+      rmf_traffic::geometry::Circle>(0.5)
+  };
+
+  std::vector<rmf_traffic::schedule::Participant> schedule_participants;
+  std::vector<rmf_traffic::schedule::ParticipantId> participants;
+  for (const std::string name : {"participant_a", "participant_b"})
+  {
+    schedule_participants.emplace_back(
+      rmf_traffic::schedule::make_participant(
+        rmf_traffic::schedule::ParticipantDescription{
+          name,
+          "test_NegotiationResponderPool",
+          rmf_traffic::schedule::ParticipantDescription::Rx::Responsive,
+          profile
+        },
+        database));
+
+    participants.push_back(schedule_participants.back().id());
+  }
+
+  rmf_traffic_ros2::schedule::Negotiation negotiation(*node, database);
+  negotiation.responder_threads(4);
+  CHECK(negotiation.responder_threads() == 4);
+
+  std::atomic<std::size_t> responses{0};
+  const auto handle = negotiation.register_negotiator(
+    participants.front(),
+    [&](auto, auto responder)
+    {
+      responder->submit(0, {}, nullptr);
+      ++responses;
+    });
+
+  const auto qos = rclcpp::ServicesQoS().reliable().keep_last(1000);
+  auto notice_pub = node->create_publisher<Notice>(
+    rmf_traffic_ros2::NegotiationNoticeTopicName, qos);
+
+  // Everything is spun on this thread, one callback at a time, so we can
+  // change the responder threads after the notice is received but before the
+  // pool gets to answer the tables.
+  rclcpp::ExecutorOptions options;
+  options.context = context;
+  rclcpp::executors::SingleThreadedExecutor executor(options);
+  executor.add_node(node);
+
+  const auto subscribed_before = Clock::now() + 5s;
+  while (notice_pub->get_subscription_count() == 0
+    && Clock::now() < subscribed_before)
+  {
+    executor.spin_once(10ms);
+  }
+  REQUIRE(notice_pub->get_subscription_count() > 0);
+
+  const uint64_t conflict_version = 1;
+  Notice notice;
+  notice.conflict_version = conflict_version;
+  notice.participants = participants;
+  notice_pub->publish(notice);
+
+  const auto received_before = Clock::now() + 5s;
+  while (!negotiation.table_view(conflict_version, {participants.front()})
+    && Clock::now() < received_before)
+  {
+    executor.spin_once(10ms);
+  }
+
+  const auto table = negotiation.table_view(
+    conflict_version, {participants.front()});
+  REQUIRE(table);
+
+  // The table is waiting for the pool
+  REQUIRE(responses == 0);
+  CHECK_FALSE(table->submission());
+
+  WHEN("The pool is shrunk to a single thread")
+  {
+    negotiation.responder_threads(1);
+    CHECK(negotiation.responder_threads() == 1);
+
+    THEN("The waiting tables are answered right away")
+    {
+      CHECK(responses == 1);
+      const auto answered = negotiation.table_view(
+        conflict_version, {participants.front()});
+      REQUIRE(answered);
+      CHECK(answered->submission());
+    }
+
+    AND_THEN("Nothing else is left for the pool to answer")
+    {
+      for (std::size_t i = 0; i < 10; ++i)
+        executor.spin_some(10ms);
+
+      CHECK(responses == 1);
+    }
+  }
+
+  context->shutdown("Finished test");
+}
@@ -0,0 +1,219 @@
+/*
+ * Copyright (C) 2022 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <rmf_traffic/geometry/Circle.hpp>
+#include <rmf_traffic/schedule/Database.hpp>
+#include <rmf_traffic/schedule/Participant.hpp>
+
+#include <rmf_traffic_ros2/StandardNames.hpp>
+#include <rmf_traffic_ros2/schedule/Negotiation.hpp>
+
+#include <rmf_traffic_msgs/msg/negotiation_forfeit.hpp>
+#include <rmf_traffic_msgs/msg/negotiation_notice.hpp>
+#include <rmf_traffic_msgs/msg/negotiation_proposal.hpp>
+#include <rmf_traffic_msgs/msg/negotiation_rejection.hpp>
+
+#include <rclcpp/executors/single_threaded_executor.hpp>
+
+#include <rmf_utils/catch.hpp>
+
+using Notice = rmf_traffic_msgs::msg::NegotiationNotice;
+using Proposal = rmf_traffic_msgs::msg::NegotiationProposal;
+using Rejection = rmf_traffic_msgs::msg::NegotiationRejection;
+using Forfeit = rmf_traffic_msgs::msg::NegotiationForfeit;
+using ResponderPtr = rmf_traffic::schedule::Negotiator::ResponderPtr;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+//==============================================================================
+template<typename Condition>
+bool spin_until(
+  rclcpp::Executor& executor,
+  Condition condition,
+  const std::chrono::nanoseconds timeout)
+{
+  const auto stop_time = Clock::now() + timeout;
+  while (Clock::now() < stop_time)
+  {
+    if (condition())
+      return true;
+
+    executor.spin_some(std::chrono::milliseconds(10));
+  }
+
+  return condition();
+}
+} // anonymous namespace
+
+//==============================================================================
+SCENARIO("Negotiators revise their proposals while a table is open")
+{
+  using namespace std::chrono_literals;
+
+  auto context = std::make_shared<rclcpp::Context>();
+  context->init(0, nullptr);
+
+  auto node = std::make_shared<rclcpp::Node>(
+    "test_negotiation_revisions", rclcpp::NodeOptions().context(context));
+
+  auto database = std::make_shared<rmf_traffic::schedule::Database>();
+  const rmf_traffic::Profile profile{
+    rmf_traffic::geometry::make_final_convex<
+      rmf_traffic::geometry::Circle>(0.5)
+  };
+
+  std::vector<rmf_traffic::schedule::Participant> schedule_participants;
+  std::vector<rmf_traffic::schedule::ParticipantId> participants;
+  for (const std::string name : {"participant_a", "participant_b"})
+  {
+    schedule_participants.emplace_back(
+      rmf_traffic::schedule::make_participant(
+        rmf_traffic::schedule::ParticipantDescription{
+          name,
+          "test_NegotiationRevisions",
+          rmf_traffic::schedule::ParticipantDescription::Rx::Responsive,
+          profile
+        },
+        database));
+
+    participants.push_back(schedule_participants.back().id());
+  }
+
+  const auto ours = participants.front();
+  const auto theirs = participants.back();
+
+  rmf_traffic_ros2::schedule::Negotiation negotiation(*node, database);
+
+  // The negotiator hangs on to each responder so the test can decide when and
+  // how often to submit.
+  std::vector<ResponderPtr> responders;
+  const auto handle = negotiation.register_negotiator(
+    ours,
+    [&responders](auto, auto responder)
+    {
+      responders.push_back(responder);
+    });
+
+  const auto qos = rclcpp::ServicesQoS().reliable().keep_last(1000);
+  auto notice_pub = node->create_publisher<Notice>(
+    rmf_traffic_ros2::NegotiationNoticeTopicName, qos);
+  auto rejection_pub = node->create_publisher<Rejection>(
+    rmf_traffic_ros2::NegotiationRejectionTopicName, qos);
+
+  std::vector<Proposal> proposals;
+  auto proposal_sub = node->create_subscription<Proposal>(
+    rmf_traffic_ros2::NegotiationProposalTopicName, qos,
+    [&proposals, ours](const Proposal::UniquePtr msg)
+    {
+      if (msg->for_participant == ours)
+        proposals.push_back(*msg);
+    });
+
+  std::size_t forfeits = 0;
+  auto forfeit_sub = node->create_subscription<Forfeit>(
+    rmf_traffic_ros2::NegotiationForfeitTopicName, qos,
+    [&forfeits](const Forfeit::UniquePtr) { ++forfeits; });
+
+  rclcpp::ExecutorOptions options;
+  options.context = context;
+  rclcpp::executors::SingleThreadedExecutor executor(options);
+  executor.add_node(node);
+
+  REQUIRE(
+    spin_until(
+      executor, [&]()
+      {
+        return notice_pub->get_subscription_count() > 0
+        && rejection_pub->get_subscription_count() > 0
+        && proposal_sub->get_publisher_count() > 0
+        && forfeit_sub->get_publisher_count() > 0;
+      }, 5s));
+
+  const uint64_t conflict_version = 1;
+  Notice notice;
+  notice.conflict_version = conflict_version;
+  notice.participants = participants;
+  notice_pub->publish(notice);
+  REQUIRE(spin_until(executor, [&]() { return !responders.empty(); }, 5s));
+
+  const auto submit = [&](const std::size_t expected_proposals)
+    {
+      responders.back()->submit(0, {}, nullptr);
+      return spin_until(
+        executor, [&]() { return proposals.size() >= expected_proposals; },
+        5s);
+    };
+
+  const auto reject_last_proposal = [&]()
+    {
+      Rejection rejection;
+      rejection.conflict_version = conflict_version;
+      rejection.table.push_back(
+        rmf_traffic_msgs::build<rmf_traffic_msgs::msg::NegotiationKey>()
+        .participant(ours)
+        .version(proposals.back().proposal_version));
+      rejection.rejected_by = theirs;
+      rejection_pub->publish(rejection);
+    };
+
+  WHEN("The negotiator revises its proposal")
+  {
+    REQUIRE(submit(1));
+    REQUIRE(submit(2));
+
+    THEN("The revision is published as a newer proposal")
+    {
+      CHECK(proposals[0].proposal_version < proposals[1].proposal_version);
+      CHECK(negotiation.table_view(conflict_version, {ours}));
+    }
+  }
+
+  WHEN("The negotiator keeps revising its proposal")
+  {
+    REQUIRE(submit(1));
+    REQUIRE(submit(2));
+    REQUIRE(submit(3));
+
+    // This exceeds the limit on revisions, so it should be dropped
+    responders.back()->submit(0, {}, nullptr);
+    for (std::size_t i = 0; i < 10; ++i)
+      executor.spin_some(10ms);
+
+    CHECK(proposals.size() == 3);
+  }
+
+  WHEN("A revised proposal gets rejected")
+  {
+    REQUIRE(submit(1));
+    REQUIRE(submit(2));
+    REQUIRE(submit(3));
+
+    // The revisions raised the version of the table past the retry limit, but
+    // they should not count as retries.
+    reject_last_proposal();
+    REQUIRE(
+      spin_until(executor, [&]() { return responders.size() == 2; }, 5s));
+
+    for (std::size_t i = 0; i < 10; ++i)
+      executor.spin_some(10ms);
+
+    CHECK(forfeits == 0);
+  }
+
+  responders.clear();
+  context->shutdown("Finished test");
+}
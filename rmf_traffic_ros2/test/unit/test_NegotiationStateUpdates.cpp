@@ -0,0 +1,235 @@
+/*
+ * Copyright (C) 2022 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <rmf_traffic/geometry/Circle.hpp>
+
+#include <rmf_traffic_ros2/StandardNames.hpp>
+#include <rmf_traffic_ros2/Time.hpp>
+#include <rmf_traffic_ros2/schedule/ParticipantDescription.hpp>
+
+#include <rclcpp/executors/single_threaded_executor.hpp>
+
+#include <rmf_utils/catch.hpp>
+
+#include <filesystem>
+#include <thread>
+
+#include "../../src/rmf_traffic_ros2/schedule/internal_Node.hpp"
+
+using rmf_traffic_ros2::schedule::ScheduleNode;
+using NegotiationStates = rmf_traffic_msgs::msg::NegotiationStates;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+//==============================================================================
+template<typename Condition>
+bool wait_for(Condition condition, const std::chrono::nanoseconds timeout)
+{
+  const auto stop_time = Clock::now() + timeout;
+  while (Clock::now() < stop_time)
+  {
+    if (condition())
+      return true;
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+
+  return condition();
+}
+} // anonymous namespace
+
+//==============================================================================
+SCENARIO("Negotiation changes are published as deltas between keyframes")
+{
+  using namespace std::chrono_literals;
+
+  const auto log_dir =
+    std::filesystem::temp_directory_path() / "rmf_negotiation_updates_test";
+  std::filesystem::remove_all(log_dir);
+  std::filesystem::create_directories(log_dir);
+
+  auto context = std::make_shared<rclcpp::Context>();
+  context->init(0, nullptr);
+
+  // Keyframes are only published when negotiations open or close so that
+  // the timer cannot interfere with the test
+  auto schedule_node = std::make_shared<ScheduleNode>(
+    rclcpp::NodeOptions()
+    .context(context)
+    .parameter_overrides({
+      rclcpp::Parameter("negotiation_keyframe_period", 0.0),
+      rclcpp::Parameter(
+        "log_file_location", (log_dir / "registry.yaml").string())
+    }));
+
+  const rmf_traffic::Profile profile{
+    rmf_traffic::geometry::make_final_convex<
+      rmf_traffic::geometry::Circle>(0.5)
+  };
+
+  ScheduleNode::ConflictSet conflict;
+  for (const std::string name : {"participant_a", "participant_b"})
+  {
+    auto request =
+      std::make_shared<ScheduleNode::RegisterParticipant::Request>();
+    request->description = rmf_traffic_ros2::convert(
+      rmf_traffic::schedule::ParticipantDescription{
+        name,
+        "test_NegotiationStateUpdates",
+        rmf_traffic::schedule::ParticipantDescription::Rx::Responsive,
+        profile
+      });
+
+    auto response =
+      std::make_shared<ScheduleNode::RegisterParticipant::Response>();
+    schedule_node->register_participant(nullptr, request, response);
+    REQUIRE(response->error.empty());
+    conflict.insert(response->participant_id);
+  }
+
+  auto listener = std::make_shared<rclcpp::Node>(
+    "test_negotiation_state_updates", rclcpp::NodeOptions().context(context));
+
+  std::mutex received_mutex;
+  std::vector<NegotiationStates> updates;
+  std::vector<NegotiationStates> keyframes;
+  const auto updates_sub = listener->create_subscription<NegotiationStates>(
+    rmf_traffic_ros2::NegotiationStateUpdatesTopicName,
+    rclcpp::ServicesQoS().reliable().keep_last(1000),
+    [&](const NegotiationStates::UniquePtr msg)
+    {
+      std::lock_guard<std::mutex> lock(received_mutex);
+      updates.push_back(*msg);
+    });
+
+  const auto keyframe_sub = listener->create_subscription<NegotiationStates>(
+    rmf_traffic_ros2::NegotiationStatesTopicName,
+    rclcpp::SystemDefaultsQoS().keep_last(1).reliable().transient_local(),
+    [&](const NegotiationStates::UniquePtr msg)
+    {
+      std::lock_guard<std::mutex> lock(received_mutex);
+      keyframes.push_back(*msg);
+    });
+
+  rclcpp::ExecutorOptions options;
+  options.context = context;
+  rclcpp::executors::SingleThreadedExecutor executor(options);
+  executor.add_node(listener);
+  std::thread spin_thread([&]() { executor.spin(); });
+
+  REQUIRE(
+    wait_for(
+      [&]()
+      {
+        return schedule_node->negotiation_state_updates_pub
+        ->get_subscription_count() > 0
+        && schedule_node->negotiation_states_pub->get_subscription_count() > 0;
+      }, 5s));
+
+  // Open a negotiation the way the conflict checking thread would
+  ScheduleNode::Version conflict_version;
+  {
+    std::lock_guard<std::mutex> lock(schedule_node->active_conflicts_mutex);
+    const auto entry = schedule_node->active_conflicts.insert(
+      conflict,
+      rmf_traffic_ros2::convert(schedule_node->now()),
+      *schedule_node->database);
+    REQUIRE(entry.has_value());
+    conflict_version = entry->first;
+    schedule_node->publish_negotiation_states();
+  }
+
+  REQUIRE(
+    wait_for(
+      [&]()
+      {
+        std::lock_guard<std::mutex> lock(received_mutex);
+        return !keyframes.empty()
+        && keyframes.back().negotiations.size() == 1;
+      }, 5s));
+
+  std::size_t initial_tree_size = 0;
+  {
+    std::lock_guard<std::mutex> lock(received_mutex);
+    initial_tree_size = keyframes.back().negotiations.front().tree.size();
+    CHECK(initial_tree_size == 2);
+  }
+
+  const auto proposing = *conflict.begin();
+  ScheduleNode::ConflictProposal proposal;
+  proposal.conflict_version = conflict_version;
+  proposal.proposal_version = 1;
+  proposal.for_participant = proposing;
+  proposal.plan_id = 0;
+  schedule_node->receive_proposal(proposal);
+
+  REQUIRE(
+    wait_for(
+      [&]()
+      {
+        std::lock_guard<std::mutex> lock(received_mutex);
+        return !updates.empty();
+      }, 5s));
+
+  {
+    std::lock_guard<std::mutex> lock(received_mutex);
+    REQUIRE(updates.size() == 1);
+    REQUIRE(updates.front().negotiations.size() == 1);
+    const auto& delta = updates.front().negotiations.front();
+    CHECK(delta.status.conflict_version == conflict_version);
+    CHECK(delta.tree.empty());
+    REQUIRE(delta.orphan_proposals.size() == 1);
+    CHECK(delta.orphan_proposals.front().for_participant == proposing);
+    CHECK(delta.orphan_rejections.empty());
+    CHECK(delta.orphan_forfeits.empty());
+
+    // The proposal should not have triggered a new keyframe
+    CHECK(keyframes.size() == 1);
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(schedule_node->active_conflicts_mutex);
+    const auto* open =
+      schedule_node->active_conflicts.negotiation(conflict_version);
+    REQUIRE(open);
+    CHECK(open->keyframe_outdated);
+    CHECK(open->changes.orphan_proposals.empty());
+
+    // The next keyframe picks up the table that the proposal added
+    schedule_node->publish_negotiation_states();
+    CHECK_FALSE(open->keyframe_outdated);
+  }
+
+  REQUIRE(
+    wait_for(
+      [&]()
+      {
+        std::lock_guard<std::mutex> lock(received_mutex);
+        return keyframes.size() > 1;
+      }, 5s));
+
+  {
+    std::lock_guard<std::mutex> lock(received_mutex);
+    CHECK(keyframes.back().negotiations.front().tree.size()
+      > initial_tree_size);
+  }
+
+  executor.cancel();
+  spin_thread.join();
+  context->shutdown("Finished test");
+  std::filesystem::remove_all(log_dir);
+}
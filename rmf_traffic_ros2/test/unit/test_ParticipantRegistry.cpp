@@ -288,3 +288,211 @@ SCENARIO("Test file logger")
     }
   }
 }
+
+SCENARIO("Test binary logger")
+{
+  const std::string file_path = "test_binarylogger.log";
+  if (std::filesystem::exists(file_path))
+  {
+    std::remove(file_path.c_str());
+  }
+
+  const auto make_description = [&](const std::string& name, double radius)
+    {
+      return rmf_traffic::schedule::ParticipantDescription(
+        name,
+        "test_Participant",
+        rmf_traffic::schedule::ParticipantDescription::Rx::Responsive,
+        rmf_traffic::Profile{
+          rmf_traffic::geometry::make_final_convex<
+            rmf_traffic::geometry::Circle>(radius)
+        });
+    };
+
+  const auto p1 = make_description("participant 1", 1.0);
+  const auto p2 = make_description("participant 2", 1.0);
+  const auto p1_updated = make_description("participant 1", 2.0);
+
+  const auto read_all = [&](BinaryLogger& logger)
+    {
+      std::vector<AtomicOperation> records;
+      while (auto record = logger.read_next_record())
+        records.push_back(*record);
+
+      return records;
+    };
+
+  GIVEN("non-existant file")
+  {
+    WHEN("Storing records and an update")
+    {
+      {
+        BinaryLogger logger1(file_path);
+        logger1.write_operation({AtomicOperation::OpType::Add, p1});
+        logger1.write_operation({AtomicOperation::OpType::Add, p2});
+        logger1.write_operation({AtomicOperation::OpType::Update, p1_updated});
+      }
+
+      const std::vector<AtomicOperation> expected = {
+        {AtomicOperation::OpType::Add, p1_updated},
+        {AtomicOperation::OpType::Add, p2},
+      };
+
+      THEN("The latest descriptions are restored in their original order")
+      {
+        BinaryLogger logger2(file_path);
+        const auto records = read_all(logger2);
+        REQUIRE(records.size() == expected.size());
+        for (std::size_t i = 0; i < expected.size(); ++i)
+          CHECK(records[i] == expected[i]);
+      }
+
+      THEN("Compaction shrinks the file without changing its contents")
+      {
+        const auto size_before = std::filesystem::file_size(file_path);
+        {
+          BinaryLogger logger2(file_path);
+          logger2.compact();
+        }
+        CHECK(std::filesystem::file_size(file_path) < size_before);
+
+        BinaryLogger logger3(file_path);
+        const auto records = read_all(logger3);
+        REQUIRE(records.size() == expected.size());
+        for (std::size_t i = 0; i < expected.size(); ++i)
+          CHECK(records[i] == expected[i]);
+      }
+
+      THEN("A partially written record at the end is discarded")
+      {
+        const auto size = std::filesystem::file_size(file_path);
+        std::filesystem::resize_file(file_path, size - 3);
+
+        BinaryLogger logger2(file_path);
+        const auto records = read_all(logger2);
+        REQUIRE(records.size() == 2);
+        CHECK(records[0] == AtomicOperation{AtomicOperation::OpType::Add, p1});
+        CHECK(records[1] == AtomicOperation{AtomicOperation::OpType::Add, p2});
+      }
+
+      THEN("A corrupted record fails its checksum")
+      {
+        std::fstream file(
+          file_path, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(20);
+        file.put('\x7f');
+        file.close();
+
+        REQUIRE_THROWS(BinaryLogger(file_path));
+      }
+    }
+
+    WHEN("Updates exceed the compaction threshold")
+    {
+      const std::string uncompacted_path = "test_binarylogger_full.log";
+      if (std::filesystem::exists(uncompacted_path))
+      {
+        std::remove(uncompacted_path.c_str());
+      }
+
+      {
+        BinaryLogger compacted(file_path, 2);
+        BinaryLogger uncompacted(uncompacted_path, 100);
+        for (auto* logger : {&compacted, &uncompacted})
+        {
+          logger->write_operation({AtomicOperation::OpType::Add, p1});
+          for (std::size_t i = 0; i < 5; ++i)
+          {
+            logger->write_operation(
+              {AtomicOperation::OpType::Update, i%2 ? p1 : p1_updated});
+          }
+        }
+      }
+
+      THEN("The journal is compacted automatically")
+      {
+        CHECK(std::filesystem::file_size(file_path)
+          < std::filesystem::file_size(uncompacted_path));
+
+        BinaryLogger logger2(file_path);
+        const auto records = read_all(logger2);
+        REQUIRE(records.size() == 1);
+        CHECK(records[0] ==
+          AtomicOperation{AtomicOperation::OpType::Add, p1_updated});
+      }
+
+      std::remove(uncompacted_path.c_str());
+    }
+
+    WHEN("Two participants concatenate to the same name and owner")
+    {
+      const auto make_owned = [&](const std::string& name, std::string owner)
+        {
+          return rmf_traffic::schedule::ParticipantDescription(
+            name,
+            std::move(owner),
+            rmf_traffic::schedule::ParticipantDescription::Rx::Responsive,
+            p1.profile());
+        };
+
+      const auto ab_c = make_owned("ab", "c");
+      const auto a_bc = make_owned("a", "bc");
+      {
+        BinaryLogger logger1(file_path);
+        logger1.write_operation({AtomicOperation::OpType::Add, ab_c});
+        logger1.write_operation({AtomicOperation::OpType::Add, a_bc});
+      }
+
+      THEN("Both participants are restored")
+      {
+        BinaryLogger logger2(file_path);
+        const auto records = read_all(logger2);
+        REQUIRE(records.size() == 2);
+        CHECK(records[0] ==
+          AtomicOperation{AtomicOperation::OpType::Add, ab_c});
+        CHECK(records[1] ==
+          AtomicOperation{AtomicOperation::OpType::Add, a_bc});
+      }
+    }
+  }
+
+  GIVEN("a file that is not a participant journal")
+  {
+    std::ofstream invalid;
+    invalid.open(file_path, std::ofstream::out);
+    invalid << "- not a journal";
+    invalid.close();
+
+    THEN("throws exception")
+    {
+      REQUIRE_THROWS(BinaryLogger(file_path));
+    }
+  }
+
+  GIVEN("a registry that logs to a binary journal")
+  {
+    using Database = rmf_traffic::schedule::Database;
+    ParticipantId id1;
+    ParticipantId id2;
+    {
+      auto db = std::make_shared<Database>();
+      ParticipantRegistry registry(
+        std::make_unique<BinaryLogger>(file_path), db);
+      id1 = registry.add_or_retrieve_participant(p1).id();
+      id2 = registry.add_or_retrieve_participant(p2).id();
+      registry.add_or_retrieve_participant(p1_updated);
+    }
+
+    THEN("A new registry restores the same participants")
+    {
+      auto db = std::make_shared<Database>();
+      ParticipantRegistry registry(
+        std::make_unique<BinaryLogger>(file_path), db);
+
+      REQUIRE(db->participant_ids().size() == 2);
+      CHECK(*db->get_participant(id1) == p1_updated);
+      CHECK(*db->get_participant(id2) == p2);
+      CHECK(registry.add_or_retrieve_participant(p2).id() == id2);
+    }
+  }
+}
@@ -0,0 +1,232 @@
+/*
+ * Copyright (C) 2022 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <rmf_traffic/geometry/Circle.hpp>
+
+#include <rmf_traffic_ros2/StandardNames.hpp>
+#include <rmf_traffic_ros2/schedule/Writer.hpp>
+
+#include <rmf_traffic_msgs/srv/register_participant.hpp>
+
+#include <rclcpp/executors/single_threaded_executor.hpp>
+
+#include <rmf_utils/catch.hpp>
+
+#include <deque>
+#include <string>
+
+using Register = rmf_traffic_msgs::srv::RegisterParticipant;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+//==============================================================================
+template<typename Condition>
+bool spin_until(
+  rclcpp::Executor& executor,
+  Condition condition,
+  const std::chrono::nanoseconds timeout)
+{
+  const auto stop_time = Clock::now() + timeout;
+  while (Clock::now() < stop_time)
+  {
+    if (condition())
+      return true;
+
+    executor.spin_some(std::chrono::milliseconds(10));
+  }
+
+  return condition();
+}
+
+//==============================================================================
+/// A stand-in for the register service of a schedule node which holds on to
+/// every request until the test decides how to answer it.
+struct DeferredRegisterService
+{
+  struct Request
+  {
+    std::shared_ptr<rmw_request_id_t> header;
+    std::shared_ptr<Register::Request> request;
+  };
+
+  std::deque<Request> requests;
+  rclcpp::Service<Register>::SharedPtr service;
+  uint64_t next_id = 0;
+
+  DeferredRegisterService(rclcpp::Node& node)
+  {
+    service = node.create_service<Register>(
+      rmf_traffic_ros2::RegisterParticipantSrvName,
+      [this](
+        std::shared_ptr<rmw_request_id_t> header,
+        std::shared_ptr<Register::Request> request)
+      {
+        requests.push_back({std::move(header), std::move(request)});
+      });
+  }
+
+  void accept_next()
+  {
+    const auto next = std::move(requests.front());
+    requests.pop_front();
+
+    Register::Response response;
+    response.participant_id = next_id++;
+    response.last_itinerary_version = 0;
+    response.last_plan_id = 0;
+    response.next_storage_base = 0;
+    service->send_response(*next.header, response);
+  }
+
+  void reject_next(const std::string& error)
+  {
+    const auto next = std::move(requests.front());
+    requests.pop_front();
+
+    Register::Response response;
+    response.error = error;
+    service->send_response(*next.header, response);
+  }
+};
+
+//==============================================================================
+template<typename T>
+bool is_ready(const std::future<T>& future)
+{
+  return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+} // anonymous namespace
+
+//==============================================================================
+SCENARIO("Writer queues participant registrations")
+{
+  using namespace std::chrono_literals;
+
+  auto context = std::make_shared<rclcpp::Context>();
+  context->init(0, nullptr);
+
+  auto writer_node = std::make_shared<rclcpp::Node>(
+    "test_writer_registration", rclcpp::NodeOptions().context(context));
+  auto schedule_node = std::make_shared<rclcpp::Node>(
+    "test_writer_registration_schedule",
+    rclcpp::NodeOptions().context(context));
+
+  rclcpp::ExecutorOptions options;
+  options.context = context;
+  rclcpp::executors::SingleThreadedExecutor executor(options);
+  executor.add_node(writer_node);
+  executor.add_node(schedule_node);
+
+  const auto writer = rmf_traffic_ros2::schedule::Writer::make(writer_node);
+
+  std::deque<std::function<void()>> completions;
+  writer->set_completion_executor(
+    [&completions](std::function<void()> work)
+    {
+      completions.push_back(std::move(work));
+    });
+
+  const rmf_traffic::Profile profile{
+    rmf_traffic::geometry::make_final_convex<
+      rmf_traffic::geometry::Circle>(0.5)
+  };
+
+  // Queue more registrations than can be in flight at once, before there is
+  // any schedule node to register with.
+  const std::size_t total = 20;
+  std::vector<std::future<rmf_traffic::schedule::Participant>> futures;
+  for (std::size_t i = 0; i < total; ++i)
+  {
+    futures.push_back(
+      writer->make_participant(
+        rmf_traffic::schedule::ParticipantDescription{
+          "participant_" + std::to_string(i),
+          "test_WriterRegistration",
+          rmf_traffic::schedule::ParticipantDescription::Rx::Responsive,
+          profile
+        }));
+  }
+
+  for (std::size_t i = 0; i < 10; ++i)
+    executor.spin_some(10ms);
+
+  for (const auto& f : futures)
+    CHECK_FALSE(is_ready(f));
+
+  // Once the service exists, only 16 of the registrations are sent
+  DeferredRegisterService service(*schedule_node);
+  REQUIRE(
+    spin_until(
+      executor, [&]() { return service.requests.size() >= 16; }, 5s));
+
+  for (std::size_t i = 0; i < 10; ++i)
+    executor.spin_some(10ms);
+  CHECK(service.requests.size() == 16);
+
+  // An error from the schedule node reaches the future of that participant
+  service.reject_next("test rejection");
+  REQUIRE(spin_until(executor, [&]() { return !completions.empty(); }, 5s));
+  CHECK_FALSE(is_ready(futures[0]));
+  completions.front()();
+  completions.pop_front();
+  REQUIRE(is_ready(futures[0]));
+  try
+  {
+    futures[0].get();
+    FAIL("The rejected registration should have produced an exception");
+  }
+  catch (const std::exception& e)
+  {
+    CHECK(std::string(e.what()).find("test rejection") != std::string::npos);
+  }
+
+  // Answering a registration makes room for one more to be sent
+  REQUIRE(
+    spin_until(
+      executor, [&]() { return service.requests.size() == 16; }, 5s));
+
+  service.accept_next();
+  REQUIRE(spin_until(executor, [&]() { return !completions.empty(); }, 5s));
+  completions.front()();
+  completions.pop_front();
+  REQUIRE(is_ready(futures[1]));
+  {
+    const auto participant = futures[1].get();
+    CHECK(participant.id() == 0);
+    CHECK(participant.description().name() == "participant_1");
+  }
+
+  REQUIRE(
+    spin_until(
+      executor, [&]() { return service.requests.size() == 16; }, 5s));
+
+  // Everything that is still waiting fails when the context shuts down
+  context->shutdown("Finished test");
+  for (std::size_t i = 2; i < total; ++i)
+  {
+    REQUIRE(is_ready(futures[i]));
+    try
+    {
+      futures[i].get();
+      FAIL("The registration should have failed during teardown");
+    }
+    catch (const std::exception& e)
+    {
+      CHECK(std::string(e.what()).find("Tearing down") != std::string::npos);
+    }
+  }
+}